@@ -0,0 +1,1516 @@
+/* /////////////////////////////////////////////////////////////////////////////
+//                ___
+//              ,--.'|_            str: C string management header [1.0.0]
+//              |  | :,'   __  ,-. Copyright (C) 2020 Justin Collier
+//    .--.--.   :  : ' : ,' ,'/ /|
+//   /  /    '.;__,'  /  '  | |' | - - - - - - - - - - - - - - - - - - -
+//  |  :  /`./|  |   |   |  |   ,'
+//  |  :  ;_  :__,'| :   '  :  /   This program is free software: you can
+//   \  \    `. '  : |__ |  | '    redistribute it and/or modify it under the
+//    `----.   \|  | '.'|;  : |    terms of the GNU General Public License
+//   /  /`--'  /;  :    ;|  , ;    as published by the Free Software Foundation,
+//  '--'.     / |  ,   /  ---'     either version 3 of the License, or (at your
+//    `--'---'   ---`-'            option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the internalied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//                                                                             /
+//  You should have received a copy of the GNU General Public License         //
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.   ///
+///////////////////////////////////////////////////////////////////////////// */
+
+/*
+  usage: ~bench [max_len [ms_per_case]]
+
+  times the constructors, manipulators, comparisons, utf-8 scans, encoders,
+  parsers, sort, line reader and file loaders over operand lengths from 0
+  to max_len [default 64 MiB]; the str_vec, str_edit, str_builder and
+  str_table calls are only timed as part of the *_repeat cases, or not at
+  all. prints one csv row per case and length:
+
+    impl,op,len,iters,ns_per_op,bytes_per_s,allocs_per_op
+
+  mutators restore their operand before each op with str_clear and
+  str_append_ [no alloc]; the cost of that restore is the append_ row.
+  *_repeat cases build len bytes from 16-byte pieces and count as one op.
+
+  compiled as C++, only the std::string cases run [see make bench]; from
+  C++11, the vec_* cases also compare std::string with strpp::string
+  [str.hpp] as elements of a std::vector: vec_push builds len / 32 strings
+  of 32 chars [reallocation moves them], vec_copy copies such a vector, and
+  vec_rotate rotates it by one [moves only].
+  compiled with -DBENCH_SDS and sds.c, the sds cases run too; compiled with
+  -DSTR_CONFIG_ALIGN=64 [~bench_align], the str cases report as str_align64.
+  compiled with STR_CONFIG_MMAP_THRESHOLD [~bench_mmap, blocks from 1 MiB],
+  they report as str_mmap; mapped blocks are not counted in allocs_per_op.
+  compiled with STR_CONFIG_IO_URING [~bench_uring], they report as
+  str_uring. on posix, read_files loads BENCH_FILES files of len chars with
+  one str_read_files call, and read_file_loop with a str_read_file each.
+
+  sort_url and sort_uuid sort len / 64 keys [1M at 64 MiB] of url paths or
+  uuids: str_sort as str, qsort with strcmp as qsort, and from C++11
+  std::sort of std::string as std::string. each op first restores the
+  unsorted order: a copy of the str pointers, or an assignment of each
+  std::string into a reserved one [no alloc].
+
+  to_double, to_long and to_ulong parse len chars of space-separated
+  numbers with str_to_*, and again with strtod, strtol and strtoul as libc;
+  a quarter of the doubles have 17 significant digits [the strtod path].
+  getline and getline_view read len chars of lines of about 80 chars from
+  a tmpfile, and libc reads them with fgets; libc also runs cmp as strcmp.
+
+  the append_csv_field, append_json_escaped and append_url_encoded cases
+  encode the mixed text [an escape every few dozen chars]; their _clean
+  variants encode alphanumerics only, and their _dirty variants chars that
+  all need escaping [half of them quotes, doubled in csv].
+*/
+
+#if defined __unix__ || defined __APPLE__
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+#ifndef STR_CONFIG_POSIX
+#define STR_CONFIG_POSIX
+#endif
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* every allocation of the library is counted */
+static unsigned long bench_allocs = 0;
+static void         *bench_malloc(size_t n) {
+  ++bench_allocs;
+  return malloc(n);
+}
+#define STR_CONFIG_MALLOC bench_malloc
+
+#include "str.h"
+
+/* the impl column of the str cases [eg str_align64 for STR_CONFIG_ALIGN] */
+#ifdef STR_CONFIG_ALIGN
+#define BENCH_STRINGIZE(x)   BENCH_STRINGIZE_X(x)
+#define BENCH_STRINGIZE_X(x) #x
+#define BENCH_STR_IMPL       "str_align" BENCH_STRINGIZE(STR_CONFIG_ALIGN)
+#elif defined STR_CONFIG_MMAP_THRESHOLD
+#define BENCH_STR_IMPL "str_mmap"
+#elif defined STR_CONFIG_IO_URING
+#define BENCH_STR_IMPL "str_uring"
+#else
+#define BENCH_STR_IMPL "str"
+#endif
+
+#ifdef __cplusplus
+#include <new>
+#include <string>
+#if __cplusplus >= 201103L
+#include <algorithm>
+#include <vector>
+
+#include "str.hpp"
+#endif
+#if __cplusplus >= 201103L
+#define BENCH_NOEXCEPT noexcept
+#else
+#define BENCH_NOEXCEPT throw()
+#endif
+void *
+operator new(std::size_t n) {
+  void *p = malloc(n == 0 ? 1 : n);
+  ++bench_allocs;
+  if (p == NULL)
+    throw std::bad_alloc();
+  return p;
+}
+void
+operator delete(void *p) BENCH_NOEXCEPT {
+  free(p);
+}
+#if __cplusplus >= 201402L
+void
+operator delete(void *p, std::size_t n) BENCH_NOEXCEPT {
+  (void)n;
+  free(p);
+}
+#endif
+#endif
+
+#ifdef BENCH_SDS
+#include "sds.h"
+#endif
+
+/*.----------------------------------------------------------------------------,
+ /                                bench detail                               */
+
+#define BENCH_PIECE     "0123456789abcdef"
+#define BENCH_PIECE_LEN 16
+
+/* longest key of bench_key, terminator included */
+#define BENCH_KEY_MAX 128
+/* chars of operand per sort key */
+#define BENCH_KEY_SPAN 64
+
+#if !defined __cplusplus || __cplusplus >= 201103L
+/** writes key i of the url or uuid key set to buf; returns its length */
+static size_t
+bench_key(char *buf, unsigned long i, int uuid) {
+  static const char *const seg[] = {"api",   "v1",     "v2",     "users",
+                                    "items", "search", "static", "img"};
+  unsigned long            x[4];
+  size_t                   k;
+  x[0] = (i * 2654435761UL + 1013904223UL) & 0xffffffffUL;
+  for (k = 1; k < 4; ++k) /* lcg steps */
+    x[k] = (x[k - 1] * 1664525UL + 1013904223UL) & 0xffffffffUL;
+  if (uuid)
+    return (size_t)sprintf(buf, "%08lx-%04lx-%04lx-%04lx-%04lx%08lx", x[0],
+                           x[1] >> 16, x[1] & 0xffff, x[2] >> 16,
+                           x[2] & 0xffff, x[3]);
+  return (size_t)sprintf(buf, "https://example.com/%s/%s/%s/%lu", seg[x[1] % 8],
+                         seg[x[2] % 8], seg[x[3] % 8], x[0] % 1000000);
+}
+#endif
+
+/** runs one op on an operand of len chars; it is the iteration number */
+typedef void (*bench_fn)(size_t len, unsigned long it);
+
+typedef struct bench_case {
+  const char *op;
+  bench_fn    setup; /* called once per length, untimed [may be NULL] */
+  bench_fn    run;
+  size_t      max_len; /* longest operand [0 for max_len] */
+} bench_case;
+
+static const size_t bench_lens[] = {0,       16,         256,       4096,
+                                    65536,   1UL << 20,  16UL << 20,
+                                    64UL << 20};
+
+static char  *bench_text;     /* max_len chars of mixed text, terminated */
+static str    bench_in  = NULL; /* the operand: len chars of bench_text */
+static str    bench_enc = NULL; /* the operand, encoded for the decoders */
+static str    bench_s   = NULL; /* the str that mutators work on */
+static double bench_sink = 0;   /* keeps results observable */
+
+/** bench_s = bench_in [the restore step of the mutators] */
+static void
+bench_reset(void) {
+  str_clear(&bench_s);
+  str_append_(&bench_s, bench_in);
+}
+
+/** sets bench_in to len chars and gives bench_s room for 3 * len + 8 */
+static void
+bench_setup(size_t len, unsigned long it) {
+  (void)it;
+  str_free(&bench_in);
+  bench_in = str_sub(bench_text, len); /* fitted: str_dup copies the cap */
+  str_realloc(&bench_s, len * 3 + 8);
+  bench_reset();
+}
+
+/*.----------------------------------------------------------------------------,
+ /                                  str cases                                */
+
+#ifndef __cplusplus
+
+static void
+run_alloc(size_t len, unsigned long it) {
+  str s = str_alloc(len);
+  (void)it;
+  bench_sink += str_cap(s);
+  str_free(&s);
+}
+
+static void
+run_dup(size_t len, unsigned long it) {
+  str s = str_dup(bench_in);
+  (void)len, (void)it;
+  bench_sink += str_len(s);
+  str_free(&s);
+}
+
+static void
+run_new(size_t len, unsigned long it) {
+  str s = str_new(bench_in);
+  (void)len, (void)it;
+  bench_sink += str_len(s);
+  str_free(&s);
+}
+
+static void
+run_sub(size_t len, unsigned long it) {
+  str s = str_sub(bench_text, len);
+  (void)it;
+  bench_sink += str_len(s);
+  str_free(&s);
+}
+
+/** bench_s = bench_in in lowercase, so that the scans run to the end */
+static void
+setup_scan(size_t len, unsigned long it) {
+  bench_setup(len, it);
+  str_tolower(&bench_s);
+}
+
+static void
+run_islower(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  bench_sink += str_islower(bench_s);
+}
+
+static void
+run_casecmp_(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  bench_sink += str_casecmp_(bench_in, bench_s);
+}
+
+static void
+run_caseeq_(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  bench_sink += str_caseeq_(bench_in, bench_s);
+}
+
+static void
+run_cmp(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  bench_sink += str_cmp(bench_in, bench_s); /* equal: compared to the end */
+}
+
+static void
+run_cmp_(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  bench_sink += str_cmp_(bench_in, bench_s);
+}
+
+static void
+run_eq(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  bench_sink += str_eq(bench_in, bench_s);
+}
+
+static void
+run_eq_(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  bench_sink += str_eq_(bench_in, bench_s);
+}
+
+/** bench_in = len chars of valid utf-8 [one to four bytes per code point] */
+static void
+setup_utf8(size_t len, unsigned long it) {
+  static const char pattern[] = "caf\xc3\xa9 \xe2\x82\xac"
+                                "5 \xf0\x9f\x98\x80 ";
+  size_t            i;
+  bench_setup(len, it);
+  for (i = 0; i + sizeof(pattern) - 1 <= len; i += sizeof(pattern) - 1)
+    memcpy(&bench_in[i], pattern, sizeof(pattern) - 1);
+  memset(&bench_in[i], 'a', len - i);
+}
+
+static void
+run_utf8_len(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  bench_sink += str_utf8_len(bench_in);
+}
+
+static void
+run_utf8_valid(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  bench_sink += str_utf8_valid(bench_in);
+}
+
+static void
+run_append(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  str_clear(&bench_s);
+  str_append(&bench_s, bench_in);
+}
+
+static void
+run_append_(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  bench_reset();
+}
+
+static void
+run_prepend(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  bench_reset();
+  str_prepend(&bench_s, bench_in);
+}
+
+static void
+run_prepend_(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  bench_reset();
+  str_prepend_(&bench_s, bench_in);
+}
+
+static void
+run_emplace(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  str_emplace(&bench_s, bench_in, 0); /* overwrites bench_s in place */
+}
+
+static void
+run_emplace_(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  str_emplace_(&bench_s, bench_in, 0);
+}
+
+static void
+run_erase(size_t len, unsigned long it) {
+  (void)it;
+  bench_reset();
+  str_erase(&bench_s, len / 4, len / 2);
+}
+
+static void
+run_insert(size_t len, unsigned long it) {
+  (void)it;
+  bench_reset();
+  str_insert(&bench_s, bench_in, len / 2);
+}
+
+static void
+run_insert_(size_t len, unsigned long it) {
+  (void)it;
+  bench_reset();
+  str_insert_(&bench_s, bench_in, len / 2);
+}
+
+static void
+run_splice(size_t len, unsigned long it) {
+  (void)it;
+  bench_reset();
+  str_splice(&bench_s, len / 4, len / 2, bench_in, len);
+}
+
+static void
+run_substr(size_t len, unsigned long it) {
+  (void)it;
+  bench_reset();
+  str_substr(&bench_s, len / 4, len / 2);
+}
+
+static void
+run_cpylower(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  str_cpylower(&bench_s, bench_in);
+}
+
+static void
+run_cpylower_(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  str_cpylower_(&bench_s, bench_in);
+}
+
+static void
+run_cpyupper(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  str_cpyupper(&bench_s, bench_in);
+}
+
+static void
+run_cpyupper_(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  str_cpyupper_(&bench_s, bench_in);
+}
+
+static void
+run_tolower(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  bench_reset();
+  str_tolower(&bench_s);
+}
+
+static void
+run_toupper(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  bench_reset();
+  str_toupper(&bench_s);
+}
+
+static void
+run_cpad(size_t len, unsigned long it) {
+  (void)it;
+  bench_reset();
+  str_cpad(&bench_s, len * 2);
+}
+
+static void
+run_cpadf(size_t len, unsigned long it) {
+  (void)it;
+  bench_reset();
+  str_cpadf(&bench_s, len * 2, "-=", STR_PAD_BYTES);
+}
+
+static void
+run_lpad(size_t len, unsigned long it) {
+  (void)it;
+  bench_reset();
+  str_lpad(&bench_s, len * 2);
+}
+
+static void
+run_lpadf(size_t len, unsigned long it) {
+  (void)it;
+  bench_reset();
+  str_lpadf(&bench_s, len * 2, "-=", STR_PAD_BYTES);
+}
+
+static void
+run_rpad(size_t len, unsigned long it) {
+  (void)it;
+  bench_reset();
+  str_rpad(&bench_s, len * 2);
+}
+
+static void
+run_rpadf(size_t len, unsigned long it) {
+  (void)it;
+  bench_reset();
+  str_rpadf(&bench_s, len * 2, "-=", STR_PAD_BYTES);
+}
+
+static void
+setup_trim(size_t len, unsigned long it) {
+  bench_setup(len, it);
+  memset(bench_in, ' ', len / 4); /* keeps the length */
+  memset(&bench_in[len - len / 4], ' ', len / 4);
+  bench_reset();
+}
+
+static void
+run_trim(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  bench_reset();
+  str_trim(&bench_s);
+}
+
+static void
+run_fit(size_t len, unsigned long it) {
+  (void)it;
+  str_fit(&bench_s, len); /* capacity suffices: a check, no alloc */
+}
+
+static void
+run_grow_shrink(size_t len, unsigned long it) {
+  (void)len;
+  if (it % 2 == 0)
+    str_grow(&bench_s, 1);
+  else
+    str_shrink(&bench_s, 1);
+}
+
+static void
+run_realloc(size_t len, unsigned long it) {
+  str_realloc(&bench_s, len * 3 + 8 + it % 2);
+}
+
+static void
+run_shrinkfit(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  str_grow(&bench_s, 1);
+  str_shrinkfit(&bench_s);
+}
+
+static void
+run_append_base64(size_t len, unsigned long it) {
+  (void)it;
+  str_clear(&bench_s);
+  str_append_base64(&bench_s, bench_in, len, STR_BASE64_STD);
+}
+
+static void
+run_append_csv_field(size_t len, unsigned long it) {
+  (void)it;
+  str_clear(&bench_s);
+  str_append_csv_field(&bench_s, bench_in, len);
+}
+
+static void
+run_append_hex(size_t len, unsigned long it) {
+  (void)it;
+  str_clear(&bench_s);
+  str_append_hex(&bench_s, bench_in, len);
+}
+
+static void
+run_append_json_escaped(size_t len, unsigned long it) {
+  (void)it;
+  str_clear(&bench_s);
+  str_append_json_escaped(&bench_s, bench_in, len);
+}
+
+static void
+run_append_url_encoded(size_t len, unsigned long it) {
+  (void)it;
+  str_clear(&bench_s);
+  str_append_url_encoded(&bench_s, bench_in, len);
+}
+
+/** bench_in = len chars of pattern [no restore: the encoders clear bench_s] */
+static void
+setup_pattern(size_t len, unsigned long it, const char *pattern) {
+  size_t plen = strlen(pattern);
+  size_t i;
+  bench_setup(len, it);
+  for (i = 0; i < len; ++i)
+    bench_in[i] = pattern[i % plen];
+}
+
+/** no char needs escaping or quoting in json, csv, or urls */
+static void
+setup_clean(size_t len, unsigned long it) {
+  setup_pattern(len, it, "abcdefghijklmnopqrstuvwxyz0123456789");
+}
+
+/** every char is escaped in json and urls; half of them doubled in csv */
+static void
+setup_dirty(size_t len, unsigned long it) {
+  setup_pattern(len, it, "\"\001\"\\\"\n\" ");
+}
+
+static void
+setup_unbase64(size_t len, unsigned long it) {
+  bench_setup(len, it);
+  str_clear(&bench_enc);
+  str_append_base64(&bench_enc, bench_in, len, STR_BASE64_STD);
+}
+
+static void
+run_append_unbase64(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  str_clear(&bench_s);
+  bench_sink += str_append_unbase64(&bench_s, bench_enc, str_len(bench_enc),
+                                    STR_BASE64_STD, NULL);
+}
+
+static void
+setup_uncsv(size_t len, unsigned long it) {
+  bench_setup(len, it);
+  str_clear(&bench_enc);
+  str_append_csv_field(&bench_enc, bench_in, len);
+}
+
+static void
+run_append_uncsv(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  str_clear(&bench_s);
+  bench_sink += str_append_uncsv(&bench_s, bench_enc, str_len(bench_enc), NULL);
+}
+
+static void
+setup_unhex(size_t len, unsigned long it) {
+  bench_setup(len, it);
+  str_clear(&bench_enc);
+  str_append_hex(&bench_enc, bench_in, len);
+}
+
+static void
+run_append_unhex(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  str_clear(&bench_s);
+  bench_sink += str_append_unhex(&bench_s, bench_enc, str_len(bench_enc), NULL);
+}
+
+static void
+setup_unjson(size_t len, unsigned long it) {
+  bench_setup(len, it);
+  str_clear(&bench_enc);
+  str_append_json_escaped(&bench_enc, bench_in, len);
+}
+
+static void
+run_append_unjson(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  str_clear(&bench_s);
+  bench_sink +=
+      str_append_unjson(&bench_s, bench_enc, str_len(bench_enc), NULL);
+}
+
+static void
+setup_unurl(size_t len, unsigned long it) {
+  bench_setup(len, it);
+  str_clear(&bench_enc);
+  str_append_url_encoded(&bench_enc, bench_in, len);
+}
+
+static void
+run_append_unurl(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  str_clear(&bench_s);
+  bench_sink += str_append_unurl(&bench_s, bench_enc, str_len(bench_enc), NULL);
+}
+
+static void
+run_append_repeat(size_t len, unsigned long it) {
+  str    s = str_alloc(0);
+  size_t i;
+  (void)it;
+  for (i = 0; i < len; i += BENCH_PIECE_LEN)
+    str_append(&s, BENCH_PIECE);
+  bench_sink += str_len(s);
+  str_free(&s);
+}
+
+static void
+run_prepend_repeat(size_t len, unsigned long it) {
+  str    s = str_alloc(0);
+  size_t i;
+  (void)it;
+  for (i = 0; i < len; i += BENCH_PIECE_LEN)
+    str_prepend(&s, BENCH_PIECE);
+  bench_sink += str_len(s);
+  str_free(&s);
+}
+
+static void
+run_builder_repeat(size_t len, unsigned long it) {
+  str_builder b;
+  str         s;
+  size_t      i;
+  (void)it;
+  str_builder_init(&b);
+  for (i = 0; i < len; i += BENCH_PIECE_LEN)
+    str_builder_append(&b, BENCH_PIECE);
+  s = str_builder_finish(&b);
+  bench_sink += str_len(s);
+  str_free(&s);
+}
+
+static void
+run_edit_prepend_repeat(size_t len, unsigned long it) {
+  str      s = str_alloc(0);
+  str_edit e;
+  size_t   i;
+  (void)it;
+  str_edit_begin(&e, &s, 0);
+  for (i = 0; i < len; i += BENCH_PIECE_LEN) {
+    str_edit_seek(&e, 0);
+    str_edit_insert(&e, BENCH_PIECE);
+  }
+  str_edit_commit(&e);
+  bench_sink += str_len(s);
+  str_free(&s);
+}
+
+static void
+run_vec_push_repeat(size_t len, unsigned long it) {
+  str_vec v;
+  size_t  i;
+  (void)it;
+  str_vec_init(&v);
+  for (i = 0; i < len; i += BENCH_PIECE_LEN)
+    str_vec_push(&v, BENCH_PIECE);
+  bench_sink += str_vec_len(&v);
+  str_vec_free(&v);
+}
+
+static str   *bench_keys  = NULL; /* the unsorted keys */
+static str   *bench_work  = NULL; /* the keys being sorted */
+static size_t bench_nkeys = 0;
+
+/** frees the keys of setup_keys */
+static void
+bench_free_keys(void) {
+  size_t i;
+  for (i = 0; i < bench_nkeys; ++i)
+    str_free(&bench_keys[i]);
+  free(bench_keys);
+  free(bench_work);
+  bench_keys  = NULL;
+  bench_work  = NULL;
+  bench_nkeys = 0;
+}
+
+/** sets bench_keys to len / BENCH_KEY_SPAN url or uuid keys */
+static void
+setup_keys(size_t len, int uuid) {
+  size_t i;
+  bench_free_keys();
+  bench_nkeys = len / BENCH_KEY_SPAN;
+  bench_keys  = (str *)malloc(sizeof(str) * (bench_nkeys + 1));
+  bench_work  = (str *)malloc(sizeof(str) * (bench_nkeys + 1));
+  if (bench_keys == NULL || bench_work == NULL)
+    abort();
+  for (i = 0; i < bench_nkeys; ++i) {
+    char buf[BENCH_KEY_MAX];
+    bench_keys[i] = str_sub(buf, bench_key(buf, i, uuid));
+  }
+}
+
+static void
+setup_sort_url(size_t len, unsigned long it) {
+  (void)it;
+  setup_keys(len, 0);
+}
+
+static void
+setup_sort_uuid(size_t len, unsigned long it) {
+  (void)it;
+  setup_keys(len, 1);
+}
+
+static void
+run_sort(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  memcpy(bench_work, bench_keys, sizeof(str) * bench_nkeys);
+  str_sort(bench_work, bench_nkeys);
+}
+
+static int
+bench_strcmp(const void *a, const void *b) {
+  return strcmp(*(const str *)a, *(const str *)b);
+}
+
+static void
+run_qsort(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  memcpy(bench_work, bench_keys, sizeof(str) * bench_nkeys);
+  qsort(bench_work, bench_nkeys, sizeof(str), bench_strcmp);
+}
+
+/** sets bench_in to len chars of space-separated doubles or longs */
+static void
+setup_numbers(size_t len, int dbl) {
+  unsigned long x = 12345;
+  str_clear(&bench_in);
+  str_fit(&bench_in, len);
+  for (;;) {
+    char   buf[64];
+    size_t k;
+    x = (x * 1664525UL + 1013904223UL) & 0xffffffffUL;
+    if (!dbl)
+      k = (size_t)sprintf(buf, "%ld", (long)(x % 2000001) - 1000000);
+    else if (x % 4 == 0)
+      k = (size_t)sprintf(buf, "%.17g", (double)x / 3e5);
+    else
+      k = (size_t)sprintf(buf, "%lu.%03lu", x % 100000, x / 7 % 1000);
+    if (str_len(bench_in) + k + 1 > len)
+      break;
+    str_append_n(&bench_in, buf, k);
+    str_append(&bench_in, " ");
+  }
+}
+
+static void
+setup_doubles(size_t len, unsigned long it) {
+  (void)it;
+  setup_numbers(len, 1);
+}
+
+static void
+setup_longs(size_t len, unsigned long it) {
+  (void)it;
+  setup_numbers(len, 0);
+}
+
+static void
+run_to_double(size_t len, unsigned long it) {
+  size_t i = 0;
+  (void)len, (void)it;
+  while (i < str_len(bench_in)) {
+    double d = 0;
+    size_t used;
+    str_to_double(&bench_in[i], str_len(bench_in) - i, &d, &used);
+    bench_sink += d;
+    i += used + 1;
+  }
+}
+
+static void
+run_to_long(size_t len, unsigned long it) {
+  size_t i = 0;
+  (void)len, (void)it;
+  while (i < str_len(bench_in)) {
+    long   l = 0;
+    size_t used;
+    str_to_long(&bench_in[i], str_len(bench_in) - i, &l, &used);
+    bench_sink += l;
+    i += used + 1;
+  }
+}
+
+static void
+run_to_ulong(size_t len, unsigned long it) {
+  size_t i = 0;
+  (void)len, (void)it;
+  while (i < str_len(bench_in)) {
+    unsigned long u = 0;
+    size_t        used;
+    if (bench_in[i] == '-') /* no sign */
+      ++i;
+    str_to_ulong(&bench_in[i], str_len(bench_in) - i, &u, &used);
+    bench_sink += u;
+    i += used + 1;
+  }
+}
+
+static FILE *bench_fp = NULL; /* the lines of getline */
+
+/** stores bench_in [lines of about 80 chars] to bench_fp */
+static void
+setup_lines(size_t len, unsigned long it) {
+  bench_setup(len, it);
+  if (bench_fp != NULL)
+    fclose(bench_fp);
+  if ((bench_fp = tmpfile()) == NULL)
+    abort();
+  fwrite(bench_in, 1, len, bench_fp);
+  fflush(bench_fp);
+}
+
+static void
+run_getline(size_t len, unsigned long it) {
+  str_reader r;
+  (void)len, (void)it;
+  rewind(bench_fp);
+  str_reader_init(&r, bench_fp);
+  while (str_getline(&r, &bench_s) == 1)
+    bench_sink += str_len(bench_s);
+  str_reader_free(&r);
+}
+
+static void
+run_getline_view(size_t len, unsigned long it) {
+  str_reader  r;
+  const char *line;
+  size_t      n;
+  (void)len, (void)it;
+  rewind(bench_fp);
+  str_reader_init(&r, bench_fp);
+  while (str_getline_view(&r, &line, &n) == 1)
+    bench_sink += n;
+  str_reader_free(&r);
+}
+
+static void
+run_strcmp(size_t len, unsigned long it) {
+  (void)len, (void)it;
+  bench_sink += strcmp(bench_in, bench_s);
+}
+
+static void
+run_fgets(size_t len, unsigned long it) {
+  char buf[256]; /* longer than any line of bench_text */
+  (void)len, (void)it;
+  rewind(bench_fp);
+  while (fgets(buf, sizeof(buf), bench_fp) != NULL)
+    bench_sink += buf[0];
+}
+
+static void
+run_strtod(size_t len, unsigned long it) {
+  char *p = bench_in;
+  (void)len, (void)it;
+  while (p < bench_in + str_len(bench_in)) {
+    bench_sink += strtod(p, &p);
+    ++p;
+  }
+}
+
+static void
+run_strtol(size_t len, unsigned long it) {
+  char *p = bench_in;
+  (void)len, (void)it;
+  while (p < bench_in + str_len(bench_in)) {
+    bench_sink += strtol(p, &p, 10);
+    ++p;
+  }
+}
+
+static void
+run_strtoul(size_t len, unsigned long it) {
+  char *p = bench_in;
+  (void)len, (void)it;
+  while (p < bench_in + str_len(bench_in)) {
+    if (*p == '-') /* strtoul would negate it */
+      ++p;
+    bench_sink += strtoul(p, &p, 10);
+    ++p;
+  }
+}
+
+#ifdef STR_CONFIG_POSIX
+/* files read by each read_files op */
+#define BENCH_FILES 64
+
+static char        bench_names[BENCH_FILES][32];
+static const char *bench_paths[BENCH_FILES];
+static str         bench_files[BENCH_FILES];
+
+/** stores bench_in to each of the BENCH_FILES files */
+static void
+setup_files(size_t len, unsigned long it) {
+  size_t i;
+  bench_setup(len, it);
+  for (i = 0; i < BENCH_FILES; ++i) {
+    if (bench_paths[i] == NULL) {
+      int fd;
+      strcpy(bench_names[i], "/tmp/str_bench_XXXXXX");
+      fd = mkstemp(bench_names[i]);
+      if (fd < 0)
+        abort();
+      close(fd);
+      bench_paths[i] = bench_names[i];
+    }
+    if (str_write_file(bench_paths[i], bench_in) < 0)
+      abort();
+  }
+}
+
+static void
+run_read_files(size_t len, unsigned long it) {
+  size_t i;
+  (void)len, (void)it;
+  bench_sink += str_read_files(bench_paths, BENCH_FILES, bench_files);
+  for (i = 0; i < BENCH_FILES; ++i)
+    str_free(&bench_files[i]);
+}
+
+static void
+run_read_file_loop(size_t len, unsigned long it) {
+  size_t i;
+  (void)len, (void)it;
+  for (i = 0; i < BENCH_FILES; ++i) {
+    bench_files[i] = str_read_file(bench_paths[i]);
+    bench_sink += str_len(bench_files[i]);
+    str_free(&bench_files[i]);
+  }
+}
+
+/** removes the files of setup_files */
+static void
+bench_remove_files(void) {
+  size_t i;
+  for (i = 0; i < BENCH_FILES; ++i)
+    if (bench_paths[i] != NULL)
+      remove(bench_paths[i]);
+}
+#endif
+
+static const bench_case str_cases[] = {
+    /* construction */
+    {"alloc", bench_setup, run_alloc, 0},
+    {"dup", bench_setup, run_dup, 0},
+    {"new", bench_setup, run_new, 0},
+    {"sub", bench_setup, run_sub, 0},
+    /* scan */
+    {"islower", setup_scan, run_islower, 0},
+    {"casecmp_", setup_scan, run_casecmp_, 0},
+    {"caseeq_", setup_scan, run_caseeq_, 0},
+    {"cmp", bench_setup, run_cmp, 0},
+    {"cmp_", bench_setup, run_cmp_, 0},
+    {"eq", bench_setup, run_eq, 0},
+    {"eq_", bench_setup, run_eq_, 0},
+    {"utf8_len", setup_utf8, run_utf8_len, 0},
+    {"utf8_valid", setup_utf8, run_utf8_valid, 0},
+    /* concatenate */
+    {"append", bench_setup, run_append, 0},
+    {"append_", bench_setup, run_append_, 0},
+    {"prepend", bench_setup, run_prepend, 0},
+    {"prepend_", bench_setup, run_prepend_, 0},
+    /* transform */
+    {"emplace", bench_setup, run_emplace, 0},
+    {"emplace_", bench_setup, run_emplace_, 0},
+    {"erase", bench_setup, run_erase, 0},
+    {"insert", bench_setup, run_insert, 0},
+    {"insert_", bench_setup, run_insert_, 0},
+    {"splice", bench_setup, run_splice, 0},
+    {"substr", bench_setup, run_substr, 0},
+    /* case */
+    {"cpylower", bench_setup, run_cpylower, 0},
+    {"cpylower_", bench_setup, run_cpylower_, 0},
+    {"cpyupper", bench_setup, run_cpyupper, 0},
+    {"cpyupper_", bench_setup, run_cpyupper_, 0},
+    {"tolower", bench_setup, run_tolower, 0},
+    {"toupper", bench_setup, run_toupper, 0},
+    /* format */
+    {"cpad", bench_setup, run_cpad, 0},
+    {"cpadf", bench_setup, run_cpadf, 0},
+    {"lpad", bench_setup, run_lpad, 0},
+    {"lpadf", bench_setup, run_lpadf, 0},
+    {"rpad", bench_setup, run_rpad, 0},
+    {"rpadf", bench_setup, run_rpadf, 0},
+    {"trim", setup_trim, run_trim, 0},
+    /* manage */
+    {"fit", bench_setup, run_fit, 0},
+    {"grow_shrink", bench_setup, run_grow_shrink, 0},
+    {"realloc", bench_setup, run_realloc, 0},
+    {"shrinkfit", bench_setup, run_shrinkfit, 0},
+    /* encoding */
+    {"append_base64", bench_setup, run_append_base64, 16UL << 20},
+    {"append_csv_field", bench_setup, run_append_csv_field, 16UL << 20},
+    {"append_hex", bench_setup, run_append_hex, 16UL << 20},
+    {"append_json_escaped", bench_setup, run_append_json_escaped, 16UL << 20},
+    {"append_url_encoded", bench_setup, run_append_url_encoded, 16UL << 20},
+    {"append_csv_field_clean", setup_clean, run_append_csv_field, 16UL << 20},
+    {"append_csv_field_dirty", setup_dirty, run_append_csv_field, 16UL << 20},
+    {"append_json_escaped_clean", setup_clean, run_append_json_escaped,
+     16UL << 20},
+    {"append_json_escaped_dirty", setup_dirty, run_append_json_escaped,
+     16UL << 20},
+    {"append_url_encoded_clean", setup_clean, run_append_url_encoded,
+     16UL << 20},
+    {"append_url_encoded_dirty", setup_dirty, run_append_url_encoded,
+     16UL << 20},
+    {"append_unbase64", setup_unbase64, run_append_unbase64, 16UL << 20},
+    {"append_uncsv", setup_uncsv, run_append_uncsv, 16UL << 20},
+    {"append_unhex", setup_unhex, run_append_unhex, 16UL << 20},
+    {"append_unjson", setup_unjson, run_append_unjson, 16UL << 20},
+    {"append_unurl", setup_unurl, run_append_unurl, 16UL << 20},
+#ifdef STR_CONFIG_POSIX
+    /* files [BENCH_FILES per op] */
+    {"read_files", setup_files, run_read_files, 1UL << 20},
+    {"read_file_loop", setup_files, run_read_file_loop, 1UL << 20},
+#endif
+    /* reading */
+    {"getline", setup_lines, run_getline, 16UL << 20},
+    {"getline_view", setup_lines, run_getline_view, 16UL << 20},
+    /* conversion */
+    {"to_double", setup_doubles, run_to_double, 16UL << 20},
+    {"to_long", setup_longs, run_to_long, 16UL << 20},
+    {"to_ulong", setup_longs, run_to_ulong, 16UL << 20},
+    /* sort [len / BENCH_KEY_SPAN keys] */
+    {"sort_url", setup_sort_url, run_sort, 0},
+    {"sort_uuid", setup_sort_uuid, run_sort, 0},
+    /* repeated patterns [prepending is quadratic] */
+    {"append_repeat", NULL, run_append_repeat, 1UL << 20},
+    {"prepend_repeat", NULL, run_prepend_repeat, 256UL << 10},
+    {"builder_repeat", NULL, run_builder_repeat, 0},
+    {"edit_prepend_repeat", NULL, run_edit_prepend_repeat, 0},
+    {"vec_push_repeat", NULL, run_vec_push_repeat, 0}};
+
+static const bench_case libc_cases[] = {
+    {"cmp", bench_setup, run_strcmp, 0},
+    {"getline", setup_lines, run_fgets, 16UL << 20},
+    {"to_double", setup_doubles, run_strtod, 16UL << 20},
+    {"to_long", setup_longs, run_strtol, 16UL << 20},
+    {"to_ulong", setup_longs, run_strtoul, 16UL << 20}};
+
+static const bench_case qsort_cases[] = {
+    {"sort_url", setup_sort_url, run_qsort, 0},
+    {"sort_uuid", setup_sort_uuid, run_qsort, 0}};
+
+#endif
+
+/*.----------------------------------------------------------------------------,
+ /                                  sds cases                                */
+
+#if defined BENCH_SDS && !defined __cplusplus
+
+static sds bench_sds = NULL;
+
+static void
+setup_sds(size_t len, unsigned long it) {
+  bench_setup(len, it);
+  sdsfree(bench_sds);
+  bench_sds = sdsMakeRoomFor(sdsnewlen(bench_in, len), len * 2 + 8);
+}
+
+static void
+run_sds_dup(size_t len, unsigned long it) {
+  sds s = sdsdup(bench_sds);
+  (void)len, (void)it;
+  bench_sink += sdslen(s);
+  sdsfree(s);
+}
+
+static void
+run_sds_new(size_t len, unsigned long it) {
+  sds s = sdsnew(bench_in);
+  (void)len, (void)it;
+  bench_sink += sdslen(s);
+  sdsfree(s);
+}
+
+static void
+run_sds_sub(size_t len, unsigned long it) {
+  sds s = sdsnewlen(bench_text, len);
+  (void)it;
+  bench_sink += sdslen(s);
+  sdsfree(s);
+}
+
+static void
+run_sds_append_(size_t len, unsigned long it) {
+  (void)it;
+  sdsclear(bench_sds);
+  bench_sds = sdscatlen(bench_sds, bench_in, len);
+}
+
+static void
+run_sds_tolower(size_t len, unsigned long it) {
+  (void)it;
+  bench_sds = sdscpylen(bench_sds, bench_in, len);
+  sdstolower(bench_sds);
+}
+
+static void
+run_sds_trim(size_t len, unsigned long it) {
+  (void)it;
+  bench_sds = sdscpylen(bench_sds, bench_in, len);
+  sdstrim(bench_sds, " \t\n");
+}
+
+static void
+run_sds_append_repeat(size_t len, unsigned long it) {
+  sds    s = sdsempty();
+  size_t i;
+  (void)it;
+  for (i = 0; i < len; i += BENCH_PIECE_LEN)
+    s = sdscatlen(s, BENCH_PIECE, BENCH_PIECE_LEN);
+  bench_sink += sdslen(s);
+  sdsfree(s);
+}
+
+static const bench_case sds_cases[] = {
+    {"dup", setup_sds, run_sds_dup, 0},
+    {"new", setup_sds, run_sds_new, 0},
+    {"sub", setup_sds, run_sds_sub, 0},
+    {"append_", setup_sds, run_sds_append_, 0},
+    {"tolower", setup_sds, run_sds_tolower, 0},
+    {"trim", setup_sds, run_sds_trim, 0},
+    {"append_repeat", NULL, run_sds_append_repeat, 1UL << 20}};
+
+#endif
+
+/*.----------------------------------------------------------------------------,
+ /                              std::string cases                            */
+
+#ifdef __cplusplus
+
+static std::string bench_std;
+
+static void
+setup_std(size_t len, unsigned long it) {
+  bench_setup(len, it);
+  bench_std.reserve(len * 3 + 8);
+  bench_std.assign(bench_in, len);
+}
+
+static void
+run_std_dup(size_t len, unsigned long it) {
+  std::string s(bench_std);
+  (void)len, (void)it;
+  bench_sink += s.size();
+}
+
+static void
+run_std_new(size_t len, unsigned long it) {
+  std::string s(bench_in);
+  (void)len, (void)it;
+  bench_sink += s.size();
+}
+
+static void
+run_std_sub(size_t len, unsigned long it) {
+  std::string s(bench_text, len);
+  (void)it;
+  bench_sink += s.size();
+}
+
+static void
+run_std_append_(size_t len, unsigned long it) {
+  (void)it;
+  bench_std.clear();
+  bench_std.append(bench_in, len);
+}
+
+static void
+run_std_prepend_(size_t len, unsigned long it) {
+  (void)it;
+  bench_std.assign(bench_in, len);
+  bench_std.insert(0, bench_in, len);
+}
+
+static void
+run_std_emplace_(size_t len, unsigned long it) {
+  (void)it;
+  bench_std.replace(0, len, bench_in, len);
+}
+
+static void
+run_std_erase(size_t len, unsigned long it) {
+  (void)it;
+  bench_std.assign(bench_in, len);
+  bench_std.erase(len / 4, len / 2);
+}
+
+static void
+run_std_insert_(size_t len, unsigned long it) {
+  (void)it;
+  bench_std.assign(bench_in, len);
+  bench_std.insert(len / 2, bench_in, len);
+}
+
+static void
+run_std_splice(size_t len, unsigned long it) {
+  (void)it;
+  bench_std.assign(bench_in, len);
+  bench_std.replace(len / 4, len / 2, bench_in, len);
+}
+
+static void
+run_std_substr(size_t len, unsigned long it) {
+  (void)it;
+  bench_std.assign(bench_in, len);
+  bench_std.erase(len / 4 + len / 2);
+  bench_std.erase(0, len / 4);
+}
+
+static void
+run_std_rpad(size_t len, unsigned long it) {
+  (void)it;
+  bench_std.assign(bench_in, len);
+  bench_std.append(len, ' ');
+}
+
+static void
+run_std_append_repeat(size_t len, unsigned long it) {
+  std::string s;
+  size_t      i;
+  (void)it;
+  for (i = 0; i < len; i += BENCH_PIECE_LEN)
+    s.append(BENCH_PIECE, BENCH_PIECE_LEN);
+  bench_sink += s.size();
+}
+
+static void
+run_std_prepend_repeat(size_t len, unsigned long it) {
+  std::string s;
+  size_t      i;
+  (void)it;
+  for (i = 0; i < len; i += BENCH_PIECE_LEN)
+    s.insert(0, BENCH_PIECE, BENCH_PIECE_LEN);
+  bench_sink += s.size();
+}
+
+static const bench_case std_cases[] = {
+    {"dup", setup_std, run_std_dup, 0},
+    {"new", setup_std, run_std_new, 0},
+    {"sub", setup_std, run_std_sub, 0},
+    {"append_", setup_std, run_std_append_, 0},
+    {"prepend_", setup_std, run_std_prepend_, 0},
+    {"emplace_", setup_std, run_std_emplace_, 0},
+    {"erase", setup_std, run_std_erase, 0},
+    {"insert_", setup_std, run_std_insert_, 0},
+    {"splice", setup_std, run_std_splice, 0},
+    {"substr", setup_std, run_std_substr, 0},
+    {"rpad", setup_std, run_std_rpad, 0},
+    {"append_repeat", NULL, run_std_append_repeat, 1UL << 20},
+    {"prepend_repeat", NULL, run_std_prepend_repeat, 256UL << 10}};
+
+#endif
+
+/*.----------------------------------------------------------------------------,
+ /                                vector cases                               */
+
+#if defined __cplusplus && __cplusplus >= 201103L
+
+#define BENCH_ELEM_LEN 32
+
+/** vectors of len / 32 strings of type T */
+template <class T>
+struct bench_vec {
+  static std::vector<T> v;
+
+  static void
+  setup(size_t len, unsigned long it) {
+    std::vector<T> w;
+    size_t         i;
+    (void)it;
+    for (i = 0; i < len / BENCH_ELEM_LEN; ++i)
+      w.push_back(T(bench_text + i % 64, BENCH_ELEM_LEN));
+    v.swap(w);
+  }
+
+  static void
+  run_push(size_t len, unsigned long it) {
+    std::vector<T> w;
+    size_t         i;
+    (void)it;
+    for (i = 0; i < len / BENCH_ELEM_LEN; ++i)
+      w.push_back(T(bench_text + i % 64, BENCH_ELEM_LEN));
+    bench_sink += w.size();
+  }
+
+  static void
+  run_copy(size_t len, unsigned long it) {
+    std::vector<T> w(v);
+    (void)len, (void)it;
+    bench_sink += w.size();
+  }
+
+  static void
+  run_rotate(size_t len, unsigned long it) {
+    (void)len, (void)it;
+    if (!v.empty())
+      std::rotate(v.begin(), v.begin() + 1, v.end());
+  }
+};
+
+template <class T>
+std::vector<T> bench_vec<T>::v;
+
+static std::vector<std::string> bench_std_keys; /* the unsorted keys */
+static std::vector<std::string> bench_std_work; /* reserved for any key */
+
+/** sets bench_std_keys to len / BENCH_KEY_SPAN url or uuid keys */
+static void
+setup_std_keys(size_t len, int uuid) {
+  size_t n = len / BENCH_KEY_SPAN;
+  size_t i;
+  bench_std_keys.assign(n, std::string());
+  bench_std_work.assign(n, std::string());
+  for (i = 0; i < n; ++i) {
+    char buf[BENCH_KEY_MAX];
+    bench_std_keys[i].assign(buf, bench_key(buf, i, uuid));
+    bench_std_work[i].reserve(BENCH_KEY_MAX);
+  }
+}
+
+static void
+setup_std_sort_url(size_t len, unsigned long it) {
+  (void)it;
+  setup_std_keys(len, 0);
+}
+
+static void
+setup_std_sort_uuid(size_t len, unsigned long it) {
+  (void)it;
+  setup_std_keys(len, 1);
+}
+
+static void
+run_std_sort(size_t len, unsigned long it) {
+  size_t i;
+  (void)len, (void)it;
+  for (i = 0; i < bench_std_keys.size(); ++i)
+    bench_std_work[i] = bench_std_keys[i]; /* fits the reserved capacity */
+  std::sort(bench_std_work.begin(), bench_std_work.end());
+}
+
+static const bench_case vec_std_cases[] = {
+    {"sort_url", setup_std_sort_url, run_std_sort, 0},
+    {"sort_uuid", setup_std_sort_uuid, run_std_sort, 0},
+    {"vec_push", NULL, bench_vec<std::string>::run_push, 1UL << 20},
+    {"vec_copy", bench_vec<std::string>::setup,
+     bench_vec<std::string>::run_copy, 1UL << 20},
+    {"vec_rotate", bench_vec<std::string>::setup,
+     bench_vec<std::string>::run_rotate, 1UL << 20}};
+
+static const bench_case vec_strpp_cases[] = {
+    {"vec_push", NULL, bench_vec<strpp::string>::run_push, 1UL << 20},
+    {"vec_copy", bench_vec<strpp::string>::setup,
+     bench_vec<strpp::string>::run_copy, 1UL << 20},
+    {"vec_rotate", bench_vec<strpp::string>::setup,
+     bench_vec<strpp::string>::run_rotate, 1UL << 20}};
+
+#endif
+
+/*.----------------------------------------------------------------------------,
+ /                                   driver                                  */
+
+/** runs every case of an impl over the lengths up to max_len; iterations
+ *  double until one batch takes at least ms milliseconds */
+static void
+bench_impl(const char *impl, const bench_case *cases, size_t ncases,
+           size_t max_len, double ms) {
+  size_t c;
+  size_t l;
+  for (c = 0; c < ncases; ++c) {
+    for (l = 0; l < sizeof(bench_lens) / sizeof(*bench_lens); ++l) {
+      size_t        len = bench_lens[l];
+      unsigned long n   = 1;
+      unsigned long allocs;
+      double        secs;
+      if (len > max_len || (cases[c].max_len != 0 && len > cases[c].max_len))
+        break;
+      if (cases[c].setup != NULL)
+        cases[c].setup(len, 0);
+      for (;; n *= 2) {
+        unsigned long i;
+        clock_t       t0;
+        bench_allocs = 0;
+        t0           = clock();
+        for (i = 0; i < n; ++i)
+          cases[c].run(len, i);
+        secs   = (double)(clock() - t0) / CLOCKS_PER_SEC;
+        allocs = bench_allocs;
+        if (secs * 1000 >= ms || n >= 1UL << 30)
+          break;
+      }
+      printf("%s,%s,%lu,%lu,%.2f,%.0f,%.2f\n", impl, cases[c].op,
+             (unsigned long)len, n, secs * 1e9 / n,
+             secs > 0 ? (double)len * n / secs : 0, (double)allocs / n);
+      fflush(stdout);
+    }
+  }
+}
+
+int
+main(int argc, char **argv) {
+  size_t max_len = argc > 1 ? (size_t)strtoul(argv[1], NULL, 10) : 64UL << 20;
+  double ms      = argc > 2 ? atof(argv[2]) : 20;
+  size_t i;
+  bench_text = (char *)malloc(max_len + 1);
+  if (bench_text == NULL) {
+    fprintf(stderr, "cannot allocate %lu bytes\n", (unsigned long)max_len);
+    return 1;
+  }
+  /* mixed case text with the odd quote, comma and control char */
+  for (i = 0; i < max_len; ++i) {
+    static const char pattern[] = "The Quick, \"Brown\" fox jumps over the "
+                                  "lazy dog.\tPack my box with five dozen "
+                                  "liquor jugs.\n";
+    bench_text[i] = pattern[i % (sizeof(pattern) - 1)];
+  }
+  bench_text[max_len] = '\0';
+  bench_in            = str_alloc(0);
+  bench_enc           = str_alloc(0);
+  bench_s             = str_alloc(0);
+
+  printf("impl,op,len,iters,ns_per_op,bytes_per_s,allocs_per_op\n");
+#ifdef __cplusplus
+  bench_impl("std::string", std_cases, sizeof(std_cases) / sizeof(*std_cases),
+             max_len, ms);
+#if __cplusplus >= 201103L
+  bench_impl("std::string", vec_std_cases,
+             sizeof(vec_std_cases) / sizeof(*vec_std_cases), max_len, ms);
+  bench_impl("strpp::string", vec_strpp_cases,
+             sizeof(vec_strpp_cases) / sizeof(*vec_strpp_cases), max_len, ms);
+  bench_vec<std::string>::v.clear();
+  bench_vec<strpp::string>::v.clear();
+  bench_std_keys.clear();
+  bench_std_work.clear();
+#endif
+#else
+  bench_impl(BENCH_STR_IMPL, str_cases, sizeof(str_cases) / sizeof(*str_cases),
+             max_len, ms);
+  bench_impl("libc", libc_cases, sizeof(libc_cases) / sizeof(*libc_cases),
+             max_len, ms);
+  bench_impl("qsort", qsort_cases, sizeof(qsort_cases) / sizeof(*qsort_cases),
+             max_len, ms);
+  bench_free_keys();
+  if (bench_fp != NULL)
+    fclose(bench_fp);
+#ifdef STR_CONFIG_POSIX
+  bench_remove_files();
+#endif
+#ifdef BENCH_SDS
+  bench_impl("sds", sds_cases, sizeof(sds_cases) / sizeof(*sds_cases), max_len,
+             ms);
+#endif
+#endif
+
+  str_free(&bench_in);
+  str_free(&bench_enc);
+  str_free(&bench_s);
+  free(bench_text);
+  return bench_sink < 0;
+}
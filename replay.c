@@ -0,0 +1,551 @@
+/* /////////////////////////////////////////////////////////////////////////////
+//                ___
+//              ,--.'|_            str: C string management header [1.0.0]
+//              |  | :,'   __  ,-. Copyright (C) 2020 Justin Collier
+//    .--.--.   :  : ' : ,' ,'/ /|
+//   /  /    '.;__,'  /  '  | |' | - - - - - - - - - - - - - - - - - - -
+//  |  :  /`./|  |   |   |  |   ,'
+//  |  :  ;_  :__,'| :   '  :  /   This program is free software: you can
+//   \  \    `. '  : |__ |  | '    redistribute it and/or modify it under the
+//    `----.   \|  | '.'|;  : |    terms of the GNU General Public License
+//   /  /`--'  /;  :    ;|  , ;    as published by the Free Software Foundation,
+//  '--'.     / |  ,   /  ---'     either version 3 of the License, or (at your
+//    `--'---'   ---`-'            option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the internalied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//                                                                             /
+//  You should have received a copy of the GNU General Public License         //
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.   ///
+///////////////////////////////////////////////////////////////////////////// */
+
+/*
+  usage: ~replay --record trace_file
+         ~replay trace_file [runs]
+
+  --record runs a sample workload with tracing on [see str_trace_start].
+
+  otherwise re-executes the str block events of a trace for every pair of
+  allocator and growth policy, keeping the best time of runs [default 1],
+  and prints one csv row per pair:
+
+    alloc,policy,events,ms,allocs,frees,reallocs,bytes_copied,peak_bytes
+
+  growth that the traced program got from str_fit [directly or through a
+  manipulator] follows the policy; str_realloc, str_grow, str_shrink, and
+  str_shrinkfit resize exactly, as they did when recorded. chars are
+  written as the traced lengths change. peak_bytes is the most memory held
+  from the system at once [including the free lists of the pool], a
+  portable stand-in for the peak resident size.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*.----------------------------------------------------------------------------,
+ /                                 allocators                                */
+
+/** an allocator under test; dealloc receives the size that was requested */
+typedef struct replay_alloc {
+  const char *name;
+  void *(*alloc)(size_t n);
+  void (*dealloc)(void *p, size_t n);
+  void (*reset)(void); /* releases cached memory between runs */
+} replay_alloc;
+
+static const replay_alloc *replay_cur; /* the allocator of the library */
+
+static unsigned long replay_allocs = 0;
+static unsigned long replay_frees  = 0;
+static size_t        replay_held   = 0; /* bytes held from the system */
+static size_t        replay_peak   = 0;
+
+/* the requested size is stored in front of each block */
+typedef union replay_header {
+  size_t n;
+  void  *p;
+  double d;
+  long   l;
+} replay_header;
+
+static void *
+replay_malloc(size_t n) {
+  replay_header *h = (replay_header *)replay_cur->alloc(sizeof(*h) + n);
+  if (h == NULL)
+    return NULL;
+  h->n = sizeof(*h) + n;
+  ++replay_allocs;
+  if (replay_held > replay_peak)
+    replay_peak = replay_held;
+  return h + 1;
+}
+
+static void
+replay_free(void *p) {
+  replay_header *h = (replay_header *)p - 1;
+  ++replay_frees;
+  replay_cur->dealloc(h, h->n);
+}
+
+#define STR_CONFIG_MALLOC replay_malloc
+#define STR_CONFIG_FREE   replay_free
+#define STR_CONFIG_TRACE
+
+#include "str.h"
+
+/* malloc: the system allocator as is */
+
+static void *
+sys_malloc(size_t n) {
+  replay_held += n;
+  return malloc(n);
+}
+
+static void
+sys_free(void *p, size_t n) {
+  replay_held -= n;
+  free(p);
+}
+
+static void
+sys_reset(void) {
+}
+
+/* pool: power of two size classes from 16 B to 16 MiB with free lists;
+ * larger blocks go to the system */
+
+#define REPLAY_POOL_MIN     16
+#define REPLAY_POOL_CLASSES 21
+
+static void *replay_pool[REPLAY_POOL_CLASSES]; /* free list heads */
+
+static size_t
+pool_class(size_t n) {
+  size_t k = 0;
+  while (k < REPLAY_POOL_CLASSES && (size_t)REPLAY_POOL_MIN << k < n)
+    ++k;
+  return k;
+}
+
+static void *
+pool_malloc(size_t n) {
+  size_t k = pool_class(n);
+  void  *p;
+  if (k == REPLAY_POOL_CLASSES)
+    return sys_malloc(n);
+  if ((p = replay_pool[k]) != NULL) {
+    replay_pool[k] = *(void **)p;
+    return p;
+  }
+  return sys_malloc((size_t)REPLAY_POOL_MIN << k);
+}
+
+static void
+pool_free(void *p, size_t n) {
+  size_t k = pool_class(n);
+  if (k == REPLAY_POOL_CLASSES) {
+    sys_free(p, n);
+    return;
+  }
+  *(void **)p    = replay_pool[k];
+  replay_pool[k] = p;
+}
+
+static void
+pool_reset(void) {
+  size_t k;
+  for (k = 0; k < REPLAY_POOL_CLASSES; ++k) {
+    while (replay_pool[k] != NULL) {
+      void *p        = replay_pool[k];
+      replay_pool[k] = *(void **)p;
+      sys_free(p, (size_t)REPLAY_POOL_MIN << k);
+    }
+  }
+}
+
+static const replay_alloc replay_allocators[] = {
+    {"malloc", sys_malloc, sys_free, sys_reset},
+    {"pool", pool_malloc, pool_free, pool_reset}};
+
+/*.----------------------------------------------------------------------------,
+ /                               growth policies                             */
+
+/** returns the capacity to grow a cap to when need chars must fit */
+typedef size_t (*replay_grow_fn)(size_t cap, size_t need);
+
+typedef struct replay_policy {
+  const char    *name;
+  replay_grow_fn grow;
+} replay_policy;
+
+static size_t
+grow_exact(size_t cap, size_t need) {
+  (void)cap;
+  return need;
+}
+
+static size_t
+grow_x15(size_t cap, size_t need) {
+  cap += cap / 2;
+  return cap > need ? cap : need;
+}
+
+static size_t
+grow_x2(size_t cap, size_t need) {
+  cap *= 2;
+  return cap > need ? cap : need;
+}
+
+static const replay_policy replay_policies[] = {
+    {"exact", grow_exact}, {"x1.5", grow_x15}, {"x2", grow_x2}};
+
+/*.----------------------------------------------------------------------------,
+ /                                    trace                                  */
+
+/** exits if an allocation failed */
+static void
+check(const void *p) {
+  if (p == NULL) {
+    fprintf(stderr, "out of memory\n");
+    exit(1);
+  }
+}
+
+/** what a record asks of the str in a slot */
+enum {
+  REPLAY_NEW,    /* allocate cap, set len */
+  REPLAY_FIT,    /* grow to hold cap chars [per the policy] */
+  REPLAY_RESIZE, /* resize to exactly cap */
+  REPLAY_LEN,    /* set len [growing per the policy] */
+  REPLAY_FREE
+};
+
+typedef struct replay_op {
+  int    kind;
+  size_t slot;
+  size_t cap;
+  size_t len;
+} replay_op;
+
+static replay_op *replay_ops    = NULL;
+static size_t     replay_nops   = 0;
+static size_t     replay_nslots = 0;
+
+/* live block addresses of the trace -> slots [open addressing; a freed
+ * entry keeps its key as a tombstone, with slot (size_t)-1] */
+typedef struct replay_entry {
+  size_t id;
+  size_t slot;
+} replay_entry;
+
+static replay_entry *replay_map      = NULL;
+static size_t        replay_map_cap  = 0; /* a power of two */
+static size_t        replay_map_used = 0; /* live entries and tombstones */
+
+#define REPLAY_DEAD ((size_t)-1)
+
+/** the entry of id, or the empty entry to insert it at */
+static replay_entry *
+map_find(size_t id) {
+  size_t        i = (id >> 4) * 2654435761UL & (replay_map_cap - 1);
+  replay_entry *tomb = NULL;
+  for (;; i = (i + 1) & (replay_map_cap - 1)) {
+    replay_entry *e = &replay_map[i];
+    if (e->id == id && e->slot != REPLAY_DEAD)
+      return e;
+    if (e->id == 0)
+      return tomb != NULL ? tomb : e;
+    if (e->slot == REPLAY_DEAD && tomb == NULL)
+      tomb = e;
+  }
+}
+
+/** slot of a live id, or REPLAY_DEAD [also before the first map_put] */
+static size_t
+map_get(size_t id) {
+  replay_entry *e;
+  if (replay_map_cap == 0)
+    return REPLAY_DEAD;
+  e = map_find(id);
+  return e->id == id ? e->slot : REPLAY_DEAD;
+}
+
+static void
+map_put(size_t id, size_t slot) {
+  replay_entry *e;
+  if ((replay_map_used + 1) * 2 > replay_map_cap) {
+    replay_entry *old = replay_map;
+    size_t        cap = replay_map_cap;
+    size_t        i;
+    replay_map_cap  = cap == 0 ? 1024 : cap * 2;
+    replay_map      = (replay_entry *)calloc(replay_map_cap, sizeof(*old));
+    replay_map_used = 0;
+    check(replay_map);
+    for (i = 0; i < cap; ++i)
+      if (old[i].id != 0 && old[i].slot != REPLAY_DEAD)
+        map_put(old[i].id, old[i].slot);
+    free(old);
+  }
+  e = map_find(id);
+  if (e->id == 0)
+    ++replay_map_used;
+  e->id   = id;
+  e->slot = slot;
+}
+
+static void
+map_erase(size_t id) {
+  replay_entry *e;
+  if (replay_map_cap == 0)
+    return;
+  e = map_find(id);
+  if (e->id == id)
+    e->slot = REPLAY_DEAD;
+}
+
+/** appends an op */
+static void
+push_op(int kind, size_t slot, size_t cap, size_t len) {
+  static size_t ops_cap = 0;
+  if (replay_nops == ops_cap) {
+    ops_cap    = ops_cap == 0 ? 4096 : ops_cap * 2;
+    replay_ops =
+        (replay_op *)realloc(replay_ops, sizeof(*replay_ops) * ops_cap);
+    check(replay_ops);
+  }
+  replay_ops[replay_nops].kind = kind;
+  replay_ops[replay_nops].slot = slot;
+  replay_ops[replay_nops].cap  = cap;
+  replay_ops[replay_nops].len  = len;
+  ++replay_nops;
+}
+
+/** converts the records of fp to ops on slots; freed slots are reused */
+static void
+load(FILE *fp) {
+  size_t          *free_slots = NULL;
+  size_t           nfree      = 0;
+  size_t           free_cap   = 0;
+  str_trace_record r;
+  while (str_trace_read(fp, &r)) {
+    size_t slot = r.id != 0 ? map_get(r.id) : REPLAY_DEAD;
+    if (r.to == 0) {
+      /* the old block of a move is freed after it was remapped */
+      if (slot == REPLAY_DEAD)
+        continue;
+      push_op(REPLAY_FREE, slot, 0, 0);
+      map_erase(r.id);
+      if (nfree == free_cap) {
+        free_cap   = free_cap == 0 ? 256 : free_cap * 2;
+        free_slots = (size_t *)realloc(free_slots, sizeof(size_t) * free_cap);
+        check(free_slots);
+      }
+      free_slots[nfree++] = slot;
+      continue;
+    }
+    if (slot == REPLAY_DEAD) {
+      /* a new block, a copy of a read-only str, or a block created before
+       * the trace started */
+      slot = nfree > 0 ? free_slots[--nfree] : replay_nslots++;
+      push_op(REPLAY_NEW, slot, r.cap, r.len);
+    } else if (r.id == r.to) {
+      push_op(REPLAY_LEN, slot, 0, r.len);
+    } else {
+      int exact = r.fn == STR_STATS_REALLOC || r.fn == STR_STATS_GROW ||
+                  r.fn == STR_STATS_SHRINK || r.fn == STR_STATS_SHRINKFIT;
+      push_op(exact ? REPLAY_RESIZE : REPLAY_FIT, slot, r.cap, r.len);
+      map_erase(r.id);
+    }
+    map_put(r.to, slot);
+  }
+  free(free_slots);
+}
+
+/*.----------------------------------------------------------------------------,
+ /                                   replay                                  */
+
+static unsigned long replay_reallocs;
+static unsigned long replay_copied;
+
+/** resizes to cap, counting the bytes that str_realloc copies */
+static void
+resize(str *s, size_t cap) {
+  size_t msize = str_msize(*s);
+  size_t to    = msize - str_cap(*s) + cap;
+  replay_copied += msize < to ? msize : to;
+  ++replay_reallocs;
+  str_realloc(s, cap);
+  if (str_cap(*s) != cap)
+    check(NULL);
+}
+
+/** sets the len of s, writing the new chars [the len word precedes the
+ *  chars, see str.h] */
+static void
+set_len(str s, size_t len) {
+  size_t old = str_len(s);
+  if (len > old)
+    memset(s + old, 'x', len - old);
+  s[len]            = '\0';
+  ((size_t *)s)[-1] = len;
+}
+
+static void
+run(str *slots, replay_grow_fn grow) {
+  size_t i;
+  for (i = 0; i < replay_nops; ++i) {
+    const replay_op *op = &replay_ops[i];
+    str             *s  = &slots[op->slot];
+    switch (op->kind) {
+    case REPLAY_NEW:
+      check(*s = str_alloc(op->cap));
+      set_len(*s, op->len);
+      break;
+    case REPLAY_FIT:
+      if (str_cap(*s) < op->cap)
+        resize(s, grow(str_cap(*s), op->cap));
+      break;
+    case REPLAY_RESIZE:
+      resize(s, op->cap);
+      break;
+    case REPLAY_LEN:
+      if (str_cap(*s) < op->len)
+        resize(s, grow(str_cap(*s), op->len));
+      set_len(*s, op->len);
+      break;
+    case REPLAY_FREE:
+      str_free(s);
+      break;
+    }
+  }
+}
+
+/*.----------------------------------------------------------------------------,
+ /                                  workload                                 */
+
+/** records a log formatting workload: lines are built from fields of random
+ *  length, kept in a window of recent lines, and appended to a batch that is
+ *  cleared every 256 lines and shrunk every 4096. the batch is created
+ *  before the trace starts, as the strs of a live process are, so the trace
+ *  begins with an event on a block it has not seen */
+static void
+record(FILE *fp) {
+  static const char field[] = "2020-06-01T12:00:00Z GET /index.html 200 "
+                              "Mozilla/5.0 (X11; Linux x86_64) 0.0042";
+  str               window[64];
+  str               batch;
+  unsigned long     seed = 1;
+  size_t            i;
+  size_t            j;
+  batch = str_alloc(0);
+  str_trace_start(fp);
+  str_append(&batch, "# log\n");
+  for (i = 0; i < 64; ++i)
+    window[i] = str_alloc(0);
+  for (i = 0; i < 20000; ++i) {
+    str *line = &window[i % 64];
+    str_free(line);
+    *line = str_new("");
+    for (j = 0; j < 2 + i % 8; ++j) {
+      seed = seed * 1103515245UL + 12345UL;
+      str_append(line, field + (seed >> 16) % (sizeof(field) - 1));
+      str_append(line, ",");
+    }
+    if (i % 7 == 0)
+      str_prepend(line, "# ");
+    if (i % 5 == 0)
+      str_insert(line, "[tag]", str_len(*line) / 2);
+    str_append_(&batch, *line);
+    str_append(&batch, "\n");
+    if (i % 256 == 255)
+      str_clear(&batch);
+    if (i % 4096 == 4095)
+      str_shrinkfit(&batch);
+  }
+  for (i = 0; i < 64; ++i)
+    str_free(&window[i]);
+  str_free(&batch);
+  str_trace_stop();
+}
+
+/*.----------------------------------------------------------------------------,
+ /                                   driver                                  */
+
+int
+main(int argc, char **argv) {
+  FILE         *fp;
+  str          *slots;
+  unsigned long runs;
+  size_t        a;
+  size_t        p;
+  size_t        i;
+  replay_cur = &replay_allocators[0];
+  if (argc == 3 && strcmp(argv[1], "--record") == 0) {
+    if ((fp = fopen(argv[2], "wb")) == NULL) {
+      perror(argv[2]);
+      return 1;
+    }
+    record(fp);
+    return fclose(fp) != 0;
+  }
+  if (argc < 2 || argc > 3 || argv[1][0] == '-') {
+    fprintf(stderr, "usage: %s --record trace_file\n"
+                    "       %s trace_file [runs]\n",
+            argv[0], argv[0]);
+    return 1;
+  }
+  if ((fp = fopen(argv[1], "rb")) == NULL) {
+    perror(argv[1]);
+    return 1;
+  }
+  load(fp);
+  fclose(fp);
+  runs = argc > 2 ? strtoul(argv[2], NULL, 10) : 1;
+  check(slots = (str *)calloc(replay_nslots + 1, sizeof(str)));
+
+  printf("alloc,policy,events,ms,allocs,frees,reallocs,bytes_copied,"
+         "peak_bytes\n");
+  for (a = 0; a < sizeof(replay_allocators) / sizeof(*replay_allocators);
+       ++a) {
+    for (p = 0; p < sizeof(replay_policies) / sizeof(*replay_policies); ++p) {
+      unsigned long r;
+      double        best = -1;
+      unsigned long frees;
+      replay_cur = &replay_allocators[a];
+      for (r = 0; r == 0 || r < runs; ++r) {
+        clock_t t0;
+        double  secs;
+        replay_allocs   = 0;
+        replay_frees    = 0;
+        replay_reallocs = 0;
+        replay_copied   = 0;
+        replay_peak     = replay_held;
+        t0              = clock();
+        run(slots, replay_policies[p].grow);
+        secs  = (double)(clock() - t0) / CLOCKS_PER_SEC;
+        frees = replay_frees;
+        if (best < 0 || secs < best)
+          best = secs;
+        /* blocks that were live when the trace stopped */
+        for (i = 0; i < replay_nslots; ++i)
+          if (slots[i] != NULL)
+            str_free(&slots[i]);
+        replay_cur->reset();
+      }
+      printf("%s,%s,%lu,%.3f,%lu,%lu,%lu,%lu,%lu\n", replay_cur->name,
+             replay_policies[p].name, (unsigned long)replay_nops, best * 1000,
+             replay_allocs, frees, replay_reallocs, replay_copied,
+             (unsigned long)replay_peak);
+      fflush(stdout);
+    }
+  }
+
+  free(slots);
+  free(replay_ops);
+  free(replay_map);
+  return 0;
+}
@@ -32,26 +32,122 @@ note: all functions are static inline
  - - -                        ~ ~ construction ~ ~                        - - -
 
 str    str_alloc   (size_t cap)                 : create a str with capacity cap
+str    str_alloc_aligned                        : create a str whose chars and
+         (size_t cap)                             terminator fill whole aligned
+                                                  blocks [align]
 str    str_dup     (const str s)                : duplicate str storage (alloc)
 str    str_new     (const char *s)              : record length, allocate, copy
 str    str_sub     (const char *s, size_t len)  : copy up to len chars from s
+STR_LIT (name, "literal")                       : declare a static read-only
+                                                  str [no alloc]
 
  - - -                         ~ ~ properties ~ ~                         - - -
 
 int    str_avail     (const str s, size_t cap)  : true if capacity is available
 size_t str_cap       (const str s)              : retrieve the capacity
 char * str_end       (const str s)              : pointer to the null terminator
+int    str_islower   (const str s)              : true if no ASCII uppercase
+int    str_isupper   (const str s)              : true if no ASCII lowercase
 size_t str_len       (const str s)              : retrieve the length
 void * str_mbegin    (str s)                    : ptr to allocated memory begin
 void * str_mend      (str s)                    : ptr to allocated memory end
 size_t str_msize     (const str s)              : size of allocated memory
 str    str_mstr      (void *m)                  : str pointer from mbegin
 
+ - - -                         ~ ~ comparison ~ ~                         - - -
+
+int    str_casecmp      (const str a,           : order ignoring ASCII case
+                         const char *b)
+int    str_casecmp_     (const str a,
+                         const str b)
+int    str_caseeq       (const str a,           : true if equal ignoring ASCII
+                         const char *b)           case
+int    str_caseeq_      (const str a,
+                         const str b)
+int    str_cmp          (const str a,           : order by bytes, then length
+                         const char *b)
+int    str_cmp_         (const str a,
+                         const str b)
+int    str_ends_with    (const str s,           : true if s ends with suffix
+                         const char *suffix)
+int    str_ends_with_   (const str s,
+                         const str suffix)
+int    str_eq           (const str a,           : true if equal [lengths first]
+                         const char *b)
+int    str_eq_          (const str a,
+                         const str b)
+int    str_starts_with  (const str s,           : true if s begins with prefix
+                         const char *prefix)
+int    str_starts_with_ (const str s,
+                         const str prefix)
+
+ - - -                          ~ ~ unicode ~ ~                           - - -
+
+size_t str_utf8_len  (const str s)              : number of codepoints
+int    str_utf8_valid(const str s)              : true if s is valid utf-8
+                                                  [cached if configured]
+
+ - - -                          ~ ~ encoding ~ ~                          - - -
+
+void   str_append_base64      (str *s,          : append data in base64
+                               const void *data,  [exact size, <= 1 alloc]
+                               size_t n, int mode)
+void   str_append_csv_field   (str *s,          : append as a csv field
+                               const char *src,   [quoted if needed, <= 1 alloc]
+                               size_t n)
+void   str_append_hex         (str *s,          : append data in lowercase hex
+                               const void *data,  [exact size, <= 1 alloc]
+                               size_t n)
+void   str_append_json_escaped(str *s,          : append as json string chars
+                               const char *src,   [exact size, <= 1 alloc]
+                               size_t n)
+int    str_append_unbase64    (str *s,          : append decoded base64
+                               const char *src,   [-1 and *bad on failure]
+                               size_t n, int mode,
+                               size_t *bad)
+int    str_append_uncsv       (str *s,          : append an unquoted csv field
+                               const char *src,   [-1 and *bad on failure]
+                               size_t n, size_t *bad)
+int    str_append_unhex       (str *s,          : append decoded hex
+                               const char *src,   [-1 and *bad on failure]
+                               size_t n, size_t *bad)
+int    str_append_unjson      (str *s,          : append unescaped json chars
+                               const char *src,   [-1 and *bad on failure]
+                               size_t n, size_t *bad)
+int    str_append_unurl       (str *s,          : append percent-decoded chars
+                               const char *src,   [-1 and *bad on failure]
+                               size_t n, size_t *bad)
+void   str_append_url_encoded (str *s,          : append percent-encoded chars
+                               const char *src,   [exact size, <= 1 alloc]
+                               size_t n)
+
+ - - -                         ~ ~ conversion ~ ~                         - - -
+
+int    str_to_double (const char *s,            : parse a decimal double
+                      size_t n, double *out,      [locale-independent, rounded]
+                      size_t *used)               [1 on overflow, -2 no memory]
+int    str_to_double_(const str s, double *out,
+                      size_t *used)
+int    str_to_long   (const char *s,            : parse a decimal long
+                      size_t n, long *out,        [1 and saturated on overflow]
+                      size_t *used)
+int    str_to_long_  (const str s, long *out,
+                      size_t *used)
+int    str_to_ulong  (const char *s,            : parse a decimal unsigned long
+                      size_t n,                   [1 and saturated on overflow]
+                      unsigned long *out,
+                      size_t *used)
+int    str_to_ulong_ (const str s,
+                      unsigned long *out,
+                      size_t *used)
+
  - - -                        ~ ~ manipulation ~ ~                        - - -
 
 // concatenate //
 void   str_append    (str *a, const char *b)    : append to a
 void   str_append_   (str *a, const str b)
+void   str_append_n  (str *a, const char *b,    : append n chars of b
+                      size_t n)                   [may include null chars]
 void   str_prepend   (str *b, const char *a)    : prepend to b
 void   str_prepend_  (str *b, const str a)
 
@@ -60,15 +156,44 @@ void   str_emplace   (str *s, const char *ins,  : overwrite at idx
                       size_t idx)
 void   str_emplace_  (str *s, const str ins,
                       size_t idx)
+void   str_erase     (str *s, size_t idx,       : remove n chars at s[idx]
+                      size_t n)                   [no alloc]
 void   str_insert    (str *s, const char *ins,  : insert before s[idx]
                       size_t idx)
 void   str_insert_   (str *s, const str ins,
                       size_t idx)
+void   str_splice    (str *s, size_t idx,       : replace n chars at s[idx]
+                      size_t n,                   with inslen chars of ins
+                      const char *ins,            [<= 1 alloc; ins may
+                      size_t inslen)              point into *s]
+void   str_substr    (str *s, size_t idx,       : keep n chars at s[idx]
+                      size_t n)                   [no alloc]
+
+//    case     //
+void   str_cpylower  (str *dst,                 : copy src in ASCII lowercase
+                      const char *src)            [<= 1 alloc]
+void   str_cpylower_ (str *dst, const str src)
+void   str_cpyupper  (str *dst,                 : copy src in ASCII uppercase
+                      const char *src)            [<= 1 alloc]
+void   str_cpyupper_ (str *dst, const str src)
+void   str_tolower   (str *s)                   : ASCII lowercase in place
+                                                  [no write if unchanged]
+void   str_toupper   (str *s)                   : ASCII uppercase in place
+                                                  [no write if unchanged]
 
 //   format    //
 void   str_cpad      (str *s, size_t len)       : center pad to reach len
+void   str_cpadf     (str *s, size_t width,     : center pad with a fill
+                      const char *fill,           pattern to reach width
+                      int mode)                   [<= 1 alloc, 1 move]
 void   str_lpad      (str *s, size_t len)       : left pad to reach len
+void   str_lpadf     (str *s, size_t width,     : left pad with a fill pattern
+                      const char *fill,           to reach width
+                      int mode)                   [<= 1 alloc, 1 move]
 void   str_rpad      (str *s, size_t len)       : right pad to reach len
+void   str_rpadf     (str *s, size_t width,     : right pad with a fill
+                      const char *fill,           pattern to reach width
+                      int mode)                   [<= 1 alloc, no move]
 void   str_trim      (str *s)                   : trim leading and trailing
                                                   whitespace [no realloc]
 
@@ -80,6 +205,114 @@ void   str_realloc   (str *s, size_t cap)       : resize string [null if needed]
 void   str_shrink    (str *s, size_t delta)     : shrink cap [null if needed]
 void   str_shrinkfit (str *s)                   : shrink to len if cap > len
 
+ - - -                          ~ ~ editing ~ ~                           - - -
+
+void   str_edit_begin   (str_edit *e, str *s,   : open a gap at s[idx]
+                         size_t idx)
+void   str_edit_commit  (str_edit *e)           : close the gap, set len, term
+void   str_edit_erase   (str_edit *e, size_t n) : remove n chars after cursor
+void   str_edit_insert  (str_edit *e,           : insert chars at cursor
+                         const char *ins)
+void   str_edit_insert_ (str_edit *e,
+                         const str ins)
+size_t str_edit_len     (const str_edit *e)     : length of the edited text
+void   str_edit_seek    (str_edit *e,           : move the cursor to idx
+                         size_t idx)
+
+ - - -                          ~ ~ building ~ ~                          - - -
+
+void   str_builder_append   (str_builder *b,    : append chars [no copy on
+                             const char *s)       growth]
+void   str_builder_append_  (str_builder *b,
+                             const str s)
+str    str_builder_finish   (str_builder *b)    : join segments (alloc, 1 copy)
+void   str_builder_free     (str_builder *b)    : free segments, reset
+void   str_builder_init     (str_builder *b)    : empty builder [no alloc]
+size_t str_builder_len      (const str_builder  : total appended length
+                             *b)
+void   str_builder_reserve  (str_builder *b,    : room for n chars [<= 2 allocs]
+                             size_t n)
+int    str_builder_writev   (const str_builder  : write segments to fd [posix]
+                             *b, int fd)
+
+ - - -                          ~ ~ vectors ~ ~                           - - -
+
+void   str_vec_free     (str_vec *v)            : free the elements, reset
+char * str_vec_get      (const str_vec *v,      : element i and its length
+                         size_t i, size_t *len)   [no copy]
+str    str_vec_get_str  (const str_vec *v,      : copy of element i (alloc)
+                         size_t i)
+void   str_vec_init     (str_vec *v)            : empty vector [no alloc]
+size_t str_vec_len      (const str_vec *v)      : number of elements
+void   str_vec_pop      (str_vec *v)            : remove the last element
+void   str_vec_push     (str_vec *v,            : append an element [amortized
+                         const char *s)           O(1), no per-element alloc]
+void   str_vec_push_    (str_vec *v,
+                         const str s)
+void   str_vec_split    (str_vec *v,            : append the fields of buf
+                         const char *buf,         [1 copy]
+                         size_t len, char delim)
+
+ - - -                          ~ ~ sorting ~ ~                           - - -
+
+void   str_sort      (str *arr, size_t n)       : sort by bytes, then by length
+                                                  [no alloc, no strcmp]
+
+ - - -                          ~ ~ reading ~ ~                           - - -
+
+int    str_getline       (str_reader *r,        : read a line into *line
+                          str *line)              [reuses its capacity]
+int    str_getline_view  (str_reader *r,        : read a line in place
+                          const char **line,      [no copy]
+                          size_t *len)
+void   str_reader_free   (str_reader *r)        : free the buffer, reset
+void   str_reader_init   (str_reader *r,        : read lines from fp
+                          FILE *fp)               [no alloc]
+void   str_reader_initfd (str_reader *r,        : read lines from fd [posix]
+                          int fd)                 [no alloc]
+
+ - - -                           ~ ~ files ~ ~                            - - -
+
+str    str_read_file  (const char *path)        : load a file (1 alloc) [posix]
+size_t str_read_files (const char *const *paths,: load n files into out
+                       size_t n, str *out)        [posix] [io_uring opt.]
+int    str_sendfile   (int fd,                  : send a file to fd [posix]
+                       const char *path)          [no copy on linux]
+int    str_write_file (const char *path,        : store s [posix]
+                       const str s)
+int    str_writev     (int fd, const str *parts,: write n strs to fd [posix]
+                       size_t n)                  [no concatenation]
+
+// string tables //
+void   str_table_close (str_table *t)           : unmap the table [posix]
+str    str_table_get   (const str_table *t,     : read-only str at index i
+                        size_t i)                 [posix]
+int    str_table_open  (str_table *t,           : map a table file [posix]
+                        const char *path)
+int    str_table_write (const char *path,       : store n strs as a table
+                        const str *arr, size_t n)
+
+ - - -                         ~ ~ statistics ~ ~                         - - -
+
+void   str_stats_add    (str_stats *dst,        : add the counters of src to
+                         const str_stats *src)    dst [stats]
+void   str_stats_format (str *s,                : append as csv [stats]
+                         const str_stats *st)
+void   str_stats_get    (str_stats *out)        : counters of the calling
+                                                  thread [stats]
+void   str_stats_reset  (void)                  : zero the counters of the
+                                                  calling thread, but not its
+                                                  live slack [stats]
+
+// operation traces //
+int    str_trace_read  (FILE *fp,               : read the next record of a
+                        str_trace_record *r)      trace [trace]
+void   str_trace_start (FILE *fp)               : record the block events of
+                                                  the calling thread to fp
+                                                  [trace]
+void   str_trace_stop  (void)                   : write the pending records and
+                                                  stop recording [trace]
+
  - - -                        ~ ~ destruction ~ ~                         - - -
 
 void   str_free      (str *s)                   : free owned string, nullify ptr
@@ -89,14 +322,43 @@ void   str_free      (str *s)                   : free owned string, nullify ptr
 #ifdef __cplusplus
 extern "C" {
 #include <cctype>
+#include <cerrno>
+#include <cfloat>
+#include <climits>
+#include <clocale>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #else
 #include <ctype.h>
+#include <errno.h>
+#include <float.h>
+#include <limits.h>
+#include <locale.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #endif
 
+#ifdef STR_CONFIG_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+#ifdef STR_CONFIG_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
 /*.----------------------------------------------------------------------------,
  /                               detail macros                               */
 
@@ -124,6 +386,92 @@ extern "C" {
 #  define STR_DETAIL_USING_CUSTOM_FREE
 #endif
 
+#ifndef   STR_CONFIG_BUILDER_SEGMENT
+/** defines the minimum segment capacity of a str_builder [default 64KiB] */
+#  define STR_CONFIG_BUILDER_SEGMENT 65536
+#else
+#  define STR_DETAIL_USING_CUSTOM_BUILDER_SEGMENT
+#endif
+
+#ifndef   STR_CONFIG_READER_BUFFER
+/** defines the initial buffer capacity of a str_reader [default 64KiB] */
+#  define STR_CONFIG_READER_BUFFER 65536
+#else
+#  define STR_DETAIL_USING_CUSTOM_READER_BUFFER
+#endif
+
+#ifndef   STR_CONFIG_TRACE_BUFFER
+/** defines the per-thread write buffer of a trace [default 4KiB, min 64] */
+#  define STR_CONFIG_TRACE_BUFFER 4096
+#else
+#  define STR_DETAIL_USING_CUSTOM_TRACE_BUFFER
+#endif
+
+/* STR_CONFIG_UTF8_CACHE [default undefined]
+ *  caches the result of str_utf8_valid in the capacity word; the library
+ *  drops it whenever it writes to a str, but writes made directly through
+ *  the char pointer are not tracked */
+
+/* STR_CONFIG_ALIGN [default undefined]
+ *  a power of two from 16 to 128, eg 32 or 64 for AVX2 or AVX-512; aligns
+ *  the chars of every allocated str to that many bytes and keeps at least
+ *  as many readable bytes past the terminator, so that vector kernels may
+ *  load whole aligned blocks [see str_alloc_aligned]. each block then
+ *  spends up to twice the alignment on a gap before its header and on the
+ *  padding. read-only strs keep the plain layout */
+
+/* STR_CONFIG_STATS [default undefined]
+ *  counts allocations, frees, copies, shifts, and slack by API function
+ *  [see str_stats_get]; the counters are thread-local and, as all functions
+ *  are static, kept per translation unit. compiles to nothing if undefined */
+
+/* STR_CONFIG_TRACE [default undefined]
+ *  records the block events of each API function to a file [see
+ *  str_trace_start] for the replay program; the recording state is
+ *  thread-local and kept per translation unit. compiles to nothing if
+ *  undefined */
+
+/* STR_CONFIG_POSIX [default undefined]
+ *  enables the functions that operate on file descriptors
+ *  requires a POSIX system; define the feature test macros as well,
+ *  eg `#define _POSIX_C_SOURCE 200809L` before any inclusion */
+
+/* STR_CONFIG_MMAP_THRESHOLD [default undefined]
+ *  an allocation size in bytes, eg 16MiB; blocks at least this large are
+ *  mapped with mmap instead of allocated, resized with mremap where
+ *  available [Linux] so that growing copies nothing, and unmapped by
+ *  str_free. whether a block is mapped follows from its capacity, so the
+ *  strs are otherwise used as any other. a new mapping is faulted in page
+ *  by page, so creating one costs more than reusing freed heap memory.
+ *  requires STR_CONFIG_POSIX and MAP_ANONYMOUS, eg `#define _GNU_SOURCE` */
+
+/* STR_CONFIG_MMAP_HUGEPAGE [default undefined]
+ *  advises transparent huge pages for mapped blocks [MADV_HUGEPAGE, where
+ *  available; see STR_CONFIG_MMAP_THRESHOLD] */
+
+/* STR_CONFIG_IO_URING [default undefined]
+ *  str_read_files submits the opens, reads, and closes of a batch of files
+ *  through one io_uring instead of a syscall each, falling back to the
+ *  sequential loop if the kernel refuses the ring. requires
+ *  STR_CONFIG_POSIX, Linux 5.6, and `#define _GNU_SOURCE` [syscall] */
+
+#if defined STR_CONFIG_ALIGN &&                                  \
+    (STR_CONFIG_ALIGN < 16 || STR_CONFIG_ALIGN > 128 ||          \
+     (STR_CONFIG_ALIGN & (STR_CONFIG_ALIGN - 1)) != 0)
+#  error "STR_CONFIG_ALIGN must be a power of two from 16 to 128"
+#endif
+
+#if defined STR_CONFIG_MMAP_THRESHOLD && \
+    (!defined STR_CONFIG_POSIX || !defined MAP_ANONYMOUS)
+#  error "STR_CONFIG_MMAP_THRESHOLD needs STR_CONFIG_POSIX and MAP_ANONYMOUS"
+#endif
+
+#if defined STR_CONFIG_IO_URING &&                            \
+    (!defined STR_CONFIG_POSIX || !defined __NR_io_uring_setup || \
+     !defined _GNU_SOURCE)
+#  error "STR_CONFIG_IO_URING needs STR_CONFIG_POSIX, Linux, and _GNU_SOURCE"
+#endif
+
 /*                                preprocessor                                */
 
 /** Cat. */
@@ -151,30 +499,76 @@ extern "C" {
 
 /** temporary definitions for project readability; undefined at end of file */
 #ifdef STR_DETAIL_USING_CUSTOM_NAMESPACE
-#  define str           STR_CONFIG_NAMESPACE
-#  define str_alloc     STR_DETAIL_NS_FN(alloc)
-#  define str_dup       STR_DETAIL_NS_FN(dup)
-#  define str_new       STR_DETAIL_NS_FN(new)
-#  define str_sub       STR_DETAIL_NS_FN(sub)
-#  define str_avail     STR_DETAIL_NS_FN(avail)
-#  define str_cap       STR_DETAIL_NS_FN(cap)
-#  define str_end       STR_DETAIL_NS_FN(end)
-#  define str_len       STR_DETAIL_NS_FN(len)
-#  define str_mbegin    STR_DETAIL_NS_FN(mbegin)
-#  define str_mend      STR_DETAIL_NS_FN(mend)
-#  define str_msize     STR_DETAIL_NS_FN(msize)
-#  define str_mstr      STR_DETAIL_NS_FN(mstr)
+#  define str               STR_CONFIG_NAMESPACE
+#  define str_alloc         STR_DETAIL_NS_FN(alloc)
+#  define str_alloc_aligned STR_DETAIL_NS_FN(alloc_aligned)
+#  define str_dup           STR_DETAIL_NS_FN(dup)
+#  define str_new           STR_DETAIL_NS_FN(new)
+#  define str_sub           STR_DETAIL_NS_FN(sub)
+#  define str_avail         STR_DETAIL_NS_FN(avail)
+#  define str_cap           STR_DETAIL_NS_FN(cap)
+#  define str_end           STR_DETAIL_NS_FN(end)
+#  define str_islower       STR_DETAIL_NS_FN(islower)
+#  define str_isupper       STR_DETAIL_NS_FN(isupper)
+#  define str_len           STR_DETAIL_NS_FN(len)
+#  define str_mbegin        STR_DETAIL_NS_FN(mbegin)
+#  define str_mend          STR_DETAIL_NS_FN(mend)
+#  define str_msize         STR_DETAIL_NS_FN(msize)
+#  define str_mstr          STR_DETAIL_NS_FN(mstr)
+#  define str_casecmp      STR_DETAIL_NS_FN(casecmp)
+#  define str_casecmp_     STR_DETAIL_NS_FN(casecmp_)
+#  define str_caseeq       STR_DETAIL_NS_FN(caseeq)
+#  define str_caseeq_      STR_DETAIL_NS_FN(caseeq_)
+#  define str_cmp          STR_DETAIL_NS_FN(cmp)
+#  define str_cmp_         STR_DETAIL_NS_FN(cmp_)
+#  define str_ends_with    STR_DETAIL_NS_FN(ends_with)
+#  define str_ends_with_   STR_DETAIL_NS_FN(ends_with_)
+#  define str_eq           STR_DETAIL_NS_FN(eq)
+#  define str_eq_          STR_DETAIL_NS_FN(eq_)
+#  define str_starts_with  STR_DETAIL_NS_FN(starts_with)
+#  define str_starts_with_ STR_DETAIL_NS_FN(starts_with_)
+#  define str_utf8_len   STR_DETAIL_NS_FN(utf8_len)
+#  define str_utf8_valid STR_DETAIL_NS_FN(utf8_valid)
+#  define str_append_base64       STR_DETAIL_NS_FN(append_base64)
+#  define str_append_csv_field    STR_DETAIL_NS_FN(append_csv_field)
+#  define str_append_hex          STR_DETAIL_NS_FN(append_hex)
+#  define str_append_json_escaped STR_DETAIL_NS_FN(append_json_escaped)
+#  define str_append_unbase64     STR_DETAIL_NS_FN(append_unbase64)
+#  define str_append_uncsv        STR_DETAIL_NS_FN(append_uncsv)
+#  define str_append_unhex        STR_DETAIL_NS_FN(append_unhex)
+#  define str_append_unjson       STR_DETAIL_NS_FN(append_unjson)
+#  define str_append_unurl        STR_DETAIL_NS_FN(append_unurl)
+#  define str_append_url_encoded  STR_DETAIL_NS_FN(append_url_encoded)
+#  define str_to_double  STR_DETAIL_NS_FN(to_double)
+#  define str_to_double_ STR_DETAIL_NS_FN(to_double_)
+#  define str_to_long    STR_DETAIL_NS_FN(to_long)
+#  define str_to_long_   STR_DETAIL_NS_FN(to_long_)
+#  define str_to_ulong   STR_DETAIL_NS_FN(to_ulong)
+#  define str_to_ulong_  STR_DETAIL_NS_FN(to_ulong_)
 #  define str_append    STR_DETAIL_NS_FN(append)
 #  define str_append_   STR_DETAIL_NS_FN(append_)
+#  define str_append_n  STR_DETAIL_NS_FN(append_n)
 #  define str_prepend   STR_DETAIL_NS_FN(prepend)
 #  define str_prepend_  STR_DETAIL_NS_FN(prepend_)
 #  define str_emplace   STR_DETAIL_NS_FN(emplace)
 #  define str_emplace_  STR_DETAIL_NS_FN(emplace_)
+#  define str_erase     STR_DETAIL_NS_FN(erase)
 #  define str_insert    STR_DETAIL_NS_FN(insert)
 #  define str_insert_   STR_DETAIL_NS_FN(insert_)
+#  define str_splice    STR_DETAIL_NS_FN(splice)
+#  define str_substr    STR_DETAIL_NS_FN(substr)
+#  define str_cpylower  STR_DETAIL_NS_FN(cpylower)
+#  define str_cpylower_ STR_DETAIL_NS_FN(cpylower_)
+#  define str_cpyupper  STR_DETAIL_NS_FN(cpyupper)
+#  define str_cpyupper_ STR_DETAIL_NS_FN(cpyupper_)
+#  define str_tolower   STR_DETAIL_NS_FN(tolower)
+#  define str_toupper   STR_DETAIL_NS_FN(toupper)
 #  define str_cpad      STR_DETAIL_NS_FN(cpad)
+#  define str_cpadf     STR_DETAIL_NS_FN(cpadf)
 #  define str_lpad      STR_DETAIL_NS_FN(lpad)
+#  define str_lpadf     STR_DETAIL_NS_FN(lpadf)
 #  define str_rpad      STR_DETAIL_NS_FN(rpad)
+#  define str_rpadf     STR_DETAIL_NS_FN(rpadf)
 #  define str_trim      STR_DETAIL_NS_FN(trim)
 #  define str_clear     STR_DETAIL_NS_FN(clear)
 #  define str_fit       STR_DETAIL_NS_FN(fit)
@@ -182,6 +576,60 @@ extern "C" {
 #  define str_realloc   STR_DETAIL_NS_FN(realloc)
 #  define str_shrink    STR_DETAIL_NS_FN(shrink)
 #  define str_shrinkfit STR_DETAIL_NS_FN(shrinkfit)
+#  define str_edit         STR_DETAIL_NS_FN(edit)
+#  define str_edit_begin   STR_DETAIL_NS_FN(edit_begin)
+#  define str_edit_commit  STR_DETAIL_NS_FN(edit_commit)
+#  define str_edit_erase   STR_DETAIL_NS_FN(edit_erase)
+#  define str_edit_insert  STR_DETAIL_NS_FN(edit_insert)
+#  define str_edit_insert_ STR_DETAIL_NS_FN(edit_insert_)
+#  define str_edit_len     STR_DETAIL_NS_FN(edit_len)
+#  define str_edit_seek    STR_DETAIL_NS_FN(edit_seek)
+#  define str_builder         STR_DETAIL_NS_FN(builder)
+#  define str_builder_append  STR_DETAIL_NS_FN(builder_append)
+#  define str_builder_append_ STR_DETAIL_NS_FN(builder_append_)
+#  define str_builder_finish  STR_DETAIL_NS_FN(builder_finish)
+#  define str_builder_free    STR_DETAIL_NS_FN(builder_free)
+#  define str_builder_init    STR_DETAIL_NS_FN(builder_init)
+#  define str_builder_len     STR_DETAIL_NS_FN(builder_len)
+#  define str_builder_reserve STR_DETAIL_NS_FN(builder_reserve)
+#  define str_builder_writev  STR_DETAIL_NS_FN(builder_writev)
+#  define str_vec         STR_DETAIL_NS_FN(vec)
+#  define str_vec_free    STR_DETAIL_NS_FN(vec_free)
+#  define str_vec_get     STR_DETAIL_NS_FN(vec_get)
+#  define str_vec_get_str STR_DETAIL_NS_FN(vec_get_str)
+#  define str_vec_init    STR_DETAIL_NS_FN(vec_init)
+#  define str_vec_len     STR_DETAIL_NS_FN(vec_len)
+#  define str_vec_pop     STR_DETAIL_NS_FN(vec_pop)
+#  define str_vec_push    STR_DETAIL_NS_FN(vec_push)
+#  define str_vec_push_   STR_DETAIL_NS_FN(vec_push_)
+#  define str_vec_split   STR_DETAIL_NS_FN(vec_split)
+#  define str_sort STR_DETAIL_NS_FN(sort)
+#  define str_getline       STR_DETAIL_NS_FN(getline)
+#  define str_getline_view  STR_DETAIL_NS_FN(getline_view)
+#  define str_reader        STR_DETAIL_NS_FN(reader)
+#  define str_reader_free   STR_DETAIL_NS_FN(reader_free)
+#  define str_reader_init   STR_DETAIL_NS_FN(reader_init)
+#  define str_reader_initfd STR_DETAIL_NS_FN(reader_initfd)
+#  define str_read_file  STR_DETAIL_NS_FN(read_file)
+#  define str_read_files STR_DETAIL_NS_FN(read_files)
+#  define str_sendfile   STR_DETAIL_NS_FN(sendfile)
+#  define str_write_file STR_DETAIL_NS_FN(write_file)
+#  define str_writev     STR_DETAIL_NS_FN(writev)
+#  define str_table       STR_DETAIL_NS_FN(table)
+#  define str_table_close STR_DETAIL_NS_FN(table_close)
+#  define str_table_get   STR_DETAIL_NS_FN(table_get)
+#  define str_table_open  STR_DETAIL_NS_FN(table_open)
+#  define str_table_write STR_DETAIL_NS_FN(table_write)
+#  define str_stats        STR_DETAIL_NS_FN(stats)
+#  define str_stats_add    STR_DETAIL_NS_FN(stats_add)
+#  define str_stats_entry  STR_DETAIL_NS_FN(stats_entry)
+#  define str_stats_format STR_DETAIL_NS_FN(stats_format)
+#  define str_stats_get    STR_DETAIL_NS_FN(stats_get)
+#  define str_stats_reset  STR_DETAIL_NS_FN(stats_reset)
+#  define str_trace_read   STR_DETAIL_NS_FN(trace_read)
+#  define str_trace_record STR_DETAIL_NS_FN(trace_record)
+#  define str_trace_start  STR_DETAIL_NS_FN(trace_start)
+#  define str_trace_stop   STR_DETAIL_NS_FN(trace_stop)
 #  define str_free      STR_DETAIL_NS_FN(free)
 #endif
 
@@ -191,35 +639,816 @@ extern "C" {
 
 /** defines the size of the memory block given a capacity */
 #define STR_DETAIL_MEMORY_SIZE(cap) \
-  sizeof(size_t) * 2 + sizeof(char) * (cap + 1)
+  (sizeof(size_t) * 2 + sizeof(char) * ((cap) + 1))
+
+/** defines the size of the allocation of a block given a capacity
+ *  aligned: | gap [1, align] | cap | len | chars | \0 | padding [align] |
+ *  the last byte of the gap records its size [see str_mstr] */
+#ifdef STR_CONFIG_ALIGN
+#  define STR_DETAIL_ALLOC_SIZE(cap) \
+    (STR_DETAIL_MEMORY_SIZE(cap) + 2 * STR_CONFIG_ALIGN)
+#else
+#  define STR_DETAIL_ALLOC_SIZE(cap) STR_DETAIL_MEMORY_SIZE(cap)
+#endif
 
 /** shifts a char* to the left by n */
-#define STR_DETAIL_SHIFT_LEFT(cstr, len, n) \
-  {                                         \
-    size_t i_;                              \
-    for (i_ = 0; i_ < len; ++i_)            \
-      (cstr)[i_ - n] = (cstr)[i_];          \
+#define STR_DETAIL_SHIFT_LEFT(cstr, len, n)   \
+  {                                           \
+    size_t i_;                                \
+    STR_DETAIL_STATS_ADD(bytes_shifted, len); \
+    for (i_ = 0; i_ < len; ++i_)              \
+      (cstr)[i_ - n] = (cstr)[i_];            \
   }
 
 /** shifts a char* to the right by n */
-#define STR_DETAIL_SHIFT_RIGHT(cstr, len, n) \
-  {                                          \
-    size_t i_;                               \
-    for (i_ = len + 1; i_ > 0; --i_)         \
-      (cstr)[(i_ - 1) + n] = (cstr)[i_ - 1]; \
+#define STR_DETAIL_SHIFT_RIGHT(cstr, len, n)      \
+  {                                               \
+    size_t i_;                                    \
+    STR_DETAIL_STATS_ADD(bytes_shifted, len + 1); \
+    for (i_ = len + 1; i_ > 0; --i_)              \
+      (cstr)[(i_ - 1) + n] = (cstr)[i_ - 1];      \
   }
 
-/** assigns len to its memory location */
-#define STR_DETAIL_SET_LEN(str, len) *(((size_t *)(str)) - 1) = len
+/** assigns len to its memory location [drops the utf-8 cache] */
+#define STR_DETAIL_SET_LEN(str, len)                           \
+  (STR_DETAIL_DROP_CACHE(str), STR_DETAIL_STATS_LEN(str, len), \
+   STR_DETAIL_INIT_LEN(str, len),                              \
+   STR_DETAIL_TRACE(str, str, str_cap(str), str_len(str)))
+
+/** assigns len to a new block [its previous len is undefined] */
+#define STR_DETAIL_INIT_LEN(str, len) (*(((size_t *)(str)) - 1) = (len))
 
-/** assigns cap to its memory location */
+/** assigns cap to its memory location [clears the flags] */
 #define STR_DETAIL_SET_CAP(str, cap) *(((size_t *)(str)) - 2) = cap
 
+/** read-only flag, stored in the top bit of the capacity
+ *  marks strs that are not owned by the allocator (eg mapped table entries
+ *  and STR_LIT blocks);
+ *  manipulators copy them to an owned block before writing, and str_free
+ *  only nullifies the pointer */
+#define STR_DETAIL_FLAG_RO (~(~(size_t)0 >> 1))
+
+/** cache flags [see STR_CONFIG_UTF8_CACHE]; valid ascii implies valid utf-8 */
+#define STR_DETAIL_FLAG_ASCII (STR_DETAIL_FLAG_RO >> 1)
+#define STR_DETAIL_FLAG_UTF8  (STR_DETAIL_FLAG_RO >> 2)
+
+/** all flag bits of the capacity */
+#define STR_DETAIL_FLAGS \
+  (STR_DETAIL_FLAG_RO | STR_DETAIL_FLAG_ASCII | STR_DETAIL_FLAG_UTF8)
+
+/** clears the cache flags of an owned str */
+#ifdef STR_CONFIG_UTF8_CACHE
+#  define STR_DETAIL_DROP_CACHE(str)  \
+    (*(((size_t *)(str)) - 2) &=      \
+     ~(STR_DETAIL_FLAG_ASCII | STR_DETAIL_FLAG_UTF8))
+#else
+#  define STR_DETAIL_DROP_CACHE(str) ((void)0)
+#endif
+
+/** true if the str is read-only */
+#define STR_DETAIL_IS_RO(str) \
+  ((*(((size_t *)(str)) - 2) & STR_DETAIL_FLAG_RO) != 0)
+
+/*                                 statistics                                 */
+
+#if defined STR_CONFIG_STATS || defined STR_CONFIG_TRACE
+/** thread-local storage class [falls back to one global state] */
+#  if defined __cplusplus && __cplusplus >= 201103L
+#    define STR_DETAIL_THREAD_LOCAL thread_local
+#  elif defined __STDC_VERSION__ && __STDC_VERSION__ >= 201112L
+#    define STR_DETAIL_THREAD_LOCAL _Thread_local
+#  elif defined __GNUC__
+#    define STR_DETAIL_THREAD_LOCAL __thread
+#  elif defined _MSC_VER
+#    define STR_DETAIL_THREAD_LOCAL __declspec(thread)
+#  else
+#    define STR_DETAIL_THREAD_LOCAL
+#  endif
+/** attributes the following events to API function fn [see str_stats and
+ *  str_trace_record]; ignored in a function called by the library itself */
+#  define STR_DETAIL_STATS_FN(fn) \
+    (str_detail_stats_nest == 0 ? (void)(str_detail_stats_fn = (fn)) : (void)0)
+/** evaluates a library call made by the library [keeps the attribution] */
+#  define STR_DETAIL_INNER(call) \
+    (++str_detail_stats_nest, (call), --str_detail_stats_nest)
+#else
+#  define STR_DETAIL_STATS_FN(fn) ((void)0)
+#  define STR_DETAIL_INNER(call)  call
+#endif
+
+#ifdef STR_CONFIG_STATS
+/** adds n to a counter of the current function */
+#  define STR_DETAIL_STATS_ADD(counter, n) \
+    (str_detail_stats.fn[str_detail_stats_fn].counter += (n))
+/** adds n to the slack of the current function and to the live slack */
+#  define STR_DETAIL_STATS_SLACK(n) str_detail_stats_slack((ptrdiff_t)(n))
+/** accounts for the slack change of setting the len of str */
+#  define STR_DETAIL_STATS_LEN(str, len)                     \
+    (STR_DETAIL_IS_RO(str)                                   \
+         ? (void)0                                           \
+         : STR_DETAIL_STATS_SLACK((ptrdiff_t)str_len(str) - \
+                                  (ptrdiff_t)(len)))
+#else
+#  define STR_DETAIL_STATS_ADD(counter, n) ((void)0)
+#  define STR_DETAIL_STATS_SLACK(n)        ((void)0)
+#  define STR_DETAIL_STATS_LEN(str, len)   ((void)0)
+#endif
+
+#ifdef STR_CONFIG_TRACE
+/** maximum size of an encoded trace record [fn and 4 varints] */
+#  define STR_DETAIL_TRACE_RECORD_MAX \
+    (1 + 4 * ((sizeof(size_t) * CHAR_BIT + 6) / 7))
+/** records that block id became block to [see str_trace_record] */
+#  define STR_DETAIL_TRACE(id, to, cap, len) \
+    str_detail_trace((const char *)(id), (const char *)(to), cap, len)
+#else
+#  define STR_DETAIL_TRACE(id, to, cap, len) ((void)0)
+#endif
+
+/** calls the allocator [counted in stats mode] */
+#define STR_DETAIL_MALLOC(n)        \
+  (STR_DETAIL_STATS_ADD(allocs, 1), \
+   STR_DETAIL_STATS_ADD(bytes_allocated, n), STR_CONFIG_MALLOC(n))
+
+/** calls the deallocator [counted in stats mode] */
+#define STR_DETAIL_FREE(p) (STR_DETAIL_STATS_ADD(frees, 1), STR_CONFIG_FREE(p))
+
+#ifdef STR_CONFIG_MMAP_THRESHOLD
+/** whether the block of a capacity is mapped rather than allocated */
+#  define STR_DETAIL_IS_MAPPED(cap) \
+    (STR_DETAIL_ALLOC_SIZE(cap) >= (size_t)(STR_CONFIG_MMAP_THRESHOLD))
+/** allocates the block of a capacity [mapped if large enough] */
+#  define STR_DETAIL_ALLOC_BLOCK(cap)                             \
+    (STR_DETAIL_IS_MAPPED(cap)                                    \
+         ? str_detail_map(STR_DETAIL_ALLOC_SIZE(cap))             \
+         : (void *)STR_DETAIL_MALLOC(STR_DETAIL_ALLOC_SIZE(cap)))
+/** frees the block of an owned str [unmapped if mapped] */
+#  define STR_DETAIL_FREE_BLOCK(s)                             \
+    (STR_DETAIL_IS_MAPPED(str_cap(s))                          \
+         ? str_detail_unmap(str_mbegin(s),                     \
+                            STR_DETAIL_ALLOC_SIZE(str_cap(s))) \
+         : (void)STR_DETAIL_FREE(str_mbegin(s)))
+#  if defined STR_CONFIG_MMAP_HUGEPAGE && defined MADV_HUGEPAGE
+#    define STR_DETAIL_MADVISE(p, n) ((void)madvise(p, n, MADV_HUGEPAGE))
+#  else
+#    define STR_DETAIL_MADVISE(p, n) ((void)0)
+#  endif
+#else
+#  define STR_DETAIL_ALLOC_BLOCK(cap) \
+    STR_DETAIL_MALLOC(STR_DETAIL_ALLOC_SIZE(cap))
+#  define STR_DETAIL_FREE_BLOCK(s) STR_DETAIL_FREE(str_mbegin(s))
+#endif
+
+/** folds an ASCII uppercase char to lowercase [branch-free] */
+#define STR_DETAIL_FOLD(c)              \
+  ((unsigned char)((unsigned char)(c) + \
+                   (((unsigned char)((c) - 'A') < 26) << 5)))
+
+/** converts an ASCII lowercase char to uppercase [branch-free] */
+#define STR_DETAIL_UNFOLD(c)            \
+  ((unsigned char)((unsigned char)(c) - \
+                   (((unsigned char)((c) - 'a') < 26) << 5)))
+
+/** true if c is an ASCII uppercase letter */
+#define STR_DETAIL_IS_UPPER(c) ((unsigned char)((c) - 'A') < 26)
+
+/** true if c is an ASCII lowercase letter */
+#define STR_DETAIL_IS_LOWER(c) ((unsigned char)((c) - 'a') < 26)
+
+/** block size of STR_DETAIL_CASE_MISMATCH and STR_DETAIL_FIND */
+#define STR_DETAIL_SCAN_BLOCK 64
+
+/** chars probed one at a time by STR_DETAIL_FIND before it scans blocks */
+#define STR_DETAIL_SCAN_PROBE 16
+
+/** idx = first index in [0, n) where a and b differ ignoring ASCII case, or n
+ *  blocks are compared without branches so that the inner loop vectorizes */
+#define STR_DETAIL_CASE_MISMATCH(a, b, n, idx)                     \
+  {                                                                \
+    const unsigned char *a_ = (const unsigned char *)(a);          \
+    const unsigned char *b_ = (const unsigned char *)(b);          \
+    size_t               n_ = (n);                                 \
+    size_t               i_ = 0;                                   \
+    while (i_ < n_) {                                              \
+      size_t        e_   = n_ - i_ < STR_DETAIL_SCAN_BLOCK         \
+                               ? n_                                \
+                               : i_ + STR_DETAIL_SCAN_BLOCK;       \
+      unsigned char acc_ = 0;                                      \
+      size_t        j_;                                            \
+      for (j_ = i_; j_ < e_; ++j_)                                 \
+        acc_ |= STR_DETAIL_FOLD(a_[j_]) ^ STR_DETAIL_FOLD(b_[j_]); \
+      if (acc_ != 0) {                                             \
+        while (STR_DETAIL_FOLD(a_[i_]) == STR_DETAIL_FOLD(b_[i_])) \
+          ++i_;                                                    \
+        break;                                                     \
+      }                                                            \
+      i_ = e_;                                                     \
+    }                                                              \
+    (idx) = i_;                                                    \
+  }
+
+/** idx = first index in [0, n) of a char of s that satisfies pred, or n
+ *  the first chars are probed one at a time so that dense matches stay cheap;
+ *  blocks are then tested without branches so that the inner loop vectorizes */
+#define STR_DETAIL_FIND(s, n, pred, idx)                     \
+  {                                                          \
+    const unsigned char *s_ = (const unsigned char *)(s);    \
+    size_t               n_ = (n);                           \
+    size_t               i_ = 0;                             \
+    size_t               p_ = n_ < STR_DETAIL_SCAN_PROBE     \
+                                  ? n_                       \
+                                  : STR_DETAIL_SCAN_PROBE;   \
+    while (i_ < p_ && !pred(s_[i_]))                         \
+      ++i_;                                                  \
+    while (i_ == p_ && i_ < n_) {                            \
+      size_t        e_   = n_ - i_ < STR_DETAIL_SCAN_BLOCK   \
+                               ? n_                          \
+                               : i_ + STR_DETAIL_SCAN_BLOCK; \
+      unsigned char acc_ = 0;                                \
+      size_t        j_;                                      \
+      for (j_ = i_; j_ < e_; ++j_)                           \
+        acc_ |= pred(s_[j_]);                                \
+      if (acc_ != 0) {                                       \
+        while (!pred(s_[i_]))                                \
+          ++i_;                                              \
+        break;                                               \
+      }                                                      \
+      i_ = p_ = e_;                                          \
+    }                                                        \
+    (idx) = i_;                                              \
+  }
+
+/** STR_DETAIL_FIND and STR_DETAIL_CASE_MISMATCH over strs
+ *  with STR_CONFIG_ALIGN, whole aligned blocks are tested from the first char,
+ *  reading into the padding, so the inner loop has a fixed trip count and no
+ *  scalar head or tail. a match or mismatch past n only ends the search
+ *  [idx is then n]. read-only strs have no padding and use the plain
+ *  kernels */
+#ifdef STR_CONFIG_ALIGN
+#  define STR_DETAIL_FIND_STR(s, n, pred, idx)                \
+    {                                                         \
+      if (STR_DETAIL_IS_RO(s))                                \
+        STR_DETAIL_FIND(s, n, pred, idx)                      \
+      else {                                                  \
+        const unsigned char *s_ = (const unsigned char *)(s); \
+        size_t               n_ = (n);                        \
+        size_t               i_;                              \
+        for (i_ = 0; i_ < n_; i_ += STR_CONFIG_ALIGN) {       \
+          unsigned char acc_ = 0;                             \
+          size_t        j_;                                   \
+          for (j_ = 0; j_ < STR_CONFIG_ALIGN; ++j_)           \
+            acc_ |= pred(s_[i_ + j_]);                        \
+          if (acc_ != 0) {                                    \
+            while (!pred(s_[i_]))                             \
+              ++i_;                                           \
+            break;                                            \
+          }                                                   \
+        }                                                     \
+        (idx) = i_ < n_ ? i_ : n_;                            \
+      }                                                       \
+    }
+#  define STR_DETAIL_CASE_MISMATCH_STR(a, b, n, idx)                   \
+    {                                                                  \
+      if (STR_DETAIL_IS_RO(a) || STR_DETAIL_IS_RO(b))                  \
+        STR_DETAIL_CASE_MISMATCH(a, b, n, idx)                         \
+      else {                                                           \
+        const unsigned char *a_ = (const unsigned char *)(a);          \
+        const unsigned char *b_ = (const unsigned char *)(b);          \
+        size_t               n_ = (n);                                 \
+        size_t               i_;                                       \
+        for (i_ = 0; i_ < n_; i_ += STR_CONFIG_ALIGN) {                \
+          unsigned char acc_ = 0;                                      \
+          size_t        j_;                                            \
+          for (j_ = 0; j_ < STR_CONFIG_ALIGN; ++j_)                    \
+            acc_ |= STR_DETAIL_FOLD(a_[i_ + j_]) ^                     \
+                    STR_DETAIL_FOLD(b_[i_ + j_]);                      \
+          if (acc_ != 0) {                                             \
+            while (i_ < n_ &&                                          \
+                   STR_DETAIL_FOLD(a_[i_]) == STR_DETAIL_FOLD(b_[i_])) \
+              ++i_;                                                    \
+            break;                                                     \
+          }                                                            \
+        }                                                              \
+        (idx) = i_ < n_ ? i_ : n_;                                     \
+      }                                                                \
+    }
+#else
+#  define STR_DETAIL_FIND_STR          STR_DETAIL_FIND
+#  define STR_DETAIL_CASE_MISMATCH_STR STR_DETAIL_CASE_MISMATCH
+#endif
+
+/** n = number of bytes in the first u units of pattern, repeated as needed
+ *  plen is the pattern length in bytes and punits in units (see STR_PAD_*) */
+#define STR_DETAIL_PAD_BYTES(pat, plen, punits, mode, u, n)         \
+  {                                                                 \
+    size_t r_ = (u) % (punits);                                     \
+    size_t i_ = 0;                                                  \
+    if ((mode) == STR_PAD_CODEPOINTS)                               \
+      for (; r_ > 0; --r_)                                          \
+        for (++i_; i_ < (plen) && ((pat)[i_] & 0xC0) == 0x80; ++i_) \
+          ;                                                         \
+    else                                                            \
+      i_ = r_;                                                      \
+    (n) = (u) / (punits) * (plen) + i_;                             \
+  }
+
+/** fills n bytes at dst with repetitions of pattern [doubling memcpy] */
+#define STR_DETAIL_PATTERN_FILL(dst, n, pat, plen) \
+  {                                                \
+    char  *d_ = (dst);                             \
+    size_t n_ = (n);                               \
+    size_t k_ = (plen) < n_ ? (plen) : n_;         \
+    memcpy(d_, (pat), k_);                         \
+    while (k_ < n_) {                              \
+      size_t c_ = k_ < n_ - k_ ? k_ : n_ - k_;     \
+      memcpy(&d_[k_], d_, c_);                     \
+      k_ += c_;                                    \
+    }                                              \
+  }
+
+/** pads *s with fill to reach width (see str_cpadf); need / div units go to
+ *  the left, none if div is 0; returns from the calling function on failure */
+#define STR_DETAIL_PAD(s, width, fill, mode, div)                    \
+  {                                                                  \
+    size_t slen_ = str_len(*(s));                                    \
+    size_t flen_ = strlen(fill);                                     \
+    size_t cur_  = slen_;                                            \
+    size_t fu_   = flen_;                                            \
+    size_t need_;                                                    \
+    size_t lu_;                                                      \
+    size_t lb_;                                                      \
+    size_t rb_;                                                      \
+    size_t i_;                                                       \
+    if ((mode) == STR_PAD_CODEPOINTS) {                              \
+      cur_ = str_utf8_len(*(s));                                     \
+      for (i_ = 0, fu_ = 0; i_ < flen_; ++i_)                        \
+        fu_ += ((fill)[i_] & 0xC0) != 0x80;                          \
+    }                                                                \
+    if (cur_ >= (width) || fu_ == 0)                                 \
+      return;                                                        \
+    need_ = (width) - cur_;                                          \
+    lu_   = (div) == 0 ? 0 : need_ / (div);                          \
+    STR_DETAIL_PAD_BYTES(fill, flen_, fu_, mode, lu_, lb_);          \
+    STR_DETAIL_PAD_BYTES(fill, flen_, fu_, mode, need_ - lu_, rb_);  \
+    STR_DETAIL_INNER(str_fit(s, slen_ + lb_ + rb_));                 \
+    if (str_cap(*(s)) < slen_ + lb_ + rb_ || STR_DETAIL_IS_RO(*(s))) \
+      return;                                                        \
+    if (lb_ > 0) {                                                   \
+      memmove(&(*(s))[lb_], *(s), slen_);                            \
+      STR_DETAIL_STATS_ADD(bytes_shifted, slen_);                    \
+    }                                                                \
+    STR_DETAIL_PATTERN_FILL(*(s), lb_, fill, flen_);                 \
+    STR_DETAIL_PATTERN_FILL(&(*(s))[lb_ + slen_], rb_, fill, flen_); \
+    (*(s))[slen_ + lb_ + rb_] = '\0';                                \
+    STR_DETAIL_SET_LEN(*(s), slen_ + lb_ + rb_);                     \
+  }
+
+/** value of a hex digit, or 16 if c is not one */
+#define STR_DETAIL_HEX_VAL(c)                                          \
+  ((unsigned char)((c) - '0') < 10 ? (c) - '0'                         \
+   : (unsigned char)(((c) | 0x20) - 'a') < 6 ? ((c) | 0x20) - 'a' + 10 \
+                                             : 16)
+
+/** cp = value of the 4 hex digits at p, or 0x10000 if any is invalid */
+#define STR_DETAIL_HEX4(p, cp)                                            \
+  {                                                                       \
+    unsigned a_ = STR_DETAIL_HEX_VAL((p)[0]);                             \
+    unsigned b_ = STR_DETAIL_HEX_VAL((p)[1]);                             \
+    unsigned c_ = STR_DETAIL_HEX_VAL((p)[2]);                             \
+    unsigned d_ = STR_DETAIL_HEX_VAL((p)[3]);                             \
+    (cp) = (a_ | b_ | c_ | d_) > 15 ? 0x10000UL                           \
+                                    : (unsigned long)a_ << 12 | b_ << 8 | \
+                                          c_ << 4 | d_;                   \
+  }
+
+/** true if c must be escaped in a json string [branch-free] */
+#define STR_DETAIL_JSON_ESC(c) \
+  (((c) < 0x20) | ((c) == '"') | ((c) == '\\'))
+
+/** true if c requires a csv field to be quoted [branch-free] */
+#define STR_DETAIL_CSV_ESC(c) \
+  (((c) == '"') | ((c) == ',') | ((c) == '\n') | ((c) == '\r'))
+
+/** true if c is not an unreserved uri char [RFC 3986 2.3; branch-free]
+ *  written as range tests so that it vectorizes */
+#define STR_DETAIL_URL_ESC(c)                                 \
+  (((c) < '-') | ((c) == '/') | (((c) > '9') & ((c) < 'A')) | \
+   (((c) > 'Z') & ((c) < 'a') & ((c) != '_')) | (((c) > 'z') & ((c) != '~')))
+
+/** digits read per word by the numeric parsers [8 if size_t has 64 bits] */
+#define STR_DETAIL_SWAR_DIGITS (sizeof(size_t) >= 8 ? 8 : 4)
+
+/** repeats the byte b across a size_t */
+#define STR_DETAIL_BYTES(b) (~(size_t)0 / 0xFF * (b))
+
+/** w = the STR_DETAIL_SWAR_DIGITS chars at p, the first in the low byte */
+#define STR_DETAIL_LOAD_DIGITS(p, w)           \
+  {                                            \
+    size_t k_ = STR_DETAIL_SWAR_DIGITS;        \
+    (w)       = 0;                             \
+    while (k_-- > 0)                           \
+      (w) = (w) << 8 | (unsigned char)(p)[k_]; \
+  }
+
+/** true if every byte of w is an ASCII digit */
+#define STR_DETAIL_ALL_DIGITS(w)                                       \
+  ((((w) & STR_DETAIL_BYTES(0xF0)) |                                   \
+    (((w) + STR_DETAIL_BYTES(0x06)) & STR_DETAIL_BYTES(0xF0)) >> 4) == \
+   STR_DETAIL_BYTES(0x33))
+
+/** w = value of the digits loaded into w [every byte must be a digit];
+ *  adjacent lanes are combined in log2(STR_DETAIL_SWAR_DIGITS) multiplies */
+#define STR_DETAIL_DIGITS_VALUE(w)                                          \
+  {                                                                         \
+    (w) -= STR_DETAIL_BYTES(0x30);                                          \
+    (w) = ((w) * 10 + ((w) >> 8)) & (~(size_t)0 / 0xFFFF * 0xFF);           \
+    (w) = ((w) * 100 + ((w) >> 16)) & (~(size_t)0 / 0xFFFFFFFFUL * 0xFFFF); \
+    if (STR_DETAIL_SWAR_DIGITS == 8)                                        \
+      (w) = ((w) * 10000 + ((w) >> 16 >> 16)) & 0xFFFFFFFFUL;               \
+  }
+
+/** i = index past the run of digits at s[i] [a word at a time] */
+#define STR_DETAIL_SKIP_DIGITS(s, n, i)                     \
+  {                                                         \
+    size_t w_;                                              \
+    while ((n) - (i) >= STR_DETAIL_SWAR_DIGITS) {           \
+      STR_DETAIL_LOAD_DIGITS(&(s)[i], w_);                  \
+      if (!STR_DETAIL_ALL_DIGITS(w_))                       \
+        break;                                              \
+      (i) += STR_DETAIL_SWAR_DIGITS;                        \
+    }                                                       \
+    while ((i) < (n) && (unsigned char)((s)[i] - '0') < 10) \
+      ++(i);                                                \
+  }
+
+/** m = m * 10^len + value of the len digits at p [exact while m < 2^53] */
+#define STR_DETAIL_ACC_DIGITS(p, len, m)                                  \
+  {                                                                       \
+    const char *p_ = (p);                                                 \
+    size_t      l_ = (len);                                               \
+    size_t      w_;                                                       \
+    for (; l_ >= STR_DETAIL_SWAR_DIGITS; l_ -= STR_DETAIL_SWAR_DIGITS) {  \
+      STR_DETAIL_LOAD_DIGITS(p_, w_);                                     \
+      STR_DETAIL_DIGITS_VALUE(w_);                                        \
+      (m) = (m) * (STR_DETAIL_SWAR_DIGITS == 8 ? 1e8 : 1e4) + (double)w_; \
+      p_ += STR_DETAIL_SWAR_DIGITS;                                       \
+    }                                                                     \
+    for (; l_ > 0; --l_)                                                  \
+      (m) = (m) * 10 + (*p_++ - '0');                                     \
+  }
+
+/** true if double operations are rounded to double precision, which makes
+ *  the exact fast path of str_to_double correctly rounded */
+#if defined(FLT_EVAL_METHOD)
+#  define STR_DETAIL_EXACT_DOUBLE (FLT_EVAL_METHOD == 0 || FLT_EVAL_METHOD == 1)
+#elif defined(__FLT_EVAL_METHOD__)
+#  define STR_DETAIL_EXACT_DOUBLE \
+    (__FLT_EVAL_METHOD__ == 0 || __FLT_EVAL_METHOD__ == 1)
+#else
+#  define STR_DETAIL_EXACT_DOUBLE 0
+#endif
+
+/** copies a read-only str to an owned block [returns on allocation failure] */
+#define STR_DETAIL_OWN(s)                          \
+  if (STR_DETAIL_IS_RO(*(s))) {                    \
+    STR_DETAIL_INNER(str_realloc(s, str_cap(*s))); \
+    if (STR_DETAIL_IS_RO(*(s)))                    \
+      return;                                      \
+  }
+
+/** identifies the string table format [word size and byte order specific] */
+#define STR_DETAIL_TABLE_MAGIC (((size_t)0x73747262 << 8) | sizeof(size_t))
+
+/** size of a table entry with len chars [aligned to the word size] */
+#define STR_DETAIL_TABLE_ENTRY_SIZE(len)                                 \
+  ((STR_DETAIL_MEMORY_SIZE(len) + sizeof(size_t) - 1) / sizeof(size_t) * \
+   sizeof(size_t))
+
+/** maximum number of iovecs passed to a single writev call */
+#if defined IOV_MAX && IOV_MAX < 1024
+#  define STR_DETAIL_IOV_MAX IOV_MAX
+#else
+#  define STR_DETAIL_IOV_MAX 1024
+#endif
+
+/** copies n chars into the reserved segments of a str_builder */
+#define STR_DETAIL_BUILDER_COPY(b, src, n)    \
+  {                                           \
+    const char *p_ = (src);                   \
+    size_t      n_ = (n);                     \
+    while (n_ > 0) {                          \
+      str    seg_  = (b)->segs[(b)->cur];     \
+      size_t len_  = str_len(seg_);           \
+      size_t room_ = str_cap(seg_) - len_;    \
+      if (room_ == 0) {                       \
+        ++(b)->cur;                           \
+        continue;                             \
+      }                                       \
+      if (room_ > n_)                         \
+        room_ = n_;                           \
+      memcpy(&seg_[len_], p_, room_);         \
+      seg_[len_ + room_] = '\0';              \
+      STR_DETAIL_SET_LEN(seg_, len_ + room_); \
+      p_ += room_;                            \
+      n_ -= room_;                            \
+    }                                         \
+    (b)->len += (n);                          \
+    (b)->avail -= (n);                        \
+  }
+
+/** makes room for nchars more chars and nelems more elements in a str_vec
+ *  [geometric growth]; returns from the calling function on failure */
+#define STR_DETAIL_VEC_RESERVE(v, nchars, nelems)                        \
+  {                                                                      \
+    size_t len_ = (v)->data == NULL ? 0 : str_len((v)->data);            \
+    if ((v)->data == NULL || str_cap((v)->data) - len_ < (nchars)) {     \
+      size_t cap_ = (v)->data == NULL ? 0 : str_cap((v)->data) * 2;      \
+      if (cap_ < len_ + (nchars))                                        \
+        cap_ = len_ + (nchars);                                          \
+      if ((v)->data == NULL)                                             \
+        STR_DETAIL_INNER((v)->data = str_alloc(cap_));                   \
+      else                                                               \
+        STR_DETAIL_INNER(str_realloc(&(v)->data, cap_));                 \
+      if ((v)->data == NULL || str_cap((v)->data) != cap_)               \
+        return;                                                          \
+    }                                                                    \
+    if ((v)->ocap - (v)->n < (nelems)) {                                 \
+      size_t  ocap_ = (v)->ocap * 2;                                     \
+      size_t *offs_;                                                     \
+      if (ocap_ < (v)->n + (nelems))                                     \
+        ocap_ = (v)->n + (nelems);                                       \
+      offs_ = (size_t *)STR_DETAIL_MALLOC(sizeof(size_t) * (ocap_ + 1)); \
+      if (offs_ == NULL)                                                 \
+        return;                                                          \
+      if ((v)->offs == NULL)                                             \
+        offs_[0] = 0;                                                    \
+      else {                                                             \
+        memcpy(offs_, (v)->offs, sizeof(size_t) * ((v)->n + 1));         \
+        STR_DETAIL_FREE((v)->offs);                                      \
+      }                                                                  \
+      (v)->offs = offs_;                                                 \
+      (v)->ocap = ocap_;                                                 \
+    }                                                                    \
+  }
+
+/** sort key of s at depth d [0 past the end, so shorter strs sort first] */
+#define STR_DETAIL_SORT_KEY(s, d) \
+  ((d) < str_len(s) ? (int)(unsigned char)(s)[d] + 1 : 0)
+
+/** ranges of at most this many strs are insertion sorted */
+#define STR_DETAIL_SORT_MIN 16
+
+/** capacity of the str_sort range stack [in ranges]
+ *  str_sort continues with the smallest of three parts (at most a third of
+ *  the range) and pushes the other two, of which the one popped first is at
+ *  most half of the range; fewer than two ranges are pending per halving */
+#define STR_DETAIL_SORT_STACK (2 * sizeof(size_t) * CHAR_BIT)
+
+/** swaps two strs */
+#define STR_DETAIL_SORT_SWAP(a, b) \
+  {                                \
+    str t_ = (a);                  \
+    (a)    = (b);                  \
+    (b)    = t_;                   \
+  }
+
+/** widens the gap of an editing session to at least n [geometric growth];
+ *  returns from the calling function if the allocation fails */
+#define STR_DETAIL_EDIT_RESERVE(e, n)                                      \
+  if ((e)->end - (e)->gap < (n)) {                                         \
+    size_t oldcap_ = str_cap(*(e)->s);                                     \
+    size_t suflen_ = oldcap_ - (e)->end;                                   \
+    size_t newcap_ = (e)->gap + suflen_ + (n);                             \
+    if (newcap_ < oldcap_ * 2)                                             \
+      newcap_ = oldcap_ * 2;                                               \
+    STR_DETAIL_INNER(str_realloc((e)->s, newcap_));                        \
+    if (str_cap(*(e)->s) != newcap_)                                       \
+      return;                                                              \
+    memmove(&(*(e)->s)[newcap_ - suflen_], &(*(e)->s)[(e)->end], suflen_); \
+    STR_DETAIL_STATS_ADD(bytes_shifted, suflen_);                          \
+    (e)->end = newcap_ - suflen_;                                          \
+  }
+
 /*.----------------------------------------------------------------------------,
  /                                 type alias                                */
 
 typedef char *str;
 
+/** width modes of the fill padding functions [see str_cpadf] */
+#define STR_PAD_BYTES      0 /* width and fill are measured in bytes */
+#define STR_PAD_CODEPOINTS 1 /* width and fill are measured in codepoints */
+
+/** alphabets of the base64 functions [see str_append_base64] */
+#define STR_BASE64_STD 0 /* A-Z a-z 0-9 + / with = padding [RFC 4648 4] */
+#define STR_BASE64_URL 1 /* A-Z a-z 0-9 - _ without padding [RFC 4648 5] */
+
+/** declares name, a static str that refers to a read-only block holding the
+ *  string literal lit [no alloc; no strlen; usable at file or block scope]
+ *  the block is a const static object [cap, len, chars, \0] whose length
+ *  is sizeof(lit) - 1; manipulators copy it first and str_free only
+ *  nullifies the pointer. example: STR_LIT(greeting, "hello"); */
+#define STR_LIT(name, lit)                                           \
+  static const struct {                                              \
+    size_t cap;                                                      \
+    size_t len;                                                      \
+    char   chars[sizeof("" lit)];                                    \
+  } name##_str_lit_ = {(sizeof("" lit) - 1) | ~(~(size_t)0 >> 1),    \
+                       sizeof("" lit) - 1, "" lit};                  \
+  static str name = (str)name##_str_lit_.chars
+
+/** gap-buffer editing session over a str [see str_edit_begin]
+ *  layout: | prefix [0, gap) | gap [gap, end) | suffix [end, cap) | */
+typedef struct {
+  str   *s;   /* edited string; its len and terminator are stale until commit */
+  size_t gap; /* cursor; length of the prefix */
+  size_t end; /* index of the first suffix char */
+} str_edit;
+
+/** segmented string builder [see str_builder_init]
+ *  appended chars are copied once into a chain of str segments; growth
+ *  allocates a new segment instead of moving the existing ones */
+typedef struct {
+  str   *segs;  /* segments; segs[cur + 1..nsegs) are reserved and empty */
+  size_t nsegs; /* number of allocated segments */
+  size_t scap;  /* capacity of segs */
+  size_t cur;   /* index of the segment being filled */
+  size_t len;   /* total length */
+  size_t avail; /* unused capacity of segs[cur..nsegs) */
+} str_builder;
+
+/** compact string vector [see str_vec_init]
+ *  all elements share one str; each is followed by a null terminator
+ *  layout: | element 0 | \0 | element 1 | \0 | ... | element n - 1 | \0 |
+ *  offs[i] locates element i in data; offs[n] is the length of data */
+typedef struct {
+  str     data; /* elements; NULL until the first push */
+  size_t *offs; /* n + 1 offsets; NULL until the first push */
+  size_t  n;    /* number of elements */
+  size_t  ocap; /* number of offsets that fit in offs, minus the sentinel */
+} str_vec;
+
+/** buffered line reader over a FILE * or a file descriptor
+ *  [see str_reader_init]; the buffer grows to hold the longest line */
+typedef struct {
+  str    buf;  /* buffered chars; allocated by the first read */
+  size_t pos;  /* first unread char of buf */
+  size_t scan; /* first char of buf not yet searched for a newline */
+  FILE  *fp;   /* source; NULL if reading from fd */
+  int    fd;
+  int    eof;  /* nonzero after the source reported end of file */
+} str_reader;
+
+/** memory-mapped string table [see str_table_open]
+ *  file layout [native word size and byte order]:
+ *  | magic | n | offset of entry 0 | ... | offset of entry n - 1 |
+ *  | entry 0 | ... | entry n - 1 |
+ *  each entry is a read-only str block [cap, len, chars, \0] aligned to the
+ *  word size; each offset locates the chars of its entry */
+typedef struct {
+  void  *map;   /* mapped file */
+  size_t msize; /* size of the mapping */
+  size_t n;     /* number of entries */
+} str_table;
+
+#if defined STR_CONFIG_STATS || defined STR_CONFIG_TRACE
+/** API functions that statistics and traces are attributed to
+ *  str_alloc_aligned, str_cpad, str_lpad, str_rpad and str_to_double_ count
+ *  as the function they call; functions that never allocate, move, or
+ *  resize are omitted */
+enum {
+  STR_STATS_ALLOC,
+  STR_STATS_DUP,
+  STR_STATS_NEW,
+  STR_STATS_SUB,
+  STR_STATS_APPEND_BASE64,
+  STR_STATS_APPEND_CSV_FIELD,
+  STR_STATS_APPEND_HEX,
+  STR_STATS_APPEND_JSON_ESCAPED,
+  STR_STATS_APPEND_UNBASE64,
+  STR_STATS_APPEND_UNCSV,
+  STR_STATS_APPEND_UNHEX,
+  STR_STATS_APPEND_UNJSON,
+  STR_STATS_APPEND_UNURL,
+  STR_STATS_APPEND_URL_ENCODED,
+  STR_STATS_TO_DOUBLE,
+  STR_STATS_APPEND,
+  STR_STATS_APPEND_,
+  STR_STATS_APPEND_N,
+  STR_STATS_PREPEND,
+  STR_STATS_PREPEND_,
+  STR_STATS_EMPLACE,
+  STR_STATS_EMPLACE_,
+  STR_STATS_ERASE,
+  STR_STATS_INSERT,
+  STR_STATS_INSERT_,
+  STR_STATS_SPLICE,
+  STR_STATS_SUBSTR,
+  STR_STATS_CPYLOWER,
+  STR_STATS_CPYLOWER_,
+  STR_STATS_CPYUPPER,
+  STR_STATS_CPYUPPER_,
+  STR_STATS_TOLOWER,
+  STR_STATS_TOUPPER,
+  STR_STATS_CPADF,
+  STR_STATS_LPADF,
+  STR_STATS_RPADF,
+  STR_STATS_TRIM,
+  STR_STATS_CLEAR,
+  STR_STATS_FIT,
+  STR_STATS_GROW,
+  STR_STATS_REALLOC,
+  STR_STATS_SHRINK,
+  STR_STATS_SHRINKFIT,
+  STR_STATS_EDIT_BEGIN,
+  STR_STATS_EDIT_COMMIT,
+  STR_STATS_EDIT_INSERT,
+  STR_STATS_EDIT_INSERT_,
+  STR_STATS_EDIT_SEEK,
+  STR_STATS_BUILDER_APPEND,
+  STR_STATS_BUILDER_APPEND_,
+  STR_STATS_BUILDER_FINISH,
+  STR_STATS_BUILDER_FREE,
+  STR_STATS_BUILDER_RESERVE,
+  STR_STATS_VEC_FREE,
+  STR_STATS_VEC_GET_STR,
+  STR_STATS_VEC_POP,
+  STR_STATS_VEC_PUSH,
+  STR_STATS_VEC_PUSH_,
+  STR_STATS_VEC_SPLIT,
+  STR_STATS_GETLINE,
+  STR_STATS_GETLINE_VIEW,
+  STR_STATS_READER_FREE,
+  STR_STATS_READ_FILE,
+  STR_STATS_READ_FILES,
+  STR_STATS_FREE,
+  STR_STATS_FNS /* number of functions */
+};
+
+/* the function that events are attributed to, and the depth of library
+ * calls made by the library itself */
+static STR_DETAIL_THREAD_LOCAL int str_detail_stats_fn;
+static STR_DETAIL_THREAD_LOCAL int str_detail_stats_nest;
+#endif
+
+#ifdef STR_CONFIG_STATS
+/** counters of one API function [see str_stats] */
+typedef struct {
+  size_t    allocs;          /* allocator calls */
+  size_t    frees;           /* deallocator calls */
+  size_t    reallocs;        /* str_realloc calls [each allocates and frees] */
+  size_t    bytes_allocated; /* requested from the allocator */
+  size_t    bytes_copied;    /* copied to a new block by str_realloc */
+  size_t    bytes_shifted;   /* moved within a str to open or close a gap */
+  ptrdiff_t slack;           /* change of the unused capacity of owned strs */
+} str_stats_entry;
+
+/** allocation and copy statistics by API function [see str_stats_get]
+ *  fn is indexed by STR_STATS_*; the slack of a function is a change since
+ *  the last str_stats_reset. live_slack is the unused capacity of the owned
+ *  strs this thread has allocated, resized, or freed since it started; it is
+ *  not zeroed by str_stats_reset. a str freed by another thread than the one
+ *  that grew it moves slack between threads [sum their snapshots] */
+typedef struct {
+  str_stats_entry fn[STR_STATS_FNS];
+  ptrdiff_t       live_slack;
+} str_stats;
+
+/* the counters of the calling thread */
+static STR_DETAIL_THREAD_LOCAL str_stats str_detail_stats;
+
+/* see STR_DETAIL_STATS_SLACK */
+STR_FUNCTION void
+str_detail_stats_slack(ptrdiff_t n) {
+  str_detail_stats.fn[str_detail_stats_fn].slack += n;
+  str_detail_stats.live_slack += n;
+}
+#endif
+
+#ifdef STR_CONFIG_TRACE
+/** a recorded block event [see str_trace_start]
+ *  blocks are identified by address: id 0 -> to creates block to, id -> 0
+ *  frees block id, id -> to moves block id to a new block [the old block is
+ *  then freed], and id -> id sets the len of block id. a mapped block that
+ *  is remapped [see STR_CONFIG_MMAP_THRESHOLD] is freed, then created */
+typedef struct {
+  int    fn;  /* STR_STATS_* of the API function that was called */
+  size_t id;  /* block address before the event [0 if created] */
+  size_t to;  /* block address after the event [0 if freed] */
+  size_t cap; /* capacity after the event [before if freed] */
+  size_t len; /* length after the event [before if freed] */
+} str_trace_record;
+
+/* the trace file of the calling thread and its pending records */
+static STR_DETAIL_THREAD_LOCAL FILE  *str_detail_trace_fp;
+static STR_DETAIL_THREAD_LOCAL size_t str_detail_trace_n;
+static STR_DETAIL_THREAD_LOCAL unsigned char
+    str_detail_trace_buf[STR_CONFIG_TRACE_BUFFER];
+
+/* encodes a record [defined with the trace functions] */
+STR_FUNCTION void
+str_detail_trace(const char *id, const char *to, size_t cap, size_t len);
+#endif
+
 /*.----------------------------------------------------------------------------,
  /                                declarations                               */
 
@@ -228,6 +1457,12 @@ typedef char *str;
 /** create a str with capacity cap */
 STR_FUNCTION str
 str_alloc(size_t cap);
+#ifdef STR_CONFIG_ALIGN
+/** create a str whose chars and terminator fill whole aligned blocks
+ *  [capacity: cap rounded up to a multiple of STR_CONFIG_ALIGN, less one] */
+STR_FUNCTION str
+str_alloc_aligned(size_t cap);
+#endif
 /** duplicate str storage (alloc) */
 STR_FUNCTION str
 str_dup(const str s);
@@ -249,6 +1484,12 @@ str_cap(const str s);
 /** pointer to the null terminator */
 STR_FUNCTION char *
 str_end(const str s);
+/** true if no ASCII uppercase */
+STR_FUNCTION int
+str_islower(const str s);
+/** true if no ASCII lowercase */
+STR_FUNCTION int
+str_isupper(const str s);
 /** retrieve the length */
 STR_FUNCTION size_t
 str_len(const str s);
@@ -265,6 +1506,108 @@ str_msize(const str s);
 STR_FUNCTION str
 str_mstr(void *m);
 
+/*                                 comparison                                 */
+
+/** order ignoring ASCII case */
+STR_FUNCTION int
+str_casecmp(const str a, const char *b);
+/** order ignoring ASCII case */
+STR_FUNCTION int
+str_casecmp_(const str a, const str b);
+/** true if equal ignoring ASCII case */
+STR_FUNCTION int
+str_caseeq(const str a, const char *b);
+/** true if equal ignoring ASCII case */
+STR_FUNCTION int
+str_caseeq_(const str a, const str b);
+/** order by bytes, then length */
+STR_FUNCTION int
+str_cmp(const str a, const char *b);
+/** order by bytes, then length */
+STR_FUNCTION int
+str_cmp_(const str a, const str b);
+/** true if s ends with suffix */
+STR_FUNCTION int
+str_ends_with(const str s, const char *suffix);
+/** true if s ends with suffix */
+STR_FUNCTION int
+str_ends_with_(const str s, const str suffix);
+/** true if equal [lengths first] */
+STR_FUNCTION int
+str_eq(const str a, const char *b);
+/** true if equal [lengths first] */
+STR_FUNCTION int
+str_eq_(const str a, const str b);
+/** true if s begins with prefix */
+STR_FUNCTION int
+str_starts_with(const str s, const char *prefix);
+/** true if s begins with prefix */
+STR_FUNCTION int
+str_starts_with_(const str s, const str prefix);
+
+/*                                  unicode                                   */
+
+/** number of codepoints */
+STR_FUNCTION size_t
+str_utf8_len(const str s);
+/** true if s is valid utf-8 [cached if configured] */
+STR_FUNCTION int
+str_utf8_valid(const str s);
+
+/*                                  encoding                                  */
+
+/** append data in base64 [exact size, <= 1 alloc] */
+STR_FUNCTION void
+str_append_base64(str *s, const void *data, size_t n, int mode);
+/** append as a csv field [quoted if needed, <= 1 alloc] */
+STR_FUNCTION void
+str_append_csv_field(str *s, const char *src, size_t n);
+/** append data in lowercase hex [exact size, <= 1 alloc] */
+STR_FUNCTION void
+str_append_hex(str *s, const void *data, size_t n);
+/** append as json string chars [exact size, <= 1 alloc] */
+STR_FUNCTION void
+str_append_json_escaped(str *s, const char *src, size_t n);
+/** append decoded base64 [-1 and *bad on failure] */
+STR_FUNCTION int
+str_append_unbase64(str *s, const char *src, size_t n, int mode, size_t *bad);
+/** append an unquoted csv field [-1 and *bad on failure] */
+STR_FUNCTION int
+str_append_uncsv(str *s, const char *src, size_t n, size_t *bad);
+/** append decoded hex [-1 and *bad on failure] */
+STR_FUNCTION int
+str_append_unhex(str *s, const char *src, size_t n, size_t *bad);
+/** append unescaped json chars [-1 and *bad on failure] */
+STR_FUNCTION int
+str_append_unjson(str *s, const char *src, size_t n, size_t *bad);
+/** append percent-decoded chars [-1 and *bad on failure] */
+STR_FUNCTION int
+str_append_unurl(str *s, const char *src, size_t n, size_t *bad);
+/** append percent-encoded chars [exact size, <= 1 alloc] */
+STR_FUNCTION void
+str_append_url_encoded(str *s, const char *src, size_t n);
+
+/*                                 conversion                                 */
+
+/** parse a decimal double [locale-independent, rounded] */
+STR_FUNCTION int
+str_to_double(const char *s, size_t n, double *out, size_t *used);
+/** parse a decimal double [locale-independent, rounded] */
+STR_FUNCTION int
+str_to_double_(const str s, double *out, size_t *used);
+/** parse a decimal long [1 and saturated on overflow] */
+STR_FUNCTION int
+str_to_long(const char *s, size_t n, long *out, size_t *used);
+/** parse a decimal long [1 and saturated on overflow] */
+STR_FUNCTION int
+str_to_long_(const str s, long *out, size_t *used);
+/** parse a decimal unsigned long [1 and saturated on overflow] */
+STR_FUNCTION int
+str_to_ulong(const char *s, size_t n, unsigned long *out, size_t *used);
+/** parse a decimal unsigned long [1 and saturated on overflow] */
+STR_FUNCTION int
+str_to_ulong_(const str s, unsigned long *out, size_t *used);
+
 /*                                manipulation                                */
 
 /** append chars to a */
@@ -273,6 +1616,9 @@ str_append(str *a, const char *b);
 /** append str to a */
 STR_FUNCTION void
 str_append_(str *a, const str b);
+/** append n chars of b */
+STR_FUNCTION void
+str_append_n(str *a, const char *b, size_t n);
 /** prepend chars to b */
 STR_FUNCTION void
 str_prepend(str *b, const char *a);
@@ -286,22 +1632,59 @@ str_emplace(str *a, const char *b, size_t idx);
 /** overwrite chars in a string */
 STR_FUNCTION void
 str_emplace_(str *a, const str b, size_t idx);
+/** remove n chars at s[idx] [no alloc] */
+STR_FUNCTION void
+str_erase(str *s, size_t idx, size_t n);
 /** insert chars before s[idx] */
 STR_FUNCTION void
 str_insert(str *s, const char *ins, size_t idx);
 /** insert str before s[idx] */
 STR_FUNCTION void
 str_insert_(str *s, const str ins, size_t idx);
+/** replace n chars at s[idx] with inslen chars of ins [<= 1 alloc] */
+STR_FUNCTION void
+str_splice(str *s, size_t idx, size_t n, const char *ins, size_t inslen);
+/** keep only the n chars at s[idx] [no alloc] */
+STR_FUNCTION void
+str_substr(str *s, size_t idx, size_t n);
+
+/** copy src in ASCII lowercase [<= 1 alloc] */
+STR_FUNCTION void
+str_cpylower(str *dst, const char *src);
+/** copy src in ASCII lowercase [<= 1 alloc] */
+STR_FUNCTION void
+str_cpylower_(str *dst, const str src);
+/** copy src in ASCII uppercase [<= 1 alloc] */
+STR_FUNCTION void
+str_cpyupper(str *dst, const char *src);
+/** copy src in ASCII uppercase [<= 1 alloc] */
+STR_FUNCTION void
+str_cpyupper_(str *dst, const str src);
+/** ASCII lowercase in place [no write if unchanged] */
+STR_FUNCTION void
+str_tolower(str *s);
+/** ASCII uppercase in place [no write if unchanged] */
+STR_FUNCTION void
+str_toupper(str *s);
 
 /** center pad to reach len */
 STR_FUNCTION void
 str_cpad(str *s, size_t len);
+/** center pad with a fill pattern to reach width [<= 1 alloc, 1 move] */
+STR_FUNCTION void
+str_cpadf(str *s, size_t width, const char *fill, int mode);
 /** left pad to reach len */
 STR_FUNCTION void
 str_lpad(str *s, size_t len);
+/** left pad with a fill pattern to reach width [<= 1 alloc, 1 move] */
+STR_FUNCTION void
+str_lpadf(str *s, size_t width, const char *fill, int mode);
 /** right pad to reach len */
 STR_FUNCTION void
 str_rpad(str *s, size_t len);
+/** right pad with a fill pattern to reach width [<= 1 alloc, no move] */
+STR_FUNCTION void
+str_rpadf(str *s, size_t width, const char *fill, int mode);
 /** trim leading and trailing whitespace */
 STR_FUNCTION void
 str_trim(str *s);
@@ -325,47 +1708,287 @@ str_shrink(str *a, size_t delta);
 STR_FUNCTION void
 str_shrinkfit(str *s);
 
-/*                                destruction                                 */
+/*                                  editing                                   */
 
-/** free owned string, nullify ptr */
+/** open a gap at s[idx] */
 STR_FUNCTION void
-str_free(str *s);
-
-/*.----------------------------------------------------------------------------,
- /                                definitions                                */
+str_edit_begin(str_edit *e, str *s, size_t idx);
+/** close the gap, set len, term */
+STR_FUNCTION void
+str_edit_commit(str_edit *e);
+/** remove n chars after cursor */
+STR_FUNCTION void
+str_edit_erase(str_edit *e, size_t n);
+/** insert chars at cursor */
+STR_FUNCTION void
+str_edit_insert(str_edit *e, const char *ins);
+/** insert str at cursor */
+STR_FUNCTION void
+str_edit_insert_(str_edit *e, const str ins);
+/** length of the edited text */
+STR_FUNCTION size_t
+str_edit_len(const str_edit *e);
+/** move the cursor to idx */
+STR_FUNCTION void
+str_edit_seek(str_edit *e, size_t idx);
 
-/*                                construction                                */
+/*                                  building                                  */
 
-/** create a str with capacity cap */
+/** append chars [no copy on growth] */
+STR_FUNCTION void
+str_builder_append(str_builder *b, const char *s);
+/** append str [no copy on growth] */
+STR_FUNCTION void
+str_builder_append_(str_builder *b, const str s);
+/** join segments (alloc, 1 copy) */
 STR_FUNCTION str
-str_alloc(size_t cap) {
-  void *o = STR_CONFIG_MALLOC(STR_DETAIL_MEMORY_SIZE(cap));
-  if (o == NULL)
-    return NULL;
-  str s = str_mstr(o);
-  STR_DETAIL_SET_CAP(s, cap);
-  STR_DETAIL_SET_LEN(s, 0);
-  s[0] = '\0';
-  return s;
-}
+str_builder_finish(str_builder *b);
+/** free segments, reset */
+STR_FUNCTION void
+str_builder_free(str_builder *b);
+/** empty builder [no alloc] */
+STR_FUNCTION void
+str_builder_init(str_builder *b);
+/** total appended length */
+STR_FUNCTION size_t
+str_builder_len(const str_builder *b);
+/** room for n chars [<= 2 allocs] */
+STR_FUNCTION void
+str_builder_reserve(str_builder *b, size_t n);
+#ifdef STR_CONFIG_POSIX
+/** write segments to fd */
+STR_FUNCTION int
+str_builder_writev(const str_builder *b, int fd);
+#endif
 
-/** duplicate str storage (alloc) */
-STR_FUNCTION str
-str_dup(const str s) {
-  void *o = STR_CONFIG_MALLOC(str_msize(s));
-  if (o == NULL)
-    return NULL;
-  memcpy(o, str_mbegin(s), str_msize(s));
-  return str_mstr(o);
-}
+/*                                  vectors                                   */
 
-/** record length, allocate, copy */
+/** free the elements, reset */
+STR_FUNCTION void
+str_vec_free(str_vec *v);
+/** element i and its length [no copy] */
+STR_FUNCTION char *
+str_vec_get(const str_vec *v, size_t i, size_t *len);
+/** copy of element i (alloc) */
 STR_FUNCTION str
-str_new(const char *s) {
-  size_t len = strlen(s);
-  str v      = str_alloc(len);
-  if (v == NULL)
-    return NULL;
+str_vec_get_str(const str_vec *v, size_t i);
+/** empty vector [no alloc] */
+STR_FUNCTION void
+str_vec_init(str_vec *v);
+/** number of elements */
+STR_FUNCTION size_t
+str_vec_len(const str_vec *v);
+/** remove the last element */
+STR_FUNCTION void
+str_vec_pop(str_vec *v);
+/** append an element [amortized O(1), no per-element alloc] */
+STR_FUNCTION void
+str_vec_push(str_vec *v, const char *s);
+/** append an element [amortized O(1), no per-element alloc] */
+STR_FUNCTION void
+str_vec_push_(str_vec *v, const str s);
+/** append the fields of buf [1 copy] */
+STR_FUNCTION void
+str_vec_split(str_vec *v, const char *buf, size_t len, char delim);
+
+/*                                  sorting                                   */
+
+/** sort by bytes, then by length [no alloc, no strcmp] */
+STR_FUNCTION void
+str_sort(str *arr, size_t n);
+
+/*                                  reading                                   */
+
+/** read a line into *line [reuses its capacity] */
+STR_FUNCTION int
+str_getline(str_reader *r, str *line);
+/** read a line in place [no copy] */
+STR_FUNCTION int
+str_getline_view(str_reader *r, const char **line, size_t *len);
+/** free the buffer, reset */
+STR_FUNCTION void
+str_reader_free(str_reader *r);
+/** read lines from fp [no alloc] */
+STR_FUNCTION void
+str_reader_init(str_reader *r, FILE *fp);
+#ifdef STR_CONFIG_POSIX
+/** read lines from fd [no alloc] */
+STR_FUNCTION void
+str_reader_initfd(str_reader *r, int fd);
+#endif
+
+/*                                   files                                    */
+
+#ifdef STR_CONFIG_POSIX
+/** load a file (1 alloc) */
+STR_FUNCTION str
+str_read_file(const char *path);
+/** load n files into out [batched with STR_CONFIG_IO_URING] */
+STR_FUNCTION size_t
+str_read_files(const char *const *paths, size_t n, str *out);
+/** send a file to fd [no copy on linux] */
+STR_FUNCTION int
+str_sendfile(int fd, const char *path);
+/** store s */
+STR_FUNCTION int
+str_write_file(const char *path, const str s);
+/** write n strs to fd [no concatenation] */
+STR_FUNCTION int
+str_writev(int fd, const str *parts, size_t n);
+
+/** unmap the table */
+STR_FUNCTION void
+str_table_close(str_table *t);
+/** read-only str at index i [null if out of bounds or bad] */
+STR_FUNCTION str
+str_table_get(const str_table *t, size_t i);
+/** map a table file */
+STR_FUNCTION int
+str_table_open(str_table *t, const char *path);
+#endif
+/** store n strs as a table */
+STR_FUNCTION int
+str_table_write(const char *path, const str *arr, size_t n);
+
+/*                                 statistics                                 */
+
+#ifdef STR_CONFIG_STATS
+/** add the counters of src to dst */
+STR_FUNCTION void
+str_stats_add(str_stats *dst, const str_stats *src);
+/** append as csv */
+STR_FUNCTION void
+str_stats_format(str *s, const str_stats *st);
+/** counters of the calling thread */
+STR_FUNCTION void
+str_stats_get(str_stats *out);
+/** zero the counters of the calling thread */
+STR_FUNCTION void
+str_stats_reset(void);
+#endif
+#ifdef STR_CONFIG_TRACE
+/** read the next record of a trace */
+STR_FUNCTION int
+str_trace_read(FILE *fp, str_trace_record *r);
+/** record the block events of the calling thread to fp */
+STR_FUNCTION void
+str_trace_start(FILE *fp);
+/** write the pending records and stop recording */
+STR_FUNCTION void
+str_trace_stop(void);
+#endif
+
+/*                                destruction                                 */
+
+/** free owned string, nullify ptr */
+STR_FUNCTION void
+str_free(str *s);
+
+/*.----------------------------------------------------------------------------,
+ /                                definitions                                */
+
+#ifdef STR_CONFIG_MMAP_THRESHOLD
+/* maps n zeroed bytes [null on failure; counted as an allocation] */
+STR_FUNCTION void *
+str_detail_map(size_t n) {
+  void *p = mmap(NULL, n, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                 -1, 0);
+  if (p == MAP_FAILED)
+    return NULL;
+  STR_DETAIL_MADVISE(p, n);
+  STR_DETAIL_STATS_ADD(allocs, 1);
+  STR_DETAIL_STATS_ADD(bytes_allocated, n);
+  return p;
+}
+
+/* unmaps the n bytes at p [counted as a free] */
+STR_FUNCTION void
+str_detail_unmap(void *p, size_t n) {
+  STR_DETAIL_STATS_ADD(frees, 1);
+  munmap(p, n);
+}
+
+#ifdef MREMAP_MAYMOVE
+/* resizes the mapped block of s to that of capacity cap without a copy [the
+ * mapping may move]; returns its new beginning or null on failure. counted
+ * and traced as a free and a new block, as the address may not change */
+STR_FUNCTION void *
+str_detail_remap(str s, size_t cap) {
+  size_t scap = str_cap(s);
+  size_t slen = str_len(s); /* s is unreadable once mremap moves it */
+  size_t n    = STR_DETAIL_ALLOC_SIZE(cap);
+  void  *p    = mremap(str_mbegin(s), STR_DETAIL_ALLOC_SIZE(scap), n,
+                       MREMAP_MAYMOVE);
+  (void)slen; /* only counted and traced */
+  if (p == MAP_FAILED)
+    return NULL;
+  STR_DETAIL_MADVISE(p, n);
+  STR_DETAIL_STATS_ADD(allocs, 1);
+  STR_DETAIL_STATS_ADD(frees, 1);
+  STR_DETAIL_STATS_ADD(bytes_allocated, n);
+  STR_DETAIL_STATS_SLACK(-(ptrdiff_t)(scap - slen));
+  STR_DETAIL_TRACE(s, NULL, scap, slen);
+  return p;
+}
+#endif
+#endif
+
+/*                                construction                                */
+
+/** create a str with capacity cap */
+STR_FUNCTION str
+str_alloc(size_t cap) {
+  void *o;
+  str   s;
+  STR_DETAIL_STATS_FN(STR_STATS_ALLOC);
+  o = STR_DETAIL_ALLOC_BLOCK(cap);
+  if (o == NULL)
+    return NULL;
+  s = str_mstr(o);
+  STR_DETAIL_SET_CAP(s, cap);
+  STR_DETAIL_INIT_LEN(s, 0);
+  STR_DETAIL_STATS_SLACK((ptrdiff_t)cap);
+  STR_DETAIL_TRACE(NULL, s, cap, 0);
+  s[0] = '\0';
+  return s;
+}
+
+#ifdef STR_CONFIG_ALIGN
+/** create a str whose chars and terminator fill whole aligned blocks
+ *  [capacity: cap rounded up to a multiple of STR_CONFIG_ALIGN, less one]
+ *  kernels may then load [0, cap] in whole blocks, and the padding past it */
+STR_FUNCTION str
+str_alloc_aligned(size_t cap) {
+  return str_alloc((cap / STR_CONFIG_ALIGN + 1) * STR_CONFIG_ALIGN - 1);
+}
+#endif
+
+/** duplicate str storage (alloc) */
+STR_FUNCTION str
+str_dup(const str s) {
+  void *o;
+  str   d;
+  STR_DETAIL_STATS_FN(STR_STATS_DUP);
+  o = STR_DETAIL_ALLOC_BLOCK(str_cap(s));
+  if (o == NULL)
+    return NULL;
+  d = str_mstr(o);
+  memcpy((size_t *)d - 2, (size_t *)s - 2, STR_DETAIL_MEMORY_SIZE(str_cap(s)));
+  STR_DETAIL_SET_CAP(d, str_cap(s)); /* the copy is owned */
+  STR_DETAIL_STATS_SLACK((ptrdiff_t)(str_cap(s) - str_len(s)));
+  STR_DETAIL_TRACE(NULL, d, str_cap(s), str_len(s));
+  return d;
+}
+
+/** record length, allocate, copy */
+STR_FUNCTION str
+str_new(const char *s) {
+  size_t len = strlen(s);
+  str    v;
+  STR_DETAIL_STATS_FN(STR_STATS_NEW);
+  STR_DETAIL_INNER(v = str_alloc(len));
+  if (v == NULL)
+    return NULL;
   strcpy(v, s);
   STR_DETAIL_SET_LEN(v, len);
   return v;
@@ -374,10 +1997,12 @@ str_new(const char *s) {
 /** copy up to len chars from s */
 STR_FUNCTION str
 str_sub(const char *s, size_t len) {
-  str v = str_alloc(len);
+  str    v;
+  size_t i;
+  STR_DETAIL_STATS_FN(STR_STATS_SUB);
+  STR_DETAIL_INNER(v = str_alloc(len));
   if (v == NULL)
     return NULL;
-  size_t i;
   for (i = 0; i < len && s[i] != '\0'; ++i)
     v[i] = s[i];
   v[i] = '\0';
@@ -385,265 +2010,2788 @@ str_sub(const char *s, size_t len) {
   return v;
 }
 
-/*                                 properties                                 */
+/*                                 properties                                 */
+
+/** true if capacity is available */
+STR_FUNCTION int
+str_avail(const str s, size_t cap) {
+  return str_cap(s) >= cap;
+}
+
+/** retrieve the capacity */
+STR_FUNCTION size_t
+str_cap(const str s) {
+  return *(((size_t *)s) - 2) & ~STR_DETAIL_FLAGS;
+}
+
+/** pointer to the null terminator */
+STR_FUNCTION char *
+str_end(const str s) {
+  return &s[str_len(s)];
+}
+
+/** true if no ASCII uppercase [scans in blocks] */
+STR_FUNCTION int
+str_islower(const str s) {
+  size_t len = str_len(s);
+  size_t i;
+  STR_DETAIL_FIND_STR(s, len, STR_DETAIL_IS_UPPER, i);
+  return i == len;
+}
+
+/** true if no ASCII lowercase [scans in blocks] */
+STR_FUNCTION int
+str_isupper(const str s) {
+  size_t len = str_len(s);
+  size_t i;
+  STR_DETAIL_FIND_STR(s, len, STR_DETAIL_IS_LOWER, i);
+  return i == len;
+}
+
+/** retrieve the length */
+STR_FUNCTION size_t
+str_len(const str s) {
+  return *(((size_t *)s) - 1);
+}
+
+/** ptr to allocated memory begin [the gap, with STR_CONFIG_ALIGN] */
+STR_FUNCTION void *
+str_mbegin(const str s) {
+#ifdef STR_CONFIG_ALIGN
+  unsigned char *h = (unsigned char *)((size_t *)s - 2);
+  return h - h[-1];
+#else
+  return (size_t *)s - 2;
+#endif
+}
+
+/** ptr to allocated memory end */
+STR_FUNCTION void *
+str_mend(const str s) {
+  return s + str_cap(s);
+}
+
+/** size of allocated memory [with the gap and padding of STR_CONFIG_ALIGN] */
+STR_FUNCTION size_t
+str_msize(const str s) {
+  return STR_DETAIL_ALLOC_SIZE(str_cap(s));
+}
+
+/** str pointer from mbegin
+ *  with STR_CONFIG_ALIGN, the first aligned position that leaves room for
+ *  the header and one gap byte; the gap size is recorded in that byte */
+STR_FUNCTION str
+str_mstr(void *m) {
+#ifdef STR_CONFIG_ALIGN
+  size_t gap = STR_CONFIG_ALIGN -
+               ((size_t)(char *)m + sizeof(size_t) * 2) % STR_CONFIG_ALIGN;
+  ((unsigned char *)m)[gap - 1] = (unsigned char)gap;
+  return (str)((char *)m + gap + sizeof(size_t) * 2);
+#else
+  return (str)((size_t *)(m) + 2);
+#endif
+}
+
+/*                                 comparison                                 */
+
+/** order ignoring ASCII case [<0, 0, >0 like strcmp]
+ *  chars are compared as unsigned after folding A-Z to a-z; if one string is
+ *  a prefix of the other, the shorter one comes first */
+STR_FUNCTION int
+str_casecmp(const str a, const char *b) {
+  size_t alen = str_len(a);
+  size_t blen = strlen(b);
+  size_t n    = alen < blen ? alen : blen;
+  size_t i;
+  STR_DETAIL_CASE_MISMATCH(a, b, n, i);
+  if (i < n)
+    return (int)STR_DETAIL_FOLD(a[i]) - (int)STR_DETAIL_FOLD(b[i]);
+  return alen < blen ? -1 : alen > blen;
+}
+
+/** order ignoring ASCII case [<0, 0, >0 like strcmp] */
+STR_FUNCTION int
+str_casecmp_(const str a, const str b) {
+  size_t alen = str_len(a);
+  size_t blen = str_len(b);
+  size_t n    = alen < blen ? alen : blen;
+  size_t i;
+  STR_DETAIL_CASE_MISMATCH_STR(a, b, n, i);
+  if (i < n)
+    return (int)STR_DETAIL_FOLD(a[i]) - (int)STR_DETAIL_FOLD(b[i]);
+  return alen < blen ? -1 : alen > blen;
+}
+
+/** true if equal ignoring ASCII case [lengths first] */
+STR_FUNCTION int
+str_caseeq(const str a, const char *b) {
+  size_t len = str_len(a);
+  size_t i;
+  if (strlen(b) != len)
+    return 0;
+  STR_DETAIL_CASE_MISMATCH(a, b, len, i);
+  return i == len;
+}
+
+/** true if equal ignoring ASCII case [lengths first] */
+STR_FUNCTION int
+str_caseeq_(const str a, const str b) {
+  size_t len = str_len(a);
+  size_t i;
+  if (str_len(b) != len)
+    return 0;
+  STR_DETAIL_CASE_MISMATCH_STR(a, b, len, i);
+  return i == len;
+}
+
+/** order by bytes, then length [<0, 0, >0 like strcmp]
+ *  chars are compared as unsigned; embedded null bytes are compared as well */
+STR_FUNCTION int
+str_cmp(const str a, const char *b) {
+  size_t alen = str_len(a);
+  size_t blen = strlen(b);
+  int    cmp  = memcmp(a, b, alen < blen ? alen : blen);
+  if (cmp != 0)
+    return cmp;
+  return alen < blen ? -1 : alen > blen;
+}
+
+/** order by bytes, then length [<0, 0, >0 like strcmp] */
+STR_FUNCTION int
+str_cmp_(const str a, const str b) {
+  size_t alen = str_len(a);
+  size_t blen = str_len(b);
+  int    cmp  = memcmp(a, b, alen < blen ? alen : blen);
+  if (cmp != 0)
+    return cmp;
+  return alen < blen ? -1 : alen > blen;
+}
+
+/** true if s ends with suffix */
+STR_FUNCTION int
+str_ends_with(const str s, const char *suffix) {
+  size_t slen = str_len(s);
+  size_t xlen = strlen(suffix);
+  return xlen <= slen && memcmp(&s[slen - xlen], suffix, xlen) == 0;
+}
+
+/** true if s ends with suffix */
+STR_FUNCTION int
+str_ends_with_(const str s, const str suffix) {
+  size_t slen = str_len(s);
+  size_t xlen = str_len(suffix);
+  return xlen <= slen && memcmp(&s[slen - xlen], suffix, xlen) == 0;
+}
+
+/** true if equal [lengths first] */
+STR_FUNCTION int
+str_eq(const str a, const char *b) {
+  size_t len = str_len(a);
+  return strlen(b) == len && memcmp(a, b, len) == 0;
+}
+
+/** true if equal [lengths first; a length mismatch reads no chars] */
+STR_FUNCTION int
+str_eq_(const str a, const str b) {
+  size_t len = str_len(a);
+  return str_len(b) == len && memcmp(a, b, len) == 0;
+}
+
+/** true if s begins with prefix */
+STR_FUNCTION int
+str_starts_with(const str s, const char *prefix) {
+  size_t plen = strlen(prefix);
+  return plen <= str_len(s) && memcmp(s, prefix, plen) == 0;
+}
+
+/** true if s begins with prefix */
+STR_FUNCTION int
+str_starts_with_(const str s, const str prefix) {
+  size_t plen = str_len(prefix);
+  return plen <= str_len(s) && memcmp(s, prefix, plen) == 0;
+}
+
+/*                                  unicode                                   */
+
+/** number of codepoints [of valid utf-8; counts the non-continuation bytes] */
+STR_FUNCTION size_t
+str_utf8_len(const str s) {
+  const unsigned char *p   = (const unsigned char *)s;
+  size_t               len = str_len(s);
+  size_t               n   = 0;
+  size_t               i;
+  if (*(((size_t *)s) - 2) & STR_DETAIL_FLAG_ASCII)
+    return len;
+  for (i = 0; i < len; ++i)
+    n += (p[i] & 0xC0) != 0x80;
+  return n;
+}
+
+/** true if s is valid utf-8 [cached if configured]
+ *  rejects overlong forms, surrogates, and codepoints above U+10FFFF;
+ *  ascii runs are skipped a word at a time */
+STR_FUNCTION int
+str_utf8_valid(const str s) {
+  const size_t         hi    = ~(size_t)0 / 0xFF * 0x80; /* 0x8080...80 */
+  const unsigned char *p     = (const unsigned char *)s;
+  const unsigned char *e     = p + str_len(s);
+  int                  ascii = 1;
+  size_t              *cap   = ((size_t *)s) - 2;
+  if (*cap & (STR_DETAIL_FLAG_ASCII | STR_DETAIL_FLAG_UTF8))
+    return 1;
+  while (p < e) {
+    unsigned char lo = 0x80;
+    unsigned char up = 0xBF;
+    size_t        n;
+    size_t        k;
+    if (*p < 0x80) {
+      size_t w;
+      for (; (size_t)(e - p) >= sizeof(size_t); p += sizeof(size_t)) {
+        memcpy(&w, p, sizeof(size_t));
+        if (w & hi)
+          break;
+      }
+      while (p < e && *p < 0x80)
+        ++p;
+      continue;
+    }
+    ascii = 0;
+    if (*p < 0xC2)
+      return 0; /* continuation byte or overlong 2-byte form */
+    else if (*p < 0xE0)
+      n = 1;
+    else if (*p < 0xF0) {
+      n  = 2;
+      lo = *p == 0xE0 ? 0xA0 : lo; /* overlong */
+      up = *p == 0xED ? 0x9F : up; /* surrogates */
+    } else if (*p < 0xF5) {
+      n  = 3;
+      lo = *p == 0xF0 ? 0x90 : lo; /* overlong */
+      up = *p == 0xF4 ? 0x8F : up; /* above U+10FFFF */
+    } else
+      return 0;
+    if ((size_t)(e - p) <= n || p[1] < lo || p[1] > up)
+      return 0;
+    for (k = 2; k <= n; ++k)
+      if ((p[k] & 0xC0) != 0x80)
+        return 0;
+    p += n + 1;
+  }
+#ifdef STR_CONFIG_UTF8_CACHE
+  if (!(*cap & STR_DETAIL_FLAG_RO))
+    *cap |= ascii ? STR_DETAIL_FLAG_ASCII | STR_DETAIL_FLAG_UTF8
+                  : STR_DETAIL_FLAG_UTF8;
+#else
+  (void)ascii;
+#endif
+  return 1;
+}
+
+/*                                  encoding                                  */
+
+/** append data in base64 [exact size, <= 1 alloc]
+ *  mode selects the alphabet: STR_BASE64_STD pads the output with '=' to a
+ *  multiple of 4 chars, STR_BASE64_URL does not pad; data must not point
+ *  into *s */
+STR_FUNCTION void
+str_append_base64(str *s, const void *data, size_t n, int mode) {
+  static const char std[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                            "abcdefghijklmnopqrstuvwxyz0123456789+/";
+  static const char url[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                            "abcdefghijklmnopqrstuvwxyz0123456789-_";
+  const unsigned char *p    = (const unsigned char *)data;
+  const char          *a    = mode == STR_BASE64_URL ? url : std;
+  size_t               slen = str_len(*s);
+  size_t               rem  = n % 3;
+  size_t               olen = n / 3 * 4;
+  char                *o;
+  size_t               i;
+  STR_DETAIL_STATS_FN(STR_STATS_APPEND_BASE64);
+  if (rem != 0)
+    olen += mode == STR_BASE64_URL ? rem + 1 : 4;
+  STR_DETAIL_INNER(str_fit(s, slen + olen));
+  if (str_cap(*s) < slen + olen || STR_DETAIL_IS_RO(*s))
+    return;
+  o = &(*s)[slen];
+  for (i = 0; i < n - rem; i += 3, o += 4) {
+    unsigned long v = (unsigned long)p[i] << 16 | (unsigned long)p[i + 1] << 8 |
+                      p[i + 2];
+    o[0] = a[v >> 18];
+    o[1] = a[v >> 12 & 63];
+    o[2] = a[v >> 6 & 63];
+    o[3] = a[v & 63];
+  }
+  if (rem != 0) {
+    unsigned long v = (unsigned long)p[i] << 16 |
+                      (rem == 2 ? (unsigned long)p[i + 1] << 8 : 0);
+    o[0] = a[v >> 18];
+    o[1] = a[v >> 12 & 63];
+    if (rem == 2)
+      o[2] = a[v >> 6 & 63];
+    if (mode != STR_BASE64_URL) {
+      o[2] = rem == 2 ? o[2] : '=';
+      o[3] = '=';
+    }
+  }
+  (*s)[slen + olen] = '\0';
+  STR_DETAIL_SET_LEN(*s, slen + olen);
+}
+
+/** append as a csv field [quoted if needed, <= 1 alloc]
+ *  the field is quoted if it contains a comma, a quote, or a line break, and
+ *  its quotes are doubled [RFC 4180 2]; src must not point into *s */
+STR_FUNCTION void
+str_append_csv_field(str *s, const char *src, size_t n) {
+  const char *e    = src + n;
+  size_t      slen = str_len(*s);
+  size_t      olen = n;
+  const char *p;
+  const char *qt;
+  char       *o;
+  size_t      k;
+  STR_DETAIL_STATS_FN(STR_STATS_APPEND_CSV_FIELD);
+  STR_DETAIL_FIND(src, n, STR_DETAIL_CSV_ESC, k);
+  if (k < n) {
+    olen += 2;
+    for (p = src + k; (qt = (const char *)memchr(p, '"', e - p)) != NULL;
+         p = qt + 1)
+      ++olen;
+  }
+  STR_DETAIL_INNER(str_fit(s, slen + olen));
+  if (str_cap(*s) < slen + olen || STR_DETAIL_IS_RO(*s))
+    return;
+  o = &(*s)[slen];
+  if (olen == n) {
+    if (n > 0)
+      memcpy(o, src, n);
+  } else {
+    *o++ = '"';
+    for (p = src; (qt = (const char *)memchr(p, '"', e - p)) != NULL;
+         p = qt + 1) {
+      memcpy(o, p, qt - p + 1);
+      o += qt - p + 1;
+      *o++ = '"';
+    }
+    memcpy(o, p, e - p);
+    o[e - p] = '"';
+  }
+  (*s)[slen + olen] = '\0';
+  STR_DETAIL_SET_LEN(*s, slen + olen);
+}
+
+/** append data in lowercase hex [exact size, <= 1 alloc]
+ *  data must not point into *s */
+STR_FUNCTION void
+str_append_hex(str *s, const void *data, size_t n) {
+  static const char    digits[] = "0123456789abcdef";
+  const unsigned char *p        = (const unsigned char *)data;
+  size_t               slen     = str_len(*s);
+  char                *o;
+  size_t               i;
+  STR_DETAIL_STATS_FN(STR_STATS_APPEND_HEX);
+  STR_DETAIL_INNER(str_fit(s, slen + n * 2));
+  if (str_cap(*s) < slen + n * 2 || STR_DETAIL_IS_RO(*s))
+    return;
+  o = &(*s)[slen];
+  for (i = 0; i < n; ++i) {
+    o[i * 2]     = digits[p[i] >> 4];
+    o[i * 2 + 1] = digits[p[i] & 15];
+  }
+  (*s)[slen + n * 2] = '\0';
+  STR_DETAIL_SET_LEN(*s, slen + n * 2);
+}
+
+/** append as json string chars [exact size, <= 1 alloc]
+ *  escapes quotes, backslashes, and control chars without adding the
+ *  surrounding quotes; other bytes are copied as is, so valid utf-8 stays
+ *  valid; clean runs are found a block at a time and copied with memcpy;
+ *  src must not point into *s */
+STR_FUNCTION void
+str_append_json_escaped(str *s, const char *src, size_t n) {
+  /* escape letters of the control chars; 'u' selects the \u00XX form */
+  static const char    esc[] = "uuuuuuuubtnufruuuuuuuuuuuuuuuuuu";
+  static const char    digits[] = "0123456789abcdef";
+  const unsigned char *q        = (const unsigned char *)src;
+  size_t               slen     = str_len(*s);
+  size_t               olen     = n;
+  char                *o;
+  size_t               i;
+  size_t               k;
+  STR_DETAIL_STATS_FN(STR_STATS_APPEND_JSON_ESCAPED);
+  for (i = 0; i < n; ++i) {
+    STR_DETAIL_FIND(q + i, n - i, STR_DETAIL_JSON_ESC, k);
+    if ((i += k) == n)
+      break;
+    olen += q[i] < 0x20 && esc[q[i]] == 'u' ? 5 : 1;
+  }
+  STR_DETAIL_INNER(str_fit(s, slen + olen));
+  if (str_cap(*s) < slen + olen || STR_DETAIL_IS_RO(*s))
+    return;
+  o = &(*s)[slen];
+  for (i = 0; i < n; ++i) {
+    char c;
+    STR_DETAIL_FIND(q + i, n - i, STR_DETAIL_JSON_ESC, k);
+    memcpy(o, q + i, k);
+    o += k;
+    if ((i += k) == n)
+      break;
+    c    = q[i] < 0x20 ? esc[q[i]] : (char)q[i];
+    *o++ = '\\';
+    *o++ = c;
+    if (c == 'u') {
+      o[0] = '0';
+      o[1] = '0';
+      o[2] = digits[q[i] >> 4];
+      o[3] = digits[q[i] & 15];
+      o += 4;
+    }
+  }
+  (*s)[slen + olen] = '\0';
+  STR_DETAIL_SET_LEN(*s, slen + olen);
+}
+
+/** append decoded base64 [-1 and *bad on failure]
+ *  accepts the alphabet selected by mode, with or without '=' padding, and
+ *  rejects non-zero trailing bits. on failure, s keeps its contents and *bad
+ *  (if not null) receives the offset of the first invalid char, or n if the
+ *  allocation failed; src must not point into *s */
+STR_FUNCTION int
+str_append_unbase64(str *s, const char *src, size_t n, int mode, size_t *bad) {
+  /* 6-bit values; 0x40 marks + and /, 0x80 marks - and _, 0xC0 is invalid */
+  static const char tbl[] =
+      "\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0"
+      "\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0"
+      "\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\x7E\xC0\xBE\xC0\x7F"
+      "\x34\x35\x36\x37\x38\x39\x3A\x3B\x3C\x3D\xC0\xC0\xC0\xC0\xC0\xC0"
+      "\xC0\x00\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0A\x0B\x0C\x0D\x0E"
+      "\x0F\x10\x11\x12\x13\x14\x15\x16\x17\x18\x19\xC0\xC0\xC0\xC0\xBF"
+      "\xC0\x1A\x1B\x1C\x1D\x1E\x1F\x20\x21\x22\x23\x24\x25\x26\x27\x28"
+      "\x29\x2A\x2B\x2C\x2D\x2E\x2F\x30\x31\x32\x33\xC0\xC0\xC0\xC0\xC0"
+      "\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0"
+      "\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0"
+      "\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0"
+      "\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0"
+      "\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0"
+      "\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0"
+      "\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0"
+      "\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0\xC0";
+  const unsigned char *q    = (const unsigned char *)src;
+  const unsigned char *t    = (const unsigned char *)tbl;
+  unsigned             mask = mode == STR_BASE64_URL ? 0x40 : 0x80;
+  size_t               slen = str_len(*s);
+  size_t               m    = n;
+  size_t               olen;
+  size_t               err = n;
+  size_t               i;
+  char                *o;
+  STR_DETAIL_STATS_FN(STR_STATS_APPEND_UNBASE64);
+  if (n % 4 == 0 && n > 0 && src[n - 1] == '=')
+    m -= src[n - 2] == '=' ? 2 : 1;
+  olen = m / 4 * 3 + (m % 4 == 0 ? 0 : m % 4 - 1);
+  STR_DETAIL_INNER(str_fit(s, slen + olen));
+  if (str_cap(*s) < slen + olen || STR_DETAIL_IS_RO(*s)) {
+    if (bad != NULL)
+      *bad = n;
+    return -1;
+  }
+  o = &(*s)[slen];
+  for (i = 0; i + 4 <= m; i += 4, o += 3) {
+    unsigned long v;
+    if ((t[q[i]] | t[q[i + 1]] | t[q[i + 2]] | t[q[i + 3]]) & mask)
+      break;
+    v = (unsigned long)(t[q[i]] & 63) << 18 |
+        (unsigned long)(t[q[i + 1]] & 63) << 12 |
+        (unsigned long)(t[q[i + 2]] & 63) << 6 | (t[q[i + 3]] & 63);
+    o[0] = (char)(v >> 16);
+    o[1] = (char)(v >> 8);
+    o[2] = (char)v;
+  }
+  /* locate the first invalid char of the failed group or of the tail */
+  for (; i < m && err == n; ++i)
+    if (t[q[i]] & mask)
+      err = i;
+  if (err == n && m % 4 == 1)
+    err = m - 1; /* a single char does not encode a byte */
+  else if (err == n && m % 4 != 0) {
+    const unsigned char *r = &q[m / 4 * 4];
+    unsigned long        v = (unsigned long)(t[r[0]] & 63) << 18 |
+                      (unsigned long)(t[r[1]] & 63) << 12 |
+                      (m % 4 == 3 ? (unsigned long)(t[r[2]] & 63) << 6 : 0);
+    if (v & (m % 4 == 3 ? 0xFFUL : 0xFFFFUL))
+      err = m - 1; /* non-zero trailing bits */
+    o[0] = (char)(v >> 16);
+    if (m % 4 == 3)
+      o[1] = (char)(v >> 8);
+  }
+  if (err != n) {
+    (*s)[slen] = '\0';
+    if (bad != NULL)
+      *bad = err;
+    return -1;
+  }
+  (*s)[slen + olen] = '\0';
+  STR_DETAIL_SET_LEN(*s, slen + olen);
+  return 0;
+}
+
+/** append an unquoted csv field [-1 and *bad on failure]
+ *  a quoted field must end with a quote and contain only doubled quotes; an
+ *  unquoted field is appended as is; on failure, s is unchanged and *bad (if
+ *  not null) receives the offset of the unpaired quote (0 if the field is
+ *  unterminated), or n if the allocation failed; src must not point
+ *  into *s */
+STR_FUNCTION int
+str_append_uncsv(str *s, const char *src, size_t n, size_t *bad) {
+  const char *e    = src + n - 1;
+  size_t      slen = str_len(*s);
+  size_t      olen = n;
+  const char *p;
+  const char *qt;
+  char       *o;
+  STR_DETAIL_STATS_FN(STR_STATS_APPEND_UNCSV);
+  if (n > 0 && src[0] == '"') {
+    if (n < 2 || *e != '"') {
+      if (bad != NULL)
+        *bad = 0;
+      return -1;
+    }
+    olen -= 2;
+    for (p = src + 1; (qt = (const char *)memchr(p, '"', e - p)) != NULL;
+         p = qt + 2) {
+      if (qt + 1 == e || qt[1] != '"') {
+        if (bad != NULL)
+          *bad = qt - src;
+        return -1;
+      }
+      --olen;
+    }
+  }
+  STR_DETAIL_INNER(str_fit(s, slen + olen));
+  if (str_cap(*s) < slen + olen || STR_DETAIL_IS_RO(*s)) {
+    if (bad != NULL)
+      *bad = n;
+    return -1;
+  }
+  o = &(*s)[slen];
+  if (olen == n) {
+    if (n > 0)
+      memcpy(o, src, n);
+  } else {
+    for (p = src + 1; (qt = (const char *)memchr(p, '"', e - p)) != NULL;
+         p = qt + 2) {
+      memcpy(o, p, qt - p + 1);
+      o += qt - p + 1;
+    }
+    memcpy(o, p, e - p);
+  }
+  (*s)[slen + olen] = '\0';
+  STR_DETAIL_SET_LEN(*s, slen + olen);
+  return 0;
+}
+
+/** append decoded hex [-1 and *bad on failure]
+ *  accepts upper and lowercase digits; on failure, s keeps its contents and
+ *  *bad (if not null) receives the offset of the first invalid char (the last
+ *  one if n is odd), or n if the allocation failed; src must not point
+ *  into *s */
+STR_FUNCTION int
+str_append_unhex(str *s, const char *src, size_t n, size_t *bad) {
+  const unsigned char *q    = (const unsigned char *)src;
+  size_t               slen = str_len(*s);
+  size_t               err  = n;
+  size_t               i;
+  char                *o;
+  STR_DETAIL_STATS_FN(STR_STATS_APPEND_UNHEX);
+  STR_DETAIL_INNER(str_fit(s, slen + n / 2));
+  if (str_cap(*s) < slen + n / 2 || STR_DETAIL_IS_RO(*s)) {
+    if (bad != NULL)
+      *bad = n;
+    return -1;
+  }
+  o = &(*s)[slen];
+  for (i = 0; i + 2 <= n; i += 2) {
+    unsigned hi = STR_DETAIL_HEX_VAL(q[i]);
+    unsigned lo = STR_DETAIL_HEX_VAL(q[i + 1]);
+    if ((hi | lo) > 15) {
+      err = hi > 15 ? i : i + 1;
+      break;
+    }
+    o[i / 2] = (char)(hi << 4 | lo);
+  }
+  if (err == n && n % 2 != 0)
+    err = n - 1;
+  if (err != n) {
+    (*s)[slen] = '\0';
+    if (bad != NULL)
+      *bad = err;
+    return -1;
+  }
+  (*s)[slen + n / 2] = '\0';
+  STR_DETAIL_SET_LEN(*s, slen + n / 2);
+  return 0;
+}
+
+/** append unescaped json chars [-1 and *bad on failure]
+ *  decodes the chars between the quotes of a json string; \u escapes are
+ *  written as utf-8 and surrogates must be paired; other bytes are copied as
+ *  is; on failure, s is unchanged and *bad (if not null) receives the offset
+ *  of the first invalid char or escape, or n if the allocation failed; src
+ *  must not point into *s */
+STR_FUNCTION int
+str_append_unjson(str *s, const char *src, size_t n, size_t *bad) {
+  static const char    from[] = "\"\\/bfnrt";
+  static const char    to[]   = "\"\\/\b\f\n\r\t";
+  static const char    lead[] = "\x00\x00\xc0\xe0\xf0";
+  const unsigned char *q      = (const unsigned char *)src;
+  size_t               slen   = str_len(*s);
+  size_t               olen   = 0;
+  size_t               err    = n;
+  char                *o      = NULL;
+  int                  pass;
+  STR_DETAIL_STATS_FN(STR_STATS_APPEND_UNJSON);
+  /* the first pass validates and counts, the second writes */
+  for (pass = 0; pass < 2 && err == n; ++pass) {
+    size_t i = 0;
+    while (i < n) {
+      unsigned long cp;
+      const char   *f;
+      size_t        k;
+      STR_DETAIL_FIND(q + i, n - i, STR_DETAIL_JSON_ESC, k);
+      if (o != NULL)
+        memcpy(o + olen, q + i, k);
+      olen += k;
+      if ((i += k) == n)
+        break;
+      if (q[i] != '\\' || i + 1 == n) {
+        err = i;
+        break;
+      }
+      if ((f = (const char *)memchr(from, q[i + 1], 8)) != NULL) {
+        cp = (unsigned char)to[f - from];
+        i += 2;
+      } else if (q[i + 1] == 'u' && n - i >= 6) {
+        STR_DETAIL_HEX4(q + i + 2, cp);
+        if (cp >= 0xD800 && cp < 0xDC00) {
+          unsigned long lo = 0x10000UL;
+          if (n - i >= 12 && q[i + 6] == '\\' && q[i + 7] == 'u')
+            STR_DETAIL_HEX4(q + i + 8, lo);
+          if (lo < 0xDC00 || lo >= 0xE000) {
+            err = i;
+            break;
+          }
+          cp = 0x10000UL + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+          i += 6;
+        } else if (cp > 0xFFFF || (cp >= 0xDC00 && cp < 0xE000)) {
+          err = i;
+          break;
+        }
+        i += 6;
+      } else {
+        err = i;
+        break;
+      }
+      k = cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000UL ? 3 : 4;
+      if (o != NULL) {
+        size_t j;
+        for (j = k - 1; j > 0; --j, cp >>= 6)
+          o[olen + j] = (char)(0x80 | (cp & 0x3F));
+        o[olen] = (char)((unsigned char)lead[k] | cp);
+      }
+      olen += k;
+    }
+    if (pass == 0 && err == n) {
+      STR_DETAIL_INNER(str_fit(s, slen + olen));
+      if (str_cap(*s) < slen + olen || STR_DETAIL_IS_RO(*s))
+        err = n + 1;
+      o    = &(*s)[slen];
+      olen = 0;
+    }
+  }
+  if (err != n) {
+    if (bad != NULL)
+      *bad = err > n ? n : err;
+    return -1;
+  }
+  (*s)[slen + olen] = '\0';
+  STR_DETAIL_SET_LEN(*s, slen + olen);
+  return 0;
+}
+
+/** append percent-decoded chars [-1 and *bad on failure]
+ *  every '%' must start a two-digit hex escape; '+' is not decoded; on
+ *  failure, s is unchanged and *bad (if not null) receives the offset of the
+ *  invalid '%', or n if the allocation failed; src must not point into *s */
+STR_FUNCTION int
+str_append_unurl(str *s, const char *src, size_t n, size_t *bad) {
+  const char *e    = src + n;
+  size_t      slen = str_len(*s);
+  size_t      olen = n;
+  const char *p;
+  const char *pc;
+  char       *o;
+  STR_DETAIL_STATS_FN(STR_STATS_APPEND_UNURL);
+  for (p = src; (pc = (const char *)memchr(p, '%', e - p)) != NULL;
+       p = pc + 3) {
+    if (e - pc < 3 || STR_DETAIL_HEX_VAL((unsigned char)pc[1]) > 15 ||
+        STR_DETAIL_HEX_VAL((unsigned char)pc[2]) > 15) {
+      if (bad != NULL)
+        *bad = pc - src;
+      return -1;
+    }
+    olen -= 2;
+  }
+  STR_DETAIL_INNER(str_fit(s, slen + olen));
+  if (str_cap(*s) < slen + olen || STR_DETAIL_IS_RO(*s)) {
+    if (bad != NULL)
+      *bad = n;
+    return -1;
+  }
+  o = &(*s)[slen];
+  for (p = src; (pc = (const char *)memchr(p, '%', e - p)) != NULL;
+       p = pc + 3) {
+    memcpy(o, p, pc - p);
+    o += pc - p;
+    *o++ = (char)(STR_DETAIL_HEX_VAL((unsigned char)pc[1]) << 4 |
+                  STR_DETAIL_HEX_VAL((unsigned char)pc[2]));
+  }
+  if (e > p)
+    memcpy(o, p, e - p);
+  (*s)[slen + olen] = '\0';
+  STR_DETAIL_SET_LEN(*s, slen + olen);
+  return 0;
+}
+
+/** append percent-encoded chars [exact size, <= 1 alloc]
+ *  every byte but the unreserved A-Z a-z 0-9 - . _ ~ is written as %XX with
+ *  uppercase digits [RFC 3986 2.1]; src must not point into *s */
+STR_FUNCTION void
+str_append_url_encoded(str *s, const char *src, size_t n) {
+  static const char    digits[] = "0123456789ABCDEF";
+  const unsigned char *q        = (const unsigned char *)src;
+  size_t               slen     = str_len(*s);
+  size_t               olen     = n;
+  char                *o;
+  size_t               i;
+  size_t               k;
+  STR_DETAIL_STATS_FN(STR_STATS_APPEND_URL_ENCODED);
+  for (i = 0; i < n; ++i) {
+    STR_DETAIL_FIND(q + i, n - i, STR_DETAIL_URL_ESC, k);
+    if ((i += k) == n)
+      break;
+    olen += 2;
+  }
+  STR_DETAIL_INNER(str_fit(s, slen + olen));
+  if (str_cap(*s) < slen + olen || STR_DETAIL_IS_RO(*s))
+    return;
+  o = &(*s)[slen];
+  for (i = 0; i < n; ++i) {
+    STR_DETAIL_FIND(q + i, n - i, STR_DETAIL_URL_ESC, k);
+    memcpy(o, q + i, k);
+    o += k;
+    if ((i += k) == n)
+      break;
+    o[0] = '%';
+    o[1] = digits[q[i] >> 4];
+    o[2] = digits[q[i] & 15];
+    o += 3;
+  }
+  (*s)[slen + olen] = '\0';
+  STR_DETAIL_SET_LEN(*s, slen + olen);
+}
+
+/*                                 conversion                                 */
+
+/** parse a decimal double [locale-independent, rounded]
+ *  accepts [+-] digits [. digits] [(e|E) [+-] digits] with digits on at least
+ *  one side of the point, and no leading space, inf, nan, or hex forms; up to
+ *  15 significant digits with a small exponent are computed exactly [Clinger],
+ *  the rest by strtod on a copy that uses the locale's decimal point.
+ *  returns 0; 1 on overflow [+-HUGE_VAL]; -1 without a number, or -2 if a
+ *  copy of more than 64 chars cannot be allocated [*used 0, *out unset] */
+STR_FUNCTION int
+str_to_double(const char *s, size_t n, double *out, size_t *used) {
+  static const double pow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                 1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                 1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                 1e18, 1e19, 1e20, 1e21, 1e22};
+  size_t i  = n > 0 && (s[0] == '+' || s[0] == '-');
+  int    ng = i > 0 && s[0] == '-';
+  long   e  = 0;
+  double m  = 0;
+  size_t ib = i;
+  size_t ie;
+  size_t fb;
+  size_t fe;
+  size_t lz;
+  STR_DETAIL_STATS_FN(STR_STATS_TO_DOUBLE);
+  STR_DETAIL_SKIP_DIGITS(s, n, i);
+  ie = fb = fe = i;
+  if (i < n && s[i] == '.') {
+    fb = ++i;
+    STR_DETAIL_SKIP_DIGITS(s, n, i);
+    fe = i;
+  }
+  if (ie == ib && fe == fb) {
+    if (used != NULL)
+      *used = 0;
+    return -1;
+  }
+  if (i < n && (s[i] | 0x20) == 'e') {
+    size_t j  = i + 1;
+    int    en = 0;
+    if (j < n && (s[j] == '+' || s[j] == '-'))
+      en = s[j++] == '-';
+    if (j < n && (unsigned char)(s[j] - '0') < 10) {
+      for (; j < n && (unsigned char)(s[j] - '0') < 10; ++j)
+        if (e < 100000) /* far beyond the range of double */
+          e = e * 10 + (s[j] - '0');
+      e = en ? -e : e;
+      i = j;
+    }
+  }
+  if (used != NULL)
+    *used = i;
+  e -= (long)(fe - fb);
+  for (lz = ib; lz < ie && s[lz] == '0'; ++lz)
+    ;
+  if (lz == ie)
+    for (lz = fb; lz < fe && s[lz] == '0'; ++lz)
+      ;
+  if (lz == fe) {
+    *out = ng ? -0.0 : 0.0;
+    return 0;
+  }
+  if (STR_DETAIL_EXACT_DOUBLE) {
+    /* significant digits, counting trailing zeros */
+    size_t sig = lz < ie ? ie - lz + (fe - fb) : fe - lz;
+    if (sig <= 15 && e >= -22 && e <= 22 + 15 - (long)sig) {
+      if (lz < ie) {
+        STR_DETAIL_ACC_DIGITS(&s[lz], ie - lz, m);
+        STR_DETAIL_ACC_DIGITS(&s[fb], fe - fb, m);
+      } else
+        STR_DETAIL_ACC_DIGITS(&s[lz], fe - lz, m);
+      if (e < 0)
+        m /= pow10[-e];
+      else if (e > 22)
+        m = m * pow10[e - 22] * pow10[22]; /* the first product is exact */
+      else
+        m *= pow10[e];
+      *out = ng ? -m : m;
+      return 0;
+    }
+  }
+  {
+    const char *dp   = localeconv()->decimal_point;
+    size_t      dlen = strlen(dp);
+    size_t      blen = 0;
+    char        sbuf[64];
+    char       *buf  = sbuf;
+    int         errn = errno;
+    int         ovf;
+    if (i + dlen > sizeof(sbuf) &&
+        (buf = (char *)STR_DETAIL_MALLOC(i + dlen)) == NULL) {
+      if (used != NULL)
+        *used = 0;
+      return -2;
+    }
+    memcpy(buf, s, ie);
+    blen = ie;
+    if (fb > ie) {
+      memcpy(&buf[blen], dp, dlen);
+      blen += dlen;
+    }
+    memcpy(&buf[blen], &s[fb], i - fb);
+    buf[blen + i - fb] = '\0';
+    errno              = 0;
+    *out               = strtod(buf, NULL);
+    ovf   = errno == ERANGE && (*out == HUGE_VAL || *out == -HUGE_VAL);
+    errno = errn;
+    if (buf != sbuf)
+      STR_DETAIL_FREE(buf);
+    return ovf;
+  }
+}
+
+/** parse a decimal double [locale-independent, rounded] */
+STR_FUNCTION int
+str_to_double_(const str s, double *out, size_t *used) {
+  return str_to_double(s, str_len(s), out, used);
+}
+
+/** parse a decimal long [1 and saturated on overflow]
+ *  accepts [+-] digits without leading space; see str_to_ulong */
+STR_FUNCTION int
+str_to_long(const char *s, size_t n, long *out, size_t *used) {
+  size_t        i  = n > 0 && (s[0] == '+' || s[0] == '-');
+  int           ng = i > 0 && s[0] == '-';
+  unsigned long mag;
+  size_t        k;
+  int           r;
+  if (i == n || (unsigned char)(s[i] - '0') > 9) {
+    if (used != NULL)
+      *used = 0;
+    return -1;
+  }
+  r = str_to_ulong(&s[i], n - i, &mag, &k);
+  if (used != NULL)
+    *used = i + k;
+  if (r != 0 || mag > (unsigned long)LONG_MAX + ng) {
+    *out = ng ? LONG_MIN : LONG_MAX;
+    return 1;
+  }
+  *out = !ng ? (long)mag : mag > LONG_MAX ? LONG_MIN : -(long)mag;
+  return 0;
+}
+
+/** parse a decimal long [1 and saturated on overflow] */
+STR_FUNCTION int
+str_to_long_(const str s, long *out, size_t *used) {
+  return str_to_long(s, str_len(s), out, used);
+}
+
+/** parse a decimal unsigned long [1 and saturated on overflow]
+ *  accepts [+] digits without leading space; returns -1 and sets *used to 0
+ *  if s does not start with a number, leaving *out as is; digits are
+ *  converted a word at a time [SWAR] */
+STR_FUNCTION int
+str_to_ulong(const char *s, size_t n, unsigned long *out, size_t *used) {
+  const unsigned long step = STR_DETAIL_SWAR_DIGITS == 8 ? 100000000UL
+                                                        : 10000UL;
+  unsigned long       acc  = 0;
+  int                 ovf  = 0;
+  size_t              i    = n > 0 && s[0] == '+';
+  size_t              b    = i;
+  size_t              w;
+  while (n - i >= STR_DETAIL_SWAR_DIGITS) {
+    STR_DETAIL_LOAD_DIGITS(&s[i], w);
+    if (!STR_DETAIL_ALL_DIGITS(w))
+      break;
+    STR_DETAIL_DIGITS_VALUE(w);
+    if (acc > (ULONG_MAX - w) / step)
+      ovf = 1;
+    else
+      acc = acc * step + w;
+    i += STR_DETAIL_SWAR_DIGITS;
+  }
+  for (; i < n && (unsigned char)(s[i] - '0') < 10; ++i) {
+    unsigned d = s[i] - '0';
+    if (acc > (ULONG_MAX - d) / 10)
+      ovf = 1;
+    else
+      acc = acc * 10 + d;
+  }
+  if (used != NULL)
+    *used = i == b ? 0 : i;
+  if (i == b)
+    return -1;
+  *out = ovf ? ULONG_MAX : acc;
+  return ovf;
+}
+
+/** parse a decimal unsigned long [1 and saturated on overflow] */
+STR_FUNCTION int
+str_to_ulong_(const str s, unsigned long *out, size_t *used) {
+  return str_to_ulong(s, str_len(s), out, used);
+}
+
+/*                                manipulation                                */
+
+/** append chars to a */
+STR_FUNCTION void
+str_append(str *a, const char *b) {
+  size_t alen = str_len(*a);
+  size_t blen = strlen(b);
+  STR_DETAIL_STATS_FN(STR_STATS_APPEND);
+  STR_DETAIL_INNER(str_fit(a, alen + blen));
+  strcpy(&(*a)[alen], b);
+  STR_DETAIL_SET_LEN(*a, alen + blen);
+}
+
+/** append str to a */
+STR_FUNCTION void
+str_append_(str *a, const str b) {
+  size_t alen = str_len(*a);
+  size_t blen = str_len(b);
+  STR_DETAIL_STATS_FN(STR_STATS_APPEND_);
+  STR_DETAIL_INNER(str_fit(a, alen + blen));
+  strcpy(&(*a)[alen], b);
+  STR_DETAIL_SET_LEN(*a, alen + blen);
+}
+
+/** append n chars of b [may include null chars]
+ *  copies exactly n chars with one memcpy; b must not point into *a */
+STR_FUNCTION void
+str_append_n(str *a, const char *b, size_t n) {
+  size_t alen = str_len(*a);
+  STR_DETAIL_STATS_FN(STR_STATS_APPEND_N);
+  STR_DETAIL_INNER(str_fit(a, alen + n));
+  if (str_cap(*a) < alen + n || STR_DETAIL_IS_RO(*a))
+    return;
+  memcpy(&(*a)[alen], b, n);
+  (*a)[alen + n] = '\0';
+  STR_DETAIL_SET_LEN(*a, alen + n);
+}
+
+/** prepend chars to b */
+STR_FUNCTION void
+str_prepend(str *b, const char *a) {
+  size_t blen = str_len(*b);
+  size_t alen = strlen(a);
+  STR_DETAIL_STATS_FN(STR_STATS_PREPEND);
+  STR_DETAIL_INNER(str_fit(b, alen + blen));
+  STR_DETAIL_SHIFT_RIGHT(*b, blen, alen);
+  memcpy((*b), a, alen);
+  STR_DETAIL_SET_LEN(*b, alen + blen);
+}
+
+/** prepend str to b */
+STR_FUNCTION void
+str_prepend_(str *b, const str a) {
+  size_t blen = str_len(*b);
+  size_t alen = str_len(a);
+  STR_DETAIL_STATS_FN(STR_STATS_PREPEND_);
+  STR_DETAIL_INNER(str_fit(b, alen + blen));
+  STR_DETAIL_SHIFT_RIGHT(*b, blen, alen);
+  memcpy((*b), a, alen);
+  STR_DETAIL_SET_LEN(*b, alen + blen);
+}
+
+/** overwrite chars in a string */
+STR_FUNCTION void
+str_emplace(str *s, const char *ins, size_t idx) {
+  size_t inslen = strlen(ins);
+  STR_DETAIL_STATS_FN(STR_STATS_EMPLACE);
+  STR_DETAIL_INNER(str_fit(s, idx + inslen));
+  memcpy(&(*s)[idx], ins, inslen);
+  STR_DETAIL_DROP_CACHE(*s);
+  if (idx + inslen > str_len(*s)) {
+    (*s)[idx + inslen] = '\0';
+    STR_DETAIL_SET_LEN(*s, idx + inslen);
+  }
+}
+
+/** overwrite chars in a string */
+STR_FUNCTION void
+str_emplace_(str *s, const str ins, size_t idx) {
+  size_t inslen = str_len(ins);
+  STR_DETAIL_STATS_FN(STR_STATS_EMPLACE_);
+  STR_DETAIL_INNER(str_fit(s, idx + inslen));
+  memcpy(&(*s)[idx], ins, inslen);
+  STR_DETAIL_DROP_CACHE(*s);
+  if (idx + inslen > str_len(*s)) {
+    (*s)[idx + inslen] = '\0';
+    STR_DETAIL_SET_LEN(*s, idx + inslen);
+  }
+}
+
+/** remove n chars at s[idx] [no alloc]
+ *  idx and n are clamped to the str; the tail is moved once */
+STR_FUNCTION void
+str_erase(str *s, size_t idx, size_t n) {
+  size_t slen = str_len(*s);
+  STR_DETAIL_STATS_FN(STR_STATS_ERASE);
+  if (idx > slen)
+    idx = slen;
+  if (n > slen - idx)
+    n = slen - idx;
+  if (n == 0)
+    return;
+  STR_DETAIL_OWN(s);
+  STR_DETAIL_STATS_ADD(bytes_shifted, slen - idx - n + 1);
+  memmove(&(*s)[idx], &(*s)[idx + n], slen - idx - n + 1);
+  STR_DETAIL_SET_LEN(*s, slen - n);
+}
+
+/** insert chars before s[idx] */
+STR_FUNCTION void
+str_insert(str *s, const char *ins, size_t idx) {
+  size_t slen   = str_len(*s);
+  size_t inslen = strlen(ins);
+  STR_DETAIL_STATS_FN(STR_STATS_INSERT);
+  STR_DETAIL_INNER(str_fit(s, slen + inslen));
+  STR_DETAIL_SHIFT_RIGHT(&(*s)[idx], slen - idx, inslen);
+  memcpy(&(*s)[idx], ins, inslen);
+  STR_DETAIL_SET_LEN(*s, slen + inslen);
+}
+
+/** insert str before s[idx] */
+STR_FUNCTION void
+str_insert_(str *s, const str ins, size_t idx) {
+  size_t slen   = str_len(*s);
+  size_t inslen = str_len(ins);
+  STR_DETAIL_STATS_FN(STR_STATS_INSERT_);
+  STR_DETAIL_INNER(str_fit(s, slen + inslen));
+  STR_DETAIL_SHIFT_RIGHT(&(*s)[idx], slen - idx, inslen);
+  memcpy(&(*s)[idx], ins, inslen);
+  STR_DETAIL_SET_LEN(*s, slen + inslen);
+}
+
+/** replace n chars at s[idx] with inslen chars of ins [<= 1 alloc]
+ *  idx and n are clamped to the str; the tail is moved once. ins may point
+ *  into *s, anywhere before, within, or after the replaced chars */
+STR_FUNCTION void
+str_splice(str *s, size_t idx, size_t n, const char *ins, size_t inslen) {
+  size_t slen = str_len(*s);
+  size_t tail;
+  size_t head;
+  size_t off;
+  int    inner;
+  STR_DETAIL_STATS_FN(STR_STATS_SPLICE);
+  if (idx > slen)
+    idx = slen;
+  if (n > slen - idx)
+    n = slen - idx;
+  tail  = slen - idx - n;
+  inner = ins >= *s && ins <= *s + slen;
+  off   = inner ? (size_t)(ins - *s) : 0;
+
+  STR_DETAIL_INNER(str_fit(s, slen - n + inslen));
+  if (str_cap(*s) < slen - n + inslen || STR_DETAIL_IS_RO(*s))
+    return;
+  if (inner) /* the offset survives a reallocation */
+    ins = *s + off;
+
+  STR_DETAIL_STATS_ADD(bytes_shifted, tail + 1);
+  if (inslen <= n) {
+    /* the tail is not yet moved, so no char of ins is overwritten */
+    memmove(&(*s)[idx], ins, inslen);
+    memmove(&(*s)[idx + inslen], &(*s)[idx + n], tail + 1);
+  } else {
+    /* chars of ins within the tail move with it by inslen - n */
+    memmove(&(*s)[idx + inslen], &(*s)[idx + n], tail + 1);
+    if (!inner || off + inslen <= idx + n)
+      head = inslen;
+    else if (off >= idx + n)
+      head = 0;
+    else
+      head = idx + n - off;
+    memmove(&(*s)[idx], ins, head);
+    memcpy(&(*s)[idx + head], ins + head + (inslen - n), inslen - head);
+  }
+  STR_DETAIL_SET_LEN(*s, slen - n + inslen);
+}
+
+/** keep only the n chars at s[idx] [no alloc]
+ *  idx and n are clamped to the str; the kept chars are moved once */
+STR_FUNCTION void
+str_substr(str *s, size_t idx, size_t n) {
+  size_t slen = str_len(*s);
+  STR_DETAIL_STATS_FN(STR_STATS_SUBSTR);
+  if (idx > slen)
+    idx = slen;
+  if (n > slen - idx)
+    n = slen - idx;
+  if (n == slen)
+    return;
+  STR_DETAIL_OWN(s);
+  if (idx > 0) {
+    STR_DETAIL_STATS_ADD(bytes_shifted, n);
+    memmove(*s, &(*s)[idx], n);
+  }
+  (*s)[n] = '\0';
+  STR_DETAIL_SET_LEN(*s, n);
+}
+
+/** copy src in ASCII lowercase [<= 1 alloc]
+ *  replaces the contents of dst; only A-Z are converted [locale-independent] */
+STR_FUNCTION void
+str_cpylower(str *dst, const char *src) {
+  size_t len = strlen(src);
+  size_t i;
+  STR_DETAIL_STATS_FN(STR_STATS_CPYLOWER);
+  STR_DETAIL_INNER(str_fit(dst, len));
+  if (str_cap(*dst) < len || STR_DETAIL_IS_RO(*dst))
+    return;
+  for (i = 0; i < len; ++i)
+    (*dst)[i] = (char)STR_DETAIL_FOLD(src[i]);
+  (*dst)[len] = '\0';
+  STR_DETAIL_SET_LEN(*dst, len);
+}
+
+/** copy src in ASCII lowercase [<= 1 alloc; src may be *dst] */
+STR_FUNCTION void
+str_cpylower_(str *dst, const str src) {
+  size_t len = str_len(src);
+  size_t i;
+  STR_DETAIL_STATS_FN(STR_STATS_CPYLOWER_);
+  STR_DETAIL_INNER(str_fit(dst, len));
+  if (str_cap(*dst) < len || STR_DETAIL_IS_RO(*dst))
+    return;
+  for (i = 0; i < len; ++i)
+    (*dst)[i] = (char)STR_DETAIL_FOLD(src[i]);
+  (*dst)[len] = '\0';
+  STR_DETAIL_SET_LEN(*dst, len);
+}
+
+/** copy src in ASCII uppercase [<= 1 alloc]
+ *  replaces the contents of dst; only a-z are converted [locale-independent] */
+STR_FUNCTION void
+str_cpyupper(str *dst, const char *src) {
+  size_t len = strlen(src);
+  size_t i;
+  STR_DETAIL_STATS_FN(STR_STATS_CPYUPPER);
+  STR_DETAIL_INNER(str_fit(dst, len));
+  if (str_cap(*dst) < len || STR_DETAIL_IS_RO(*dst))
+    return;
+  for (i = 0; i < len; ++i)
+    (*dst)[i] = (char)STR_DETAIL_UNFOLD(src[i]);
+  (*dst)[len] = '\0';
+  STR_DETAIL_SET_LEN(*dst, len);
+}
+
+/** copy src in ASCII uppercase [<= 1 alloc; src may be *dst] */
+STR_FUNCTION void
+str_cpyupper_(str *dst, const str src) {
+  size_t len = str_len(src);
+  size_t i;
+  STR_DETAIL_STATS_FN(STR_STATS_CPYUPPER_);
+  STR_DETAIL_INNER(str_fit(dst, len));
+  if (str_cap(*dst) < len || STR_DETAIL_IS_RO(*dst))
+    return;
+  for (i = 0; i < len; ++i)
+    (*dst)[i] = (char)STR_DETAIL_UNFOLD(src[i]);
+  (*dst)[len] = '\0';
+  STR_DETAIL_SET_LEN(*dst, len);
+}
+
+/** ASCII lowercase in place [no write if unchanged]
+ *  chars before the first uppercase letter are only read, so a lowercase str
+ *  is never written to (nor copied, if read-only) */
+STR_FUNCTION void
+str_tolower(str *s) {
+  size_t len = str_len(*s);
+  size_t i;
+  STR_DETAIL_STATS_FN(STR_STATS_TOLOWER);
+  STR_DETAIL_FIND_STR(*s, len, STR_DETAIL_IS_UPPER, i);
+  if (i == len)
+    return;
+  STR_DETAIL_OWN(s);
+  for (; i < len; ++i)
+    (*s)[i] = (char)STR_DETAIL_FOLD((*s)[i]);
+}
+
+/** ASCII uppercase in place [no write if unchanged] */
+STR_FUNCTION void
+str_toupper(str *s) {
+  size_t len = str_len(*s);
+  size_t i;
+  STR_DETAIL_STATS_FN(STR_STATS_TOUPPER);
+  STR_DETAIL_FIND_STR(*s, len, STR_DETAIL_IS_LOWER, i);
+  if (i == len)
+    return;
+  STR_DETAIL_OWN(s);
+  for (; i < len; ++i)
+    (*s)[i] = (char)STR_DETAIL_UNFOLD((*s)[i]);
+}
+
+/** center pad to reach len */
+STR_FUNCTION void
+str_cpad(str *s, size_t len) {
+  str_cpadf(s, len, " ", STR_PAD_BYTES);
+}
+
+/** center pad with a fill pattern to reach width [<= 1 alloc, 1 move]
+ *  width and fill are measured in bytes or codepoints as selected by mode
+ *  (STR_PAD_BYTES or STR_PAD_CODEPOINTS); the left side gets the smaller
+ *  half. each side repeats fill from its start and ends with a prefix of it
+ *  if needed. an empty fill does nothing; fill must not point into *s */
+STR_FUNCTION void
+str_cpadf(str *s, size_t width, const char *fill, int mode) {
+  STR_DETAIL_STATS_FN(STR_STATS_CPADF);
+  STR_DETAIL_PAD(s, width, fill, mode, 2);
+}
+
+/** left pad to reach len */
+STR_FUNCTION void
+str_lpad(str *s, size_t len) {
+  str_lpadf(s, len, " ", STR_PAD_BYTES);
+}
+
+/** left pad with a fill pattern to reach width [<= 1 alloc, 1 move]
+ *  see str_cpadf */
+STR_FUNCTION void
+str_lpadf(str *s, size_t width, const char *fill, int mode) {
+  STR_DETAIL_STATS_FN(STR_STATS_LPADF);
+  STR_DETAIL_PAD(s, width, fill, mode, 1);
+}
+
+/** right pad to reach len */
+STR_FUNCTION void
+str_rpad(str *s, size_t len) {
+  str_rpadf(s, len, " ", STR_PAD_BYTES);
+}
+
+/** right pad with a fill pattern to reach width [<= 1 alloc, no move]
+ *  see str_cpadf */
+STR_FUNCTION void
+str_rpadf(str *s, size_t width, const char *fill, int mode) {
+  STR_DETAIL_STATS_FN(STR_STATS_RPADF);
+  STR_DETAIL_PAD(s, width, fill, mode, 0);
+}
+
+/** trim leading and trailing whitespace */
+STR_FUNCTION void
+str_trim(str *s) {
+  size_t slen = str_len(*s);
+  size_t beg;
+  size_t end;
+  STR_DETAIL_STATS_FN(STR_STATS_TRIM);
+  for (beg = 0; beg < slen && isspace((*s)[beg]); ++beg)
+    ;
+  for (end = slen; end > beg && isspace((*s)[end - 1]); --end)
+    ;
+
+  if (beg > 0 || end < slen)
+    STR_DETAIL_OWN(s);
+
+  if (beg > 0)
+    STR_DETAIL_SHIFT_LEFT(&(*s)[beg], end - beg, beg);
+
+  if (beg > 0 || end < slen) {
+    (*s)[end - beg] = '\0';
+    STR_DETAIL_SET_LEN(*s, end - beg);
+  }
+}
+
+/** zero len, term [no realloc] */
+STR_FUNCTION void
+str_clear(str *s) {
+  STR_DETAIL_STATS_FN(STR_STATS_CLEAR);
+  STR_DETAIL_OWN(s);
+  (*s)[0] = '\0';
+  STR_DETAIL_SET_LEN(*s, 0);
+}
+
+/** resize if capacity < min_cap [copies a read-only str] */
+STR_FUNCTION void
+str_fit(str *a, size_t min_cap) {
+  STR_DETAIL_STATS_FN(STR_STATS_FIT);
+  if (str_cap(*a) < min_cap)
+    STR_DETAIL_INNER(str_realloc(a, min_cap));
+  else if (STR_DETAIL_IS_RO(*a))
+    STR_DETAIL_INNER(str_realloc(a, str_cap(*a)));
+}
+
+/** grow string capacity by delta */
+STR_FUNCTION void
+str_grow(str *s, size_t delta) {
+  STR_DETAIL_STATS_FN(STR_STATS_GROW);
+  STR_DETAIL_INNER(str_realloc(s, str_cap(*s) + delta));
+}
+
+/** resize string [reallocates and null terminates] */
+STR_FUNCTION void
+str_realloc(str *s, size_t cap) {
+  size_t msize = STR_DETAIL_MEMORY_SIZE(cap);
+  void  *v;
+  str    d;
+  STR_DETAIL_STATS_FN(STR_STATS_REALLOC);
+#if defined STR_CONFIG_MMAP_THRESHOLD && defined MREMAP_MAYMOVE
+  /* a mapped block that stays mapped is remapped rather than copied */
+  if (STR_DETAIL_IS_MAPPED(cap) && STR_DETAIL_IS_MAPPED(str_cap(*s)) &&
+      !STR_DETAIL_IS_RO(*s)) {
+    v = str_detail_remap(*s, cap);
+    if (v == NULL)
+      return;
+    msize = 0;
+    d     = str_mstr(v); /* the gap is the same, as mappings are aligned */
+    STR_DETAIL_TRACE(NULL, d, cap, str_len(d));
+  } else
+#endif
+  {
+    v = STR_DETAIL_ALLOC_BLOCK(cap);
+
+    if (v == NULL)
+      return;
+
+    /* the whole old block is kept when growing [editing relies on it] */
+    if (STR_DETAIL_MEMORY_SIZE(str_cap(*s)) < msize)
+      msize = STR_DETAIL_MEMORY_SIZE(str_cap(*s));
+    d = str_mstr(v);
+    memcpy((size_t *)d - 2, (size_t *)*s - 2, msize);
+    STR_DETAIL_TRACE(*s, d, cap, str_len(*s));
+    STR_DETAIL_INNER(str_free(s));
+  }
+
+  *s = d;
+  STR_DETAIL_SET_CAP(*s, cap);
+  STR_DETAIL_STATS_ADD(reallocs, 1);
+  STR_DETAIL_STATS_ADD(bytes_copied, msize);
+  STR_DETAIL_STATS_SLACK((ptrdiff_t)cap - (ptrdiff_t)str_len(*s));
+
+  if (cap < str_len(*s)) {
+    (*s)[cap] = '\0';
+    STR_DETAIL_SET_LEN(*s, cap);
+  }
+}
+
+/** shrink cap [null if needed] */
+STR_FUNCTION void
+str_shrink(str *s, size_t delta) {
+  STR_DETAIL_STATS_FN(STR_STATS_SHRINK);
+  STR_DETAIL_INNER(str_realloc(s, str_cap(*s) - delta));
+}
+
+/** shrink to len if cap > len */
+STR_FUNCTION void
+str_shrinkfit(str *s) {
+  size_t slen = str_len(*s);
+  STR_DETAIL_STATS_FN(STR_STATS_SHRINKFIT);
+  if (slen < str_cap(*s))
+    STR_DETAIL_INNER(str_realloc(s, slen));
+}
+
+/*                                  editing                                   */
+
+/** open a gap at s[idx]
+ *  moves s[idx..len) to the end of the capacity; until str_edit_commit,
+ *  *s must only be accessed through e */
+STR_FUNCTION void
+str_edit_begin(str_edit *e, str *s, size_t idx) {
+  size_t slen;
+  size_t scap;
+  STR_DETAIL_STATS_FN(STR_STATS_EDIT_BEGIN);
+  STR_DETAIL_OWN(s);
+  slen = str_len(*s);
+  scap = str_cap(*s);
+  memmove(&(*s)[scap - (slen - idx)], &(*s)[idx], slen - idx);
+  STR_DETAIL_STATS_ADD(bytes_shifted, slen - idx);
+  e->s   = s;
+  e->gap = idx;
+  e->end = scap - (slen - idx);
+}
+
+/** close the gap, set len, term */
+STR_FUNCTION void
+str_edit_commit(str_edit *e) {
+  size_t suflen = str_cap(*e->s) - e->end;
+  STR_DETAIL_STATS_FN(STR_STATS_EDIT_COMMIT);
+  memmove(&(*e->s)[e->gap], &(*e->s)[e->end], suflen);
+  STR_DETAIL_STATS_ADD(bytes_shifted, suflen);
+  (*e->s)[e->gap + suflen] = '\0';
+  STR_DETAIL_SET_LEN(*e->s, e->gap + suflen);
+  e->end = e->gap + suflen;
+  e->gap = e->end;
+}
+
+/** remove n chars after cursor [stops at the end of the text] */
+STR_FUNCTION void
+str_edit_erase(str_edit *e, size_t n) {
+  size_t suflen = str_cap(*e->s) - e->end;
+  e->end += n < suflen ? n : suflen;
+}
+
+/** insert chars at cursor; the cursor is moved past the insertion */
+STR_FUNCTION void
+str_edit_insert(str_edit *e, const char *ins) {
+  size_t inslen = strlen(ins);
+  STR_DETAIL_STATS_FN(STR_STATS_EDIT_INSERT);
+  STR_DETAIL_EDIT_RESERVE(e, inslen);
+  memcpy(&(*e->s)[e->gap], ins, inslen);
+  e->gap += inslen;
+}
+
+/** insert str at cursor; the cursor is moved past the insertion */
+STR_FUNCTION void
+str_edit_insert_(str_edit *e, const str ins) {
+  size_t inslen = str_len(ins);
+  STR_DETAIL_STATS_FN(STR_STATS_EDIT_INSERT_);
+  STR_DETAIL_EDIT_RESERVE(e, inslen);
+  memcpy(&(*e->s)[e->gap], ins, inslen);
+  e->gap += inslen;
+}
+
+/** length of the edited text */
+STR_FUNCTION size_t
+str_edit_len(const str_edit *e) {
+  return e->gap + (str_cap(*e->s) - e->end);
+}
+
+/** move the cursor to idx [moves only the chars between cursor and idx] */
+STR_FUNCTION void
+str_edit_seek(str_edit *e, size_t idx) {
+  STR_DETAIL_STATS_FN(STR_STATS_EDIT_SEEK);
+  if (idx < e->gap) {
+    size_t n = e->gap - idx;
+    memmove(&(*e->s)[e->end - n], &(*e->s)[idx], n);
+    STR_DETAIL_STATS_ADD(bytes_shifted, n);
+    e->gap = idx;
+    e->end -= n;
+  } else if (idx > e->gap) {
+    size_t n = idx - e->gap;
+    memmove(&(*e->s)[e->gap], &(*e->s)[e->end], n);
+    STR_DETAIL_STATS_ADD(bytes_shifted, n);
+    e->gap = idx;
+    e->end += n;
+  }
+}
+
+/*                                  building                                  */
+
+/** append chars [no copy on growth] */
+STR_FUNCTION void
+str_builder_append(str_builder *b, const char *s) {
+  size_t slen = strlen(s);
+  STR_DETAIL_STATS_FN(STR_STATS_BUILDER_APPEND);
+  STR_DETAIL_INNER(str_builder_reserve(b, slen));
+  if (b->avail < slen)
+    return;
+  STR_DETAIL_BUILDER_COPY(b, s, slen);
+}
+
+/** append str [no copy on growth] */
+STR_FUNCTION void
+str_builder_append_(str_builder *b, const str s) {
+  size_t slen = str_len(s);
+  STR_DETAIL_STATS_FN(STR_STATS_BUILDER_APPEND_);
+  STR_DETAIL_INNER(str_builder_reserve(b, slen));
+  if (b->avail < slen)
+    return;
+  STR_DETAIL_BUILDER_COPY(b, s, slen);
+}
+
+/** join segments (alloc, 1 copy) [null on failure; b is kept] */
+STR_FUNCTION str
+str_builder_finish(str_builder *b) {
+  str    s;
+  size_t i;
+  size_t n = 0;
+  STR_DETAIL_STATS_FN(STR_STATS_BUILDER_FINISH);
+  STR_DETAIL_INNER(s = str_alloc(b->len));
+  if (s == NULL)
+    return NULL;
+  for (i = 0; i < b->nsegs; ++i) {
+    memcpy(&s[n], b->segs[i], str_len(b->segs[i]));
+    n += str_len(b->segs[i]);
+  }
+  s[n] = '\0';
+  STR_DETAIL_SET_LEN(s, n);
+  STR_DETAIL_INNER(str_builder_free(b));
+  return s;
+}
+
+/** free segments, reset */
+STR_FUNCTION void
+str_builder_free(str_builder *b) {
+  size_t i;
+  STR_DETAIL_STATS_FN(STR_STATS_BUILDER_FREE);
+  for (i = 0; i < b->nsegs; ++i)
+    STR_DETAIL_INNER(str_free(&b->segs[i]));
+  if (b->segs != NULL)
+    STR_DETAIL_FREE(b->segs);
+  str_builder_init(b);
+}
+
+/** empty builder [no alloc] */
+STR_FUNCTION void
+str_builder_init(str_builder *b) {
+  b->segs  = NULL;
+  b->nsegs = 0;
+  b->scap  = 0;
+  b->cur   = 0;
+  b->len   = 0;
+  b->avail = 0;
+}
+
+/** total appended length */
+STR_FUNCTION size_t
+str_builder_len(const str_builder *b) {
+  return b->len;
+}
+
+/** room for n chars [<= 2 allocs]
+ *  reserves a single segment of max(n - avail, STR_CONFIG_BUILDER_SEGMENT);
+ *  the segment array doubles first if it is full */
+STR_FUNCTION void
+str_builder_reserve(str_builder *b, size_t n) {
+  size_t cap;
+  str    seg;
+  STR_DETAIL_STATS_FN(STR_STATS_BUILDER_RESERVE);
+  if (b->avail >= n)
+    return;
+  if (b->nsegs == b->scap) {
+    size_t scap = b->scap ? b->scap * 2 : 8;
+    str   *segs = (str *)STR_DETAIL_MALLOC(sizeof(str) * scap);
+    if (segs == NULL)
+      return;
+    if (b->segs != NULL) {
+      memcpy(segs, b->segs, sizeof(str) * b->nsegs);
+      STR_DETAIL_FREE(b->segs);
+    }
+    b->segs = segs;
+    b->scap = scap;
+  }
+  cap = n - b->avail;
+  if (cap < STR_CONFIG_BUILDER_SEGMENT)
+    cap = STR_CONFIG_BUILDER_SEGMENT;
+  STR_DETAIL_INNER(seg = str_alloc(cap));
+  if (seg == NULL)
+    return;
+  b->segs[b->nsegs++] = seg;
+  b->avail += cap;
+}
+
+#ifdef STR_CONFIG_POSIX
+/** write segments to fd [-1 on failure; errno is set by writev] */
+STR_FUNCTION int
+str_builder_writev(const str_builder *b, int fd) {
+  return str_writev(fd, b->segs, b->nsegs);
+}
+#endif
+
+/*                                  vectors                                   */
+
+/** free the elements, reset */
+STR_FUNCTION void
+str_vec_free(str_vec *v) {
+  STR_DETAIL_STATS_FN(STR_STATS_VEC_FREE);
+  if (v->data != NULL)
+    STR_DETAIL_INNER(str_free(&v->data));
+  if (v->offs != NULL)
+    STR_DETAIL_FREE(v->offs);
+  str_vec_init(v);
+}
+
+/** element i and its length [no copy] [null if i is out of range]
+ *  the element is null terminated; len may be null */
+STR_FUNCTION char *
+str_vec_get(const str_vec *v, size_t i, size_t *len) {
+  if (i >= v->n)
+    return NULL;
+  if (len != NULL)
+    *len = v->offs[i + 1] - v->offs[i] - 1;
+  return &v->data[v->offs[i]];
+}
+
+/** copy of element i (alloc) [null if i is out of range] */
+STR_FUNCTION str
+str_vec_get_str(const str_vec *v, size_t i) {
+  size_t len;
+  char  *e = str_vec_get(v, i, &len);
+  str    s;
+  STR_DETAIL_STATS_FN(STR_STATS_VEC_GET_STR);
+  if (e == NULL)
+    return NULL;
+  STR_DETAIL_INNER(s = str_alloc(len));
+  if (s == NULL)
+    return NULL;
+  memcpy(s, e, len + 1);
+  STR_DETAIL_SET_LEN(s, len);
+  return s;
+}
 
-/** true if capacity is available */
-STR_FUNCTION int
-str_avail(const str s, size_t cap) {
-  return str_cap(s) >= cap;
+/** empty vector [no alloc] */
+STR_FUNCTION void
+str_vec_init(str_vec *v) {
+  v->data = NULL;
+  v->offs = NULL;
+  v->n    = 0;
+  v->ocap = 0;
 }
 
-/** retrieve the capacity */
+/** number of elements */
 STR_FUNCTION size_t
-str_cap(const str s) {
-  return *(((size_t *)s) - 2);
+str_vec_len(const str_vec *v) {
+  return v->n;
 }
 
-/** pointer to the null terminator */
-STR_FUNCTION char *
-str_end(const str s) {
-  return &s[str_len(s)];
+/** remove the last element [keeps the capacity] */
+STR_FUNCTION void
+str_vec_pop(str_vec *v) {
+  STR_DETAIL_STATS_FN(STR_STATS_VEC_POP);
+  if (v->n == 0)
+    return;
+  --v->n;
+  v->data[v->offs[v->n]] = '\0';
+  STR_DETAIL_SET_LEN(v->data, v->offs[v->n]);
 }
 
-/** retrieve the length */
-STR_FUNCTION size_t
-str_len(const str s) {
-  return *(((size_t *)s) - 1);
+/** append an element [amortized O(1), no per-element alloc] */
+STR_FUNCTION void
+str_vec_push(str_vec *v, const char *s) {
+  size_t slen = strlen(s);
+  size_t end;
+  STR_DETAIL_STATS_FN(STR_STATS_VEC_PUSH);
+  STR_DETAIL_VEC_RESERVE(v, slen + 1, 1);
+  end = v->offs[v->n] + slen + 1;
+  memcpy(&v->data[v->offs[v->n]], s, slen + 1);
+  v->data[end]     = '\0';
+  v->offs[++v->n] = end;
+  STR_DETAIL_SET_LEN(v->data, end);
 }
 
-/** ptr to allocated memory begin */
-STR_FUNCTION void *
-str_mbegin(const str s) {
-  return (size_t *)s - 2;
+/** append an element [amortized O(1), no per-element alloc] */
+STR_FUNCTION void
+str_vec_push_(str_vec *v, const str s) {
+  size_t slen = str_len(s);
+  size_t end;
+  STR_DETAIL_STATS_FN(STR_STATS_VEC_PUSH_);
+  STR_DETAIL_VEC_RESERVE(v, slen + 1, 1);
+  end = v->offs[v->n] + slen + 1;
+  memcpy(&v->data[v->offs[v->n]], s, slen + 1);
+  v->data[end]     = '\0';
+  v->offs[++v->n] = end;
+  STR_DETAIL_SET_LEN(v->data, end);
 }
 
-/** ptr to allocated memory end */
-STR_FUNCTION void *
-str_mend(const str s) {
-  return s + str_cap(s);
+/** append the fields of buf [1 copy]
+ *  fields are separated or terminated by delim, so a trailing delim does not
+ *  start an empty field; buf is copied once and each delim is replaced by a
+ *  null terminator in place */
+STR_FUNCTION void
+str_vec_split(str_vec *v, const char *buf, size_t len, char delim) {
+  size_t beg;
+  size_t end;
+  STR_DETAIL_STATS_FN(STR_STATS_VEC_SPLIT);
+  if (len == 0)
+    return;
+  STR_DETAIL_VEC_RESERVE(v, len + 1, 1);
+  beg = v->offs[v->n];
+  end = beg + len;
+  memcpy(&v->data[beg], buf, len);
+  v->data[end] = delim;
+  while (beg <= end) {
+    char  *d   = (char *)memchr(&v->data[beg], delim, end + 1 - beg);
+    size_t nxt = (size_t)(d - v->data) + 1;
+    if (nxt > end && beg == end)
+      break; /* buf ended with delim */
+    *d = '\0';
+    if (v->n == v->ocap) {
+      char c = v->data[beg];
+      v->data[beg] = '\0'; /* keep the fields so far if the reserve fails */
+      STR_DETAIL_SET_LEN(v->data, beg);
+      STR_DETAIL_VEC_RESERVE(v, 1, 1); /* data has room past beg */
+      v->data[beg] = c;
+    }
+    v->offs[++v->n] = nxt;
+    beg             = nxt;
+  }
+  v->data[beg] = '\0';
+  STR_DETAIL_SET_LEN(v->data, beg);
 }
 
-/** size of allocated memory */
-STR_FUNCTION size_t
-str_msize(const str s) {
-  return STR_DETAIL_MEMORY_SIZE(str_cap(s));
+/*                                  sorting                                   */
+
+/** sort by bytes, then by length [no alloc, no strcmp]
+ *  multikey quicksort: ranges are three-way partitioned on the byte at
+ *  depth d, and the equal part moves on to d + 1 without comparing the
+ *  shared prefix again; stored lengths replace terminator scans, so strs
+ *  may contain null bytes. not stable */
+STR_FUNCTION void
+str_sort(str *arr, size_t n) {
+  size_t stk[STR_DETAIL_SORT_STACK * 3];
+  size_t top = 0;
+  size_t lo  = 0;
+  size_t hi  = n;
+  size_t d   = 0;
+  for (;;) {
+    size_t i;
+    while (hi - lo > STR_DETAIL_SORT_MIN) {
+      size_t lt = lo;
+      size_t gt = hi;
+      size_t r[3][3]; /* [lo, hi, d] of the three parts */
+      size_t z[3];    /* their sizes */
+      size_t big;
+      size_t small;
+      int    a = STR_DETAIL_SORT_KEY(arr[lo], d);
+      int    b = STR_DETAIL_SORT_KEY(arr[lo + (hi - lo) / 2], d);
+      int    c = STR_DETAIL_SORT_KEY(arr[hi - 1], d);
+      int    v = a < b ? (b < c ? b : (a < c ? c : a)) /* median of three */
+                       : (a < c ? a : (b < c ? c : b));
+      for (i = lo; i < gt;) {
+        int k = STR_DETAIL_SORT_KEY(arr[i], d);
+        if (k < v) {
+          STR_DETAIL_SORT_SWAP(arr[lt], arr[i]);
+          ++lt;
+          ++i;
+        } else if (k > v) {
+          --gt;
+          STR_DETAIL_SORT_SWAP(arr[i], arr[gt]);
+        } else
+          ++i;
+      }
+      r[0][0] = lo, r[0][1] = lt, r[0][2] = d;
+      if (lt == lo && gt == hi && v != 0) {
+        /* all strs share byte d; skip the rest of their common prefix in
+         * one pass instead of one partition pass per byte */
+        size_t m = str_len(arr[lo]);
+        for (i = lo + 1; i < hi && m > d + 1; ++i) {
+          size_t k = d + 1;
+          size_t l = str_len(arr[i]) < m ? str_len(arr[i]) : m;
+          while (k < l && arr[i][k] == arr[lo][k])
+            ++k;
+          m = k;
+        }
+        d = m; /* at least d + 1, as every str has byte d */
+        continue;
+      }
+      /* strs equal to a pivot of 0 ended at d and are in place */
+      r[1][0] = lt, r[1][1] = v == 0 ? lt : gt, r[1][2] = d + 1;
+      r[2][0] = gt, r[2][1] = hi, r[2][2] = d;
+      /* push the largest part, then the middle one, and continue with the
+       * smallest; the stack then grows by at most one range per halving */
+      for (i = 0; i < 3; ++i)
+        z[i] = r[i][1] - r[i][0];
+      big   = z[0] >= z[1] ? (z[0] >= z[2] ? 0 : 2) : (z[1] >= z[2] ? 1 : 2);
+      small = z[(big + 1) % 3] <= z[(big + 2) % 3] ? (big + 1) % 3
+                                                    : (big + 2) % 3;
+      for (i = 0; i < 2; ++i) {
+        size_t p = i == 0 ? big : 3 - big - small;
+        if (z[p] < 2)
+          continue;
+        stk[top++] = r[p][0];
+        stk[top++] = r[p][1];
+        stk[top++] = r[p][2];
+      }
+      lo = r[small][0];
+      hi = r[small][1];
+      d  = r[small][2];
+    }
+    /* insertion sort; all strs in [lo, hi) share their first d chars */
+    for (i = lo + 1; i < hi; ++i) {
+      str    s    = arr[i];
+      size_t slen = str_len(s);
+      size_t j;
+      for (j = i; j > lo; --j) {
+        size_t plen = str_len(arr[j - 1]);
+        size_t mlen = (slen < plen ? slen : plen) - d;
+        int    cmp  = memcmp(&s[d], &arr[j - 1][d], mlen);
+        if (cmp > 0 || (cmp == 0 && slen >= plen))
+          break;
+        arr[j] = arr[j - 1];
+      }
+      arr[j] = s;
+    }
+    if (top == 0)
+      return;
+    d  = stk[--top];
+    hi = stk[--top];
+    lo = stk[--top];
+  }
 }
 
-/** str pointer from mbegin */
-STR_FUNCTION str
-str_mstr(void *m) {
-  return (str)((size_t *)(m) + 2);
+/*                                  reading                                   */
+
+/** read a line into *line [reuses its capacity]
+ *  the newline is not stored; returns 1 if a line was read, 0 at end of
+ *  input, and -1 on read or allocation failure */
+STR_FUNCTION int
+str_getline(str_reader *r, str *line) {
+  const char *v;
+  size_t      vlen;
+  int         rc;
+  STR_DETAIL_STATS_FN(STR_STATS_GETLINE);
+  STR_DETAIL_INNER(rc = str_getline_view(r, &v, &vlen));
+  if (rc != 1)
+    return rc;
+  STR_DETAIL_INNER(str_fit(line, vlen));
+  if (!str_avail(*line, vlen))
+    return -1;
+  memcpy(*line, v, vlen);
+  (*line)[vlen] = '\0';
+  STR_DETAIL_SET_LEN(*line, vlen);
+  return 1;
 }
 
-/*                                manipulation                                */
+/** read a line in place [no copy]
+ *  *line points into the reader buffer and is valid until the next read;
+ *  it is null terminated in place of the newline. returns like str_getline */
+STR_FUNCTION int
+str_getline_view(str_reader *r, const char **line, size_t *len) {
+  STR_DETAIL_STATS_FN(STR_STATS_GETLINE_VIEW);
+  if (r->buf == NULL) {
+    STR_DETAIL_INNER(r->buf = str_alloc(STR_CONFIG_READER_BUFFER));
+    if (r->buf == NULL)
+      return -1;
+  }
+  for (;;) {
+    size_t blen = str_len(r->buf);
+    char  *nl   = (char *)memchr(&r->buf[r->scan], '\n', blen - r->scan);
+    size_t room;
+    size_t n;
 
-/** append chars to a */
-STR_FUNCTION void
-str_append(str *a, const char *b) {
-  size_t alen = str_len(*a);
-  size_t blen = strlen(b);
-  str_fit(a, alen + blen);
-  strcpy(&(*a)[alen], b);
-  STR_DETAIL_SET_LEN(*a, alen + blen);
+    if (nl != NULL) {
+      *nl    = '\0';
+      *line  = &r->buf[r->pos];
+      *len   = (size_t)(nl - *line);
+      r->pos = r->scan = (size_t)(nl - r->buf) + 1;
+      return 1;
+    }
+    if (r->eof) {
+      if (r->pos == blen)
+        return 0;
+      *line  = &r->buf[r->pos];
+      *len   = blen - r->pos;
+      r->pos = r->scan = blen;
+      return 1;
+    }
+
+    /* keep the partial line and refill behind it */
+    if (r->pos > 0) {
+      memmove(r->buf, &r->buf[r->pos], blen - r->pos);
+      STR_DETAIL_STATS_ADD(bytes_shifted, blen - r->pos);
+      blen -= r->pos;
+      r->pos = 0;
+    }
+    r->scan = blen;
+    if (blen == str_cap(r->buf)) {
+      STR_DETAIL_INNER(str_grow(&r->buf, blen));
+      if (str_cap(r->buf) == blen)
+        return -1;
+    }
+    room = str_cap(r->buf) - blen;
+
+#ifdef STR_CONFIG_POSIX
+    if (r->fp == NULL) {
+      ssize_t rd;
+      do
+        rd = read(r->fd, &r->buf[blen], room);
+      while (rd < 0 && errno == EINTR);
+      if (rd < 0)
+        return -1;
+      n = (size_t)rd;
+    } else
+#endif
+    {
+      n = fread(&r->buf[blen], 1, room, r->fp);
+      if (n == 0 && ferror(r->fp))
+        return -1;
+    }
+
+    if (n == 0)
+      r->eof = 1;
+    r->buf[blen + n] = '\0';
+    STR_DETAIL_SET_LEN(r->buf, blen + n);
+  }
 }
 
-/** append str to a */
+/** free the buffer, reset [the source is not closed] */
 STR_FUNCTION void
-str_append_(str *a, const str b) {
-  size_t alen = str_len(*a);
-  size_t blen = str_len(b);
-  str_fit(a, alen + blen);
-  strcpy(&(*a)[alen], b);
-  STR_DETAIL_SET_LEN(*a, alen + blen);
+str_reader_free(str_reader *r) {
+  STR_DETAIL_STATS_FN(STR_STATS_READER_FREE);
+  if (r->buf != NULL)
+    STR_DETAIL_INNER(str_free(&r->buf));
+  r->pos  = 0;
+  r->scan = 0;
+  r->eof  = 0;
 }
 
-/** prepend chars to b */
+/** read lines from fp [no alloc] */
 STR_FUNCTION void
-str_prepend(str *b, const char *a) {
-  size_t blen = str_len(*b);
-  size_t alen = strlen(a);
-  str_fit(b, alen + blen);
-  STR_DETAIL_SHIFT_RIGHT(*b, blen, alen);
-  memcpy((*b), a, alen);
-  STR_DETAIL_SET_LEN(*b, alen + blen);
+str_reader_init(str_reader *r, FILE *fp) {
+  r->buf  = NULL;
+  r->pos  = 0;
+  r->scan = 0;
+  r->fp   = fp;
+  r->fd   = -1;
+  r->eof  = 0;
 }
 
-/** prepend str to b */
+#ifdef STR_CONFIG_POSIX
+/** read lines from fd [no alloc] */
 STR_FUNCTION void
-str_prepend_(str *b, const str a) {
-  size_t blen = str_len(*b);
-  size_t alen = str_len(a);
-  str_fit(b, alen + blen);
-  STR_DETAIL_SHIFT_RIGHT(*b, blen, alen);
-  memcpy((*b), a, alen);
-  STR_DETAIL_SET_LEN(*b, alen + blen);
+str_reader_initfd(str_reader *r, int fd) {
+  str_reader_init(r, NULL);
+  r->fd = fd;
 }
+#endif
 
-/** overwrite chars in a string */
-STR_FUNCTION void
-str_emplace(str *s, const char *ins, size_t idx) {
-  size_t inslen = strlen(ins);
-  str_fit(s, idx + inslen);
-  memcpy(&(*s)[idx], ins, inslen);
-  if (idx + inslen > str_len(*s)) {
-    (*s)[idx + inslen] = '\0';
-    STR_DETAIL_SET_LEN(*s, idx + inslen);
+/*                                   files                                    */
+
+#ifdef STR_CONFIG_POSIX
+/** load a file (1 alloc) [null on failure; binary-safe]
+ *  allocates and reads the size reported by fstat [open, fstat, read, close];
+ *  files that are not regular (or report no size) are read until eof and
+ *  grown geometrically */
+STR_FUNCTION str
+str_read_file(const char *path) {
+  struct stat st;
+  str         s;
+  size_t      len = 0;
+  int         exact; /* a regular file is read up to its size at fstat */
+  int         fd;
+  int         err;
+  STR_DETAIL_STATS_FN(STR_STATS_READ_FILE);
+
+  do
+    fd = open(path, O_RDONLY);
+  while (fd < 0 && errno == EINTR);
+  if (fd < 0)
+    return NULL;
+  if (fstat(fd, &st) < 0)
+    goto fail_close;
+  exact = S_ISREG(st.st_mode) && st.st_size > 0;
+  STR_DETAIL_INNER(s = str_alloc(exact ? (size_t)st.st_size : 0));
+  if (s == NULL)
+    goto fail_close;
+
+  while (!exact || len < str_cap(s)) {
+    char    probe[256]; /* detects eof once the capacity is filled */
+    char   *dst  = len < str_cap(s) ? &s[len] : probe;
+    size_t  room = len < str_cap(s) ? str_cap(s) - len : sizeof(probe);
+    ssize_t rd   = read(fd, dst, room);
+    if (rd < 0) {
+      if (errno == EINTR)
+        continue;
+      goto fail_free;
+    }
+    if (rd == 0)
+      break;
+    if (dst == probe) {
+      STR_DETAIL_INNER(str_fit(&s, str_cap(s) * 2 + (size_t)rd));
+      if (!str_avail(s, len + (size_t)rd)) {
+        errno = ENOMEM;
+        goto fail_free;
+      }
+      memcpy(&s[len], probe, (size_t)rd);
+    }
+    len += (size_t)rd;
   }
+
+  close(fd);
+  s[len] = '\0';
+  STR_DETAIL_SET_LEN(s, len);
+  return s;
+
+fail_free:
+  STR_DETAIL_INNER(str_free(&s));
+fail_close:
+  err = errno;
+  close(fd);
+  errno = err;
+  return NULL;
 }
 
-/** overwrite chars in a string */
+#ifdef STR_CONFIG_IO_URING
+/* files per io_uring batch [one sqe each] */
+#  define STR_DETAIL_RING_FILES 64
+
+/* an io_uring with its mapped submission and completion rings */
+typedef struct {
+  int                  fd;
+  unsigned             tail; /* of the submission ring [sole producer] */
+  unsigned            *sq_tail;
+  unsigned            *sq_mask;
+  unsigned            *cq_head;
+  unsigned            *cq_tail;
+  unsigned            *cq_mask;
+  struct io_uring_sqe *sqes;
+  struct io_uring_cqe *cqes;
+  void                *sq_map;
+  void                *cq_map;
+  size_t               sq_size;
+  size_t               cq_size;
+  size_t               sqes_size;
+} str_detail_ring;
+
+/* unmaps the rings and closes the ring fd */
 STR_FUNCTION void
-str_emplace_(str *s, const str ins, size_t idx) {
-  size_t inslen = str_len(ins);
-  str_fit(s, idx + inslen);
-  memcpy(&(*s)[idx], ins, inslen);
-  if (idx + inslen > str_len(*s)) {
-    (*s)[idx + inslen] = '\0';
-    STR_DETAIL_SET_LEN(*s, idx + inslen);
+str_detail_ring_free(str_detail_ring *r) {
+  if (r->sqes != MAP_FAILED)
+    munmap(r->sqes, r->sqes_size);
+  if (r->cq_map != MAP_FAILED)
+    munmap(r->cq_map, r->cq_size);
+  if (r->sq_map != MAP_FAILED)
+    munmap(r->sq_map, r->sq_size);
+  close(r->fd);
+}
+
+/* sets up a ring of STR_DETAIL_RING_FILES entries [-1 on failure] */
+STR_FUNCTION int
+str_detail_ring_init(str_detail_ring *r) {
+  struct io_uring_params p;
+  unsigned              *array;
+  unsigned               i;
+  memset(&p, 0, sizeof(p));
+  r->fd = (int)syscall(__NR_io_uring_setup, STR_DETAIL_RING_FILES, &p);
+  if (r->fd < 0)
+    return -1;
+  r->sq_size   = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  r->cq_size   = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  r->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+  r->sq_map    = mmap(NULL, r->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      r->fd, IORING_OFF_SQ_RING);
+  r->cq_map    = mmap(NULL, r->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      r->fd, IORING_OFF_CQ_RING);
+  r->sqes      = (struct io_uring_sqe *)mmap(NULL, r->sqes_size,
+                                             PROT_READ | PROT_WRITE, MAP_SHARED,
+                                             r->fd, IORING_OFF_SQES);
+  if (r->sq_map == MAP_FAILED || r->cq_map == MAP_FAILED ||
+      r->sqes == MAP_FAILED) {
+    str_detail_ring_free(r);
+    return -1;
   }
+  r->sq_tail = (unsigned *)((char *)r->sq_map + p.sq_off.tail);
+  r->sq_mask = (unsigned *)((char *)r->sq_map + p.sq_off.ring_mask);
+  r->cq_head = (unsigned *)((char *)r->cq_map + p.cq_off.head);
+  r->cq_tail = (unsigned *)((char *)r->cq_map + p.cq_off.tail);
+  r->cq_mask = (unsigned *)((char *)r->cq_map + p.cq_off.ring_mask);
+  r->cqes = (struct io_uring_cqe *)((char *)r->cq_map + p.cq_off.cqes);
+  r->tail = *r->sq_tail;
+  array   = (unsigned *)((char *)r->sq_map + p.sq_off.array);
+  for (i = 0; i < p.sq_entries; ++i)
+    array[i] = i; /* the sqe of a slot is the one at its index */
+  return 0;
 }
 
-/** insert chars before s[idx] */
-STR_FUNCTION void
-str_insert(str *s, const char *ins, size_t idx) {
-  size_t slen   = str_len(*s);
-  size_t inslen = strlen(ins);
-  str_fit(s, slen + inslen);
-  STR_DETAIL_SHIFT_RIGHT(&(*s)[idx], slen - idx, inslen);
-  memcpy(&(*s)[idx], ins, inslen);
-  STR_DETAIL_SET_LEN(*s, slen + inslen);
+/* queues an sqe of op on fd, tagged with user_data u */
+STR_FUNCTION struct io_uring_sqe *
+str_detail_ring_push(str_detail_ring *r, int op, int fd, size_t u) {
+  struct io_uring_sqe *sqe = &r->sqes[r->tail++ & *r->sq_mask];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode    = (unsigned char)op;
+  sqe->fd        = fd;
+  sqe->user_data = u;
+  return sqe;
 }
 
-/** insert str before s[idx] */
-STR_FUNCTION void
-str_insert_(str *s, const str ins, size_t idx) {
-  size_t slen   = str_len(*s);
-  size_t inslen = str_len(ins);
-  str_fit(s, slen + inslen);
-  STR_DETAIL_SHIFT_RIGHT(&(*s)[idx], slen - idx, inslen);
-  memcpy(&(*s)[idx], ins, inslen);
-  STR_DETAIL_SET_LEN(*s, slen + inslen);
+/* submits the k queued sqes and waits for them; the result of the sqe
+ * tagged u is stored to res[u] [-1 on failure] */
+STR_FUNCTION int
+str_detail_ring_run(str_detail_ring *r, unsigned k, int *res) {
+  unsigned unsubmitted = k;
+  __atomic_store_n(r->sq_tail, r->tail, __ATOMIC_RELEASE);
+  while (k > 0) {
+    unsigned head = *r->cq_head;
+    if (head == __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE)) {
+      long rc = syscall(__NR_io_uring_enter, r->fd, unsubmitted, 1,
+                        IORING_ENTER_GETEVENTS, NULL, 0);
+      if (rc < 0 && errno != EINTR && errno != EAGAIN)
+        return -1;
+      if (rc > 0)
+        unsubmitted -= (unsigned)rc;
+      continue;
+    }
+    res[r->cqes[head & *r->cq_mask].user_data] =
+        r->cqes[head & *r->cq_mask].res;
+    __atomic_store_n(r->cq_head, head + 1, __ATOMIC_RELEASE);
+    --k;
+  }
+  return 0;
 }
 
-/** center pad to reach len */
-STR_FUNCTION void
-str_cpad(str *s, size_t len) {
-  size_t slen = str_len(*s);
-  if (slen < len) {
-    str_fit(s, len);
-    size_t mid = (len - slen) / 2;
-    STR_DETAIL_SHIFT_RIGHT(*s, slen, mid);
-    memset(*s, ' ', mid);
-    memset(&(*s)[mid + slen], ' ', len - mid);
-    (*s)[len] = '\0';
-    STR_DETAIL_SET_LEN(*s, len);
+/* loads the n <= STR_DETAIL_RING_FILES files of paths into out through r
+ * [-1 if the ring failed]. files that are not regular or report no size,
+ * and all of them if the kernel lacks the ring ops, use str_read_file.
+ * fstat runs on the caller: a statx op would always go to a kernel worker */
+STR_FUNCTION int
+str_detail_ring_read(str_detail_ring *r, const char *const *paths, size_t n,
+                     str *out) {
+  int      fds[STR_DETAIL_RING_FILES];
+  size_t   done[STR_DETAIL_RING_FILES];
+  int      more[STR_DETAIL_RING_FILES];
+  int      res[STR_DETAIL_RING_FILES];
+  unsigned k;
+  size_t   i;
+
+  /* open every file at once */
+  for (i = 0; i < n; ++i) {
+    struct io_uring_sqe *sqe;
+    sqe             = str_detail_ring_push(r, IORING_OP_OPENAT, AT_FDCWD, i);
+    sqe->addr       = (unsigned long)paths[i];
+    sqe->open_flags = O_RDONLY;
+  }
+  for (i = 0; i < n; ++i) {
+    fds[i] = -1;
+    out[i] = NULL;
   }
+  if (str_detail_ring_run(r, (unsigned)n, res) < 0)
+    goto fail;
+
+  /* allocate the strs at their exact sizes */
+  for (i = 0; i < n; ++i) {
+    struct stat sb;
+    fds[i]  = res[i];
+    done[i] = 0;
+    if (fds[i] >= 0 && fstat(fds[i], &sb) == 0 && S_ISREG(sb.st_mode) &&
+        sb.st_size > 0)
+      STR_DETAIL_INNER(out[i] = str_alloc((size_t)sb.st_size));
+    more[i] = out[i] != NULL;
+    if (out[i] != NULL)
+      continue;
+    if (fds[i] >= 0) {
+      close(fds[i]);
+      fds[i] = -1;
+    } else if (fds[i] != -EINVAL) {
+      errno = -fds[i];
+      continue;
+    }
+    STR_DETAIL_INNER(out[i] = str_read_file(paths[i]));
+  }
+
+  /* read until every file is filled, at eof, or failed */
+  for (;;) {
+    for (i = 0, k = 0; i < n; ++i) {
+      if (fds[i] >= 0 && more[i]) {
+        struct io_uring_sqe *sqe;
+        size_t               left = str_cap(out[i]) - done[i];
+        sqe       = str_detail_ring_push(r, IORING_OP_READ, fds[i], i);
+        sqe->addr = (unsigned long)&out[i][done[i]];
+        sqe->len  = left < (1U << 30) ? (unsigned)left : 1U << 30;
+        sqe->off  = done[i];
+        ++k;
+      }
+    }
+    if (k == 0)
+      break;
+    if (str_detail_ring_run(r, k, res) < 0)
+      goto fail;
+    for (i = 0; i < n; ++i) {
+      if (fds[i] < 0 || !more[i] || res[i] == -EINTR || res[i] == -EAGAIN)
+        continue;
+      if (res[i] > 0)
+        done[i] += (size_t)res[i];
+      if (res[i] < 0) {
+        errno = -res[i];
+        STR_DETAIL_INNER(str_free(&out[i]));
+      }
+      more[i] = res[i] > 0 && done[i] < str_cap(out[i]);
+    }
+  }
+
+  /* close the files and record the lengths */
+  for (i = 0, k = 0; i < n; ++i) {
+    if (fds[i] >= 0) {
+      str_detail_ring_push(r, IORING_OP_CLOSE, fds[i], i);
+      ++k;
+    }
+  }
+  if (k > 0 && str_detail_ring_run(r, k, res) < 0)
+    goto fail;
+  for (i = 0; i < n; ++i) {
+    if (fds[i] < 0)
+      continue;
+    if (res[i] == -EINVAL)
+      close(fds[i]); /* no close op before Linux 5.6 */
+    if (out[i] != NULL) {
+      out[i][done[i]] = '\0'; /* short if the file shrank */
+      STR_DETAIL_SET_LEN(out[i], done[i]);
+    }
+  }
+  return 0;
+
+fail:
+  for (i = 0; i < n; ++i) {
+    if (fds[i] >= 0)
+      close(fds[i]);
+    if (out[i] != NULL)
+      STR_DETAIL_INNER(str_free(&out[i]));
+  }
+  return -1;
 }
+#endif
 
-/** left pad to reach len */
-STR_FUNCTION void
-str_lpad(str *s, size_t len) {
-  size_t slen = str_len(*s);
-  if (slen < len) {
-    str_fit(s, len);
-    STR_DETAIL_SHIFT_RIGHT(*s, slen, len - slen);
-    memset(*s, ' ', len - slen);
-    STR_DETAIL_SET_LEN(*s, len);
+/** load n files into out [returns the number loaded]
+ *  out[i] is the str_read_file result for paths[i]; null on failure. with
+ *  STR_CONFIG_IO_URING, batches of files are opened, read, and closed
+ *  through an io_uring, each str allocated at the size of its file */
+STR_FUNCTION size_t
+str_read_files(const char *const *paths, size_t n, str *out) {
+  size_t i;
+  size_t loaded = 0;
+#ifdef STR_CONFIG_IO_URING
+  str_detail_ring r;
+#endif
+  STR_DETAIL_STATS_FN(STR_STATS_READ_FILES);
+  i = 0;
+#ifdef STR_CONFIG_IO_URING
+  if (n > 1 && str_detail_ring_init(&r) == 0) {
+    for (; i < n; i += STR_DETAIL_RING_FILES) {
+      size_t m = n - i < STR_DETAIL_RING_FILES ? n - i : STR_DETAIL_RING_FILES;
+      if (str_detail_ring_read(&r, &paths[i], m, &out[i]) < 0)
+        break;
+    }
+    str_detail_ring_free(&r);
   }
+#endif
+  for (; i < n; ++i)
+    STR_DETAIL_INNER(out[i] = str_read_file(paths[i]));
+  for (i = 0; i < n; ++i)
+    loaded += out[i] != NULL;
+  return loaded;
 }
 
-/** right pad to reach len */
-STR_FUNCTION void
-str_rpad(str *s, size_t len) {
-  size_t slen = str_len(*s);
-  if (slen < len) {
-    str_fit(s, len);
-    memset(&(*s)[slen], ' ', len - slen);
-    (*s)[len] = '\0';
-    STR_DETAIL_SET_LEN(*s, len);
+/** send a file to fd [no copy on linux] [-1 on failure]
+ *  uses sendfile on linux for nonempty regular files; copies the rest, and
+ *  other files [which may report a size of 0], through a stack buffer */
+STR_FUNCTION int
+str_sendfile(int fd, const char *path) {
+  struct stat st;
+  int         in;
+  int         err;
+  do
+    in = open(path, O_RDONLY);
+  while (in < 0 && errno == EINTR);
+  if (in < 0)
+    return -1;
+  if (fstat(in, &st) < 0)
+    goto fail;
+#ifdef __linux__
+  if (S_ISREG(st.st_mode) && st.st_size > 0) {
+    off_t  off = 0;
+    size_t rem = (size_t)st.st_size;
+    while (rem > 0) {
+      ssize_t w = sendfile(fd, in, &off, rem);
+      if (w < 0) {
+        if (errno == EINTR)
+          continue;
+        if (errno == EINVAL || errno == ENOSYS)
+          break; /* unsupported by fd or the kernel: copy the rest */
+        goto fail;
+      }
+      if (w == 0)
+        break; /* the file was truncated */
+      rem -= (size_t)w;
+    }
+    /* sendfile leaves the file offset; the copy below picks up at off and
+     * sends what was appended since fstat */
+    if (off > 0 && lseek(in, off, SEEK_SET) < 0)
+      goto fail;
+  }
+#endif
+  for (;;) {
+    char    buf[65536];
+    size_t  off = 0;
+    ssize_t rd  = read(in, buf, sizeof(buf));
+    if (rd < 0) {
+      if (errno == EINTR)
+        continue;
+      goto fail;
+    }
+    if (rd == 0)
+      break;
+    while (off < (size_t)rd) {
+      ssize_t w = write(fd, &buf[off], (size_t)rd - off);
+      if (w < 0) {
+        if (errno == EINTR)
+          continue;
+        goto fail;
+      }
+      if (w == 0) {
+        errno = EIO;
+        goto fail;
+      }
+      off += (size_t)w;
+    }
   }
+  return close(in);
+
+fail:
+  err = errno;
+  close(in);
+  errno = err;
+  return -1;
 }
 
-/** trim leading and trailing whitespace */
+/** store s [-1 on failure; creates or truncates path] */
+STR_FUNCTION int
+str_write_file(const char *path, const str s) {
+  size_t off  = 0;
+  size_t slen = str_len(s);
+  int    fd;
+  do
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  while (fd < 0 && errno == EINTR);
+  if (fd < 0)
+    return -1;
+  while (off < slen) {
+    ssize_t w = write(fd, &s[off], slen - off);
+    if (w <= 0) {
+      int err;
+      if (w < 0 && errno == EINTR)
+        continue;
+      err = w < 0 ? errno : EIO; /* no progress */
+      close(fd);
+      errno = err;
+      return -1;
+    }
+    off += (size_t)w;
+  }
+  return close(fd);
+}
+
+/** write n strs to fd [no concatenation] [-1 on failure]
+ *  passes up to IOV_MAX parts per writev call; resumes after partial writes */
+STR_FUNCTION int
+str_writev(int fd, const str *parts, size_t n) {
+  struct iovec iov[STR_DETAIL_IOV_MAX];
+  size_t       i   = 0; /* first unwritten part */
+  size_t       off = 0; /* written chars of parts[i] */
+  while (i < n) {
+    int     cnt = 0;
+    size_t  j;
+    ssize_t w;
+    for (j = i; j < n && cnt < STR_DETAIL_IOV_MAX; ++j) {
+      size_t o = j == i ? off : 0;
+      if (str_len(parts[j]) > o) {
+        iov[cnt].iov_base = &parts[j][o];
+        iov[cnt].iov_len  = str_len(parts[j]) - o;
+        ++cnt;
+      }
+    }
+    if (cnt == 0)
+      break;
+    w = writev(fd, iov, cnt);
+    if (w < 0) {
+      if (errno == EINTR)
+        continue;
+      return -1;
+    }
+    if (w == 0) {
+      errno = EIO; /* no progress */
+      return -1;
+    }
+    while (i < n && (size_t)w >= str_len(parts[i]) - off) {
+      w -= (ssize_t)(str_len(parts[i]) - off);
+      off = 0;
+      ++i;
+    }
+    off += (size_t)w;
+  }
+  return 0;
+}
+
+/** unmap the table */
 STR_FUNCTION void
-str_trim(str *s) {
-  size_t slen = str_len(*s);
-  size_t beg;
-  size_t end;
-  for (beg = 0; beg < slen && isspace((*s)[beg]); ++beg)
-    ;
-  for (end = slen; end > 0 && isspace((*s)[end - 1]); --end)
-    ;
+str_table_close(str_table *t) {
+  if (t->map != NULL)
+    munmap(t->map, t->msize);
+  t->map   = NULL;
+  t->msize = 0;
+  t->n     = 0;
+}
 
-  if (beg > 0)
-    STR_DETAIL_SHIFT_LEFT(&(*s)[beg], end - beg, beg);
+/** read-only str at index i [null if the entry is out of bounds or bad]
+ *  the str is valid until str_table_close; manipulators copy it first.
+ *  an entry must be marked read-only, with its cap equal to its len, and
+ *  be null terminated, so a corrupt table never yields an owned str */
+STR_FUNCTION str
+str_table_get(const str_table *t, size_t i) {
+  size_t off;
+  str    s;
+  if (i >= t->n)
+    return NULL;
+  off = ((const size_t *)t->map)[2 + i];
+  if (off % sizeof(size_t) != 0 || off < sizeof(size_t) * (2 + t->n + 2) ||
+      off >= t->msize)
+    return NULL;
+  s = (char *)t->map + off;
+  if (str_len(s) >= t->msize - off ||
+      ((const size_t *)s)[-2] != (str_len(s) | STR_DETAIL_FLAG_RO) ||
+      s[str_len(s)] != '\0')
+    return NULL;
+  return s;
+}
 
-  if (beg > 0 || end < slen) {
-    (*s)[end - beg] = '\0';
-    STR_DETAIL_SET_LEN(*s, end - beg);
+/** map a table file [-1 on failure; errno is EINVAL for a bad format] */
+STR_FUNCTION int
+str_table_open(str_table *t, const char *path) {
+  struct stat st;
+  void       *map;
+  size_t      n;
+  int         fd;
+  int         err;
+  do
+    fd = open(path, O_RDONLY);
+  while (fd < 0 && errno == EINTR);
+  if (fd < 0)
+    return -1;
+  if (fstat(fd, &st) < 0)
+    goto fail;
+  if ((size_t)st.st_size < sizeof(size_t) * 2) {
+    errno = EINVAL;
+    goto fail;
+  }
+  map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED)
+    goto fail;
+  close(fd);
+  n = ((const size_t *)map)[1];
+  if (((const size_t *)map)[0] != STR_DETAIL_TABLE_MAGIC ||
+      n > (size_t)st.st_size / sizeof(size_t) - 2) {
+    munmap(map, (size_t)st.st_size);
+    errno = EINVAL;
+    return -1;
   }
+  t->map   = map;
+  t->msize = (size_t)st.st_size;
+  t->n     = n;
+  return 0;
+
+fail:
+  err = errno;
+  close(fd);
+  errno = err;
+  return -1;
 }
+#endif
 
-/** zero len, term [no realloc] */
+/** store n strs as a table [-1 on failure; see str_table] */
+STR_FUNCTION int
+str_table_write(const char *path, const str *arr, size_t n) {
+  static const char zeros[sizeof(size_t)] = {0};
+  size_t            hdr[2];
+  size_t            off = sizeof(size_t) * (2 + n);
+  size_t            i;
+  int               ok;
+  FILE             *fp = fopen(path, "wb");
+  if (fp == NULL)
+    return -1;
+
+  hdr[0] = STR_DETAIL_TABLE_MAGIC;
+  hdr[1] = n;
+  ok     = fwrite(hdr, sizeof(size_t), 2, fp) == 2;
+  for (i = 0; ok && i < n; ++i) {
+    size_t data = off + sizeof(size_t) * 2;
+    ok          = fwrite(&data, sizeof(size_t), 1, fp) == 1;
+    off += STR_DETAIL_TABLE_ENTRY_SIZE(str_len(arr[i]));
+  }
+  for (i = 0; ok && i < n; ++i) {
+    size_t len = str_len(arr[i]);
+    size_t pad = STR_DETAIL_TABLE_ENTRY_SIZE(len) - STR_DETAIL_MEMORY_SIZE(len);
+    hdr[0]     = len | STR_DETAIL_FLAG_RO;
+    hdr[1]     = len;
+    ok         = fwrite(hdr, sizeof(size_t), 2, fp) == 2;
+    ok         = ok && fwrite(arr[i], 1, len + 1, fp) == len + 1;
+    ok         = ok && fwrite(zeros, 1, pad, fp) == pad;
+  }
+
+  if (fclose(fp) != 0)
+    ok = 0;
+  return ok ? 0 : -1;
+}
+
+/*                                 statistics                                 */
+
+#ifdef STR_CONFIG_STATS
+/** add the counters of src to dst
+ *  aggregates the snapshots of several threads [see str_stats_get] */
 STR_FUNCTION void
-str_clear(str *s) {
-  (*s)[0] = '\0';
-  STR_DETAIL_SET_LEN(*s, 0);
+str_stats_add(str_stats *dst, const str_stats *src) {
+  size_t i;
+  for (i = 0; i < STR_STATS_FNS; ++i) {
+    str_stats_entry       *d = &dst->fn[i];
+    const str_stats_entry *e = &src->fn[i];
+    d->allocs += e->allocs;
+    d->frees += e->frees;
+    d->reallocs += e->reallocs;
+    d->bytes_allocated += e->bytes_allocated;
+    d->bytes_copied += e->bytes_copied;
+    d->bytes_shifted += e->bytes_shifted;
+    d->slack += e->slack;
+  }
+  dst->live_slack += src->live_slack;
 }
 
-/** resize if capacity < min_cap */
+/** append as csv [one row per function with nonzero counters, then total]
+ *  the header row names the columns: fn, allocs, frees, reallocs,
+ *  bytes_allocated, bytes_copied, bytes_shifted, slack; functions are named
+ *  without the namespace prefix. a last row named live has only the
+ *  live_slack in the slack column. the appends are counted as str_append */
 STR_FUNCTION void
-str_fit(str *a, size_t min_cap) {
-  if (str_cap(*a) < min_cap)
-    str_realloc(a, min_cap);
+str_stats_format(str *s, const str_stats *st) {
+  static const char *const names[STR_STATS_FNS] = {
+      "alloc",
+      "dup",
+      "new",
+      "sub",
+      "append_base64",
+      "append_csv_field",
+      "append_hex",
+      "append_json_escaped",
+      "append_unbase64",
+      "append_uncsv",
+      "append_unhex",
+      "append_unjson",
+      "append_unurl",
+      "append_url_encoded",
+      "to_double",
+      "append",
+      "append_",
+      "append_n",
+      "prepend",
+      "prepend_",
+      "emplace",
+      "emplace_",
+      "erase",
+      "insert",
+      "insert_",
+      "splice",
+      "substr",
+      "cpylower",
+      "cpylower_",
+      "cpyupper",
+      "cpyupper_",
+      "tolower",
+      "toupper",
+      "cpadf",
+      "lpadf",
+      "rpadf",
+      "trim",
+      "clear",
+      "fit",
+      "grow",
+      "realloc",
+      "shrink",
+      "shrinkfit",
+      "edit_begin",
+      "edit_commit",
+      "edit_insert",
+      "edit_insert_",
+      "edit_seek",
+      "builder_append",
+      "builder_append_",
+      "builder_finish",
+      "builder_free",
+      "builder_reserve",
+      "vec_free",
+      "vec_get_str",
+      "vec_pop",
+      "vec_push",
+      "vec_push_",
+      "vec_split",
+      "getline",
+      "getline_view",
+      "reader_free",
+      "read_file",
+      "read_files",
+      "free"};
+  str_stats_entry total;
+  char            row[256]; /* a name and 7 counters of at most 20 digits */
+  size_t          i;
+  memset(&total, 0, sizeof(total));
+  str_append(s, "fn,allocs,frees,reallocs,bytes_allocated,bytes_copied,"
+                "bytes_shifted,slack\n");
+  for (i = 0; i <= STR_STATS_FNS; ++i) {
+    const str_stats_entry *e = i < STR_STATS_FNS ? &st->fn[i] : &total;
+    if (i < STR_STATS_FNS) {
+      if (e->allocs == 0 && e->frees == 0 && e->bytes_shifted == 0 &&
+          e->slack == 0)
+        continue; /* reallocs and copies imply an alloc */
+      total.allocs += e->allocs;
+      total.frees += e->frees;
+      total.reallocs += e->reallocs;
+      total.bytes_allocated += e->bytes_allocated;
+      total.bytes_copied += e->bytes_copied;
+      total.bytes_shifted += e->bytes_shifted;
+      total.slack += e->slack;
+    }
+    sprintf(row, "%s,%lu,%lu,%lu,%lu,%lu,%lu,%ld\n",
+            i < STR_STATS_FNS ? names[i] : "total", (unsigned long)e->allocs,
+            (unsigned long)e->frees, (unsigned long)e->reallocs,
+            (unsigned long)e->bytes_allocated, (unsigned long)e->bytes_copied,
+            (unsigned long)e->bytes_shifted, (long)e->slack);
+    str_append(s, row);
+  }
+  sprintf(row, "live,,,,,,,%ld\n", (long)st->live_slack);
+  str_append(s, row);
 }
 
-/** grow string capacity by delta */
+/** counters of the calling thread
+ *  copies the counters accumulated by this thread since the last reset, and
+ *  the live slack of the thread */
 STR_FUNCTION void
-str_grow(str *s, size_t delta) {
-  str_realloc(s, str_cap(*s) + delta);
+str_stats_get(str_stats *out) {
+  *out = str_detail_stats;
 }
 
-/** resize string [reallocates and null terminates] */
+/** zero the counters of the calling thread [keeps the live slack] */
 STR_FUNCTION void
-str_realloc(str *s, size_t cap) {
-  void *v = STR_CONFIG_MALLOC(STR_DETAIL_MEMORY_SIZE(cap));
+str_stats_reset(void) {
+  ptrdiff_t live = str_detail_stats.live_slack;
+  memset(&str_detail_stats, 0, sizeof(str_detail_stats));
+  str_detail_stats.live_slack = live;
+}
+#endif
 
-  if (v == NULL)
+#ifdef STR_CONFIG_TRACE
+/* encodes a record as its fn byte followed by id, to ^ id, cap, and len in
+ * little-endian base 128 [a len event is then a few bytes long] */
+STR_FUNCTION void
+str_detail_trace(const char *id, const char *to, size_t cap, size_t len) {
+  size_t         v[4];
+  unsigned char *p;
+  int            i;
+  if (str_detail_trace_fp == NULL)
     return;
+  if (STR_CONFIG_TRACE_BUFFER - str_detail_trace_n <
+      STR_DETAIL_TRACE_RECORD_MAX) {
+    fwrite(str_detail_trace_buf, 1, str_detail_trace_n, str_detail_trace_fp);
+    str_detail_trace_n = 0;
+  }
+  v[0] = (size_t)id;
+  v[1] = (size_t)to ^ (size_t)id;
+  v[2] = cap;
+  v[3] = len;
+  p    = str_detail_trace_buf + str_detail_trace_n;
+  *p++ = (unsigned char)str_detail_stats_fn;
+  for (i = 0; i < 4; ++i) {
+    for (; v[i] >= 0x80; v[i] >>= 7)
+      *p++ = (unsigned char)(v[i] | 0x80);
+    *p++ = (unsigned char)v[i];
+  }
+  str_detail_trace_n = (size_t)(p - str_detail_trace_buf);
+}
 
-  memcpy(v, str_mbegin(*s), STR_DETAIL_MEMORY_SIZE(cap));
-  str_free(s);
-
-  *s = str_mstr(v);
-  STR_DETAIL_SET_CAP(*s, cap);
-
-  if (cap < str_len(*s)) {
-    (*s)[cap] = '\0';
-    STR_DETAIL_SET_LEN(*s, cap);
+/** read the next record of a trace
+ *  returns 1 if a record was read, and 0 at the end of the file or of a
+ *  truncated record */
+STR_FUNCTION int
+str_trace_read(FILE *fp, str_trace_record *r) {
+  size_t   v[4];
+  unsigned shift;
+  int      c;
+  int      i;
+  if ((c = getc(fp)) == EOF)
+    return 0;
+  r->fn = c;
+  for (i = 0; i < 4; ++i) {
+    v[i] = 0;
+    for (shift = 0;; shift += 7) {
+      if (shift >= sizeof(size_t) * CHAR_BIT || (c = getc(fp)) == EOF)
+        return 0;
+      v[i] |= (size_t)(c & 0x7f) << shift;
+      if (c < 0x80)
+        break;
+    }
   }
+  r->id  = v[0];
+  r->to  = v[1] ^ v[0];
+  r->cap = v[2];
+  r->len = v[3];
+  return 1;
 }
 
-/** shrink cap [null if needed] */
+/** record the block events of the calling thread to fp
+ *  stops a previous recording first; records are buffered per thread and
+ *  written by str_trace_stop at the latest. the file is not closed */
 STR_FUNCTION void
-str_shrink(str *s, size_t delta) {
-  str_realloc(s, str_cap(*s) - delta);
+str_trace_start(FILE *fp) {
+  str_trace_stop();
+  str_detail_trace_fp = fp;
 }
 
-/** shrink to len if cap > len */
+/** write the pending records and stop recording */
 STR_FUNCTION void
-str_shrinkfit(str *s) {
-  size_t slen = str_len(*s);
-  if (slen < str_cap(*s))
-    str_realloc(s, slen);
+str_trace_stop(void) {
+  if (str_detail_trace_fp != NULL)
+    fwrite(str_detail_trace_buf, 1, str_detail_trace_n, str_detail_trace_fp);
+  str_detail_trace_fp = NULL;
+  str_detail_trace_n  = 0;
 }
+#endif
 
 /*                                destruction                                 */
 
-/** free owned string, nullify ptr */
+/** free owned string, nullify ptr [read-only strs are not freed] */
 STR_FUNCTION void
 str_free(str *s) {
-  STR_CONFIG_FREE(str_mbegin(*s));
+  STR_DETAIL_STATS_FN(STR_STATS_FREE);
+  if (!STR_DETAIL_IS_RO(*s)) {
+    STR_DETAIL_STATS_SLACK(-(ptrdiff_t)(str_cap(*s) - str_len(*s)));
+    STR_DETAIL_TRACE(*s, NULL, str_cap(*s), str_len(*s));
+    STR_DETAIL_FREE_BLOCK(*s);
+  }
   *s = NULL;
 }
 
@@ -657,28 +4805,74 @@ str_free(str *s) {
 #ifdef STR_DETAIL_USING_CUSTOM_NAMESPACE
 #  undef str
 #  undef str_alloc
+#  undef str_alloc_aligned
 #  undef str_dup
 #  undef str_new
 #  undef str_sub
 #  undef str_avail
 #  undef str_cap
 #  undef str_end
+#  undef str_islower
+#  undef str_isupper
 #  undef str_len
 #  undef str_mbegin
 #  undef str_mend
 #  undef str_msize
 #  undef str_mstr
+#  undef str_casecmp
+#  undef str_casecmp_
+#  undef str_caseeq
+#  undef str_caseeq_
+#  undef str_cmp
+#  undef str_cmp_
+#  undef str_ends_with
+#  undef str_ends_with_
+#  undef str_eq
+#  undef str_eq_
+#  undef str_starts_with
+#  undef str_starts_with_
+#  undef str_utf8_len
+#  undef str_utf8_valid
+#  undef str_append_base64
+#  undef str_append_csv_field
+#  undef str_append_hex
+#  undef str_append_json_escaped
+#  undef str_append_unbase64
+#  undef str_append_uncsv
+#  undef str_append_unhex
+#  undef str_append_unjson
+#  undef str_append_unurl
+#  undef str_append_url_encoded
+#  undef str_to_double
+#  undef str_to_double_
+#  undef str_to_long
+#  undef str_to_long_
+#  undef str_to_ulong
+#  undef str_to_ulong_
 #  undef str_append
 #  undef str_append_
+#  undef str_append_n
 #  undef str_prepend
 #  undef str_prepend_
 #  undef str_emplace
 #  undef str_emplace_
+#  undef str_erase
 #  undef str_insert
 #  undef str_insert_
+#  undef str_splice
+#  undef str_substr
+#  undef str_cpylower
+#  undef str_cpylower_
+#  undef str_cpyupper
+#  undef str_cpyupper_
+#  undef str_tolower
+#  undef str_toupper
 #  undef str_cpad
+#  undef str_cpadf
 #  undef str_lpad
+#  undef str_lpadf
 #  undef str_rpad
+#  undef str_rpadf
 #  undef str_trim
 #  undef str_clear
 #  undef str_fit
@@ -686,6 +4880,60 @@ str_free(str *s) {
 #  undef str_realloc
 #  undef str_shrink
 #  undef str_shrinkfit
+#  undef str_edit
+#  undef str_edit_begin
+#  undef str_edit_commit
+#  undef str_edit_erase
+#  undef str_edit_insert
+#  undef str_edit_insert_
+#  undef str_edit_len
+#  undef str_edit_seek
+#  undef str_builder
+#  undef str_builder_append
+#  undef str_builder_append_
+#  undef str_builder_finish
+#  undef str_builder_free
+#  undef str_builder_init
+#  undef str_builder_len
+#  undef str_builder_reserve
+#  undef str_builder_writev
+#  undef str_vec
+#  undef str_vec_free
+#  undef str_vec_get
+#  undef str_vec_get_str
+#  undef str_vec_init
+#  undef str_vec_len
+#  undef str_vec_pop
+#  undef str_vec_push
+#  undef str_vec_push_
+#  undef str_vec_split
+#  undef str_sort
+#  undef str_getline
+#  undef str_getline_view
+#  undef str_reader
+#  undef str_reader_free
+#  undef str_reader_init
+#  undef str_reader_initfd
+#  undef str_read_file
+#  undef str_read_files
+#  undef str_sendfile
+#  undef str_write_file
+#  undef str_writev
+#  undef str_table
+#  undef str_table_close
+#  undef str_table_get
+#  undef str_table_open
+#  undef str_table_write
+#  undef str_stats
+#  undef str_stats_add
+#  undef str_stats_entry
+#  undef str_stats_format
+#  undef str_stats_get
+#  undef str_stats_reset
+#  undef str_trace_read
+#  undef str_trace_record
+#  undef str_trace_start
+#  undef str_trace_stop
 #  undef str_free
 #endif
 
@@ -707,11 +4955,89 @@ str_free(str *s) {
 #  undef STR_CONFIG_FREE
 #endif
 
+#ifdef   STR_DETAIL_USING_CUSTOM_BUILDER_SEGMENT
+#  undef STR_DETAIL_USING_CUSTOM_BUILDER_SEGMENT
+#else
+#  undef STR_CONFIG_BUILDER_SEGMENT
+#endif
+
+#ifdef   STR_DETAIL_USING_CUSTOM_READER_BUFFER
+#  undef STR_DETAIL_USING_CUSTOM_READER_BUFFER
+#else
+#  undef STR_CONFIG_READER_BUFFER
+#endif
+
+#ifdef   STR_DETAIL_USING_CUSTOM_TRACE_BUFFER
+#  undef STR_DETAIL_USING_CUSTOM_TRACE_BUFFER
+#else
+#  undef STR_CONFIG_TRACE_BUFFER
+#endif
+
 #undef STR_DETAIL_MEMORY_SIZE
+#undef STR_DETAIL_ALLOC_SIZE
 #undef STR_DETAIL_SHIFT_RIGHT
 #undef STR_DETAIL_SHIFT_LEFT
 #undef STR_DETAIL_SET_LEN
+#undef STR_DETAIL_INIT_LEN
 #undef STR_DETAIL_SET_CAP
+#undef STR_DETAIL_FLAG_RO
+#undef STR_DETAIL_FLAG_ASCII
+#undef STR_DETAIL_FLAG_UTF8
+#undef STR_DETAIL_FLAGS
+#undef STR_DETAIL_DROP_CACHE
+#undef STR_DETAIL_IS_RO
+#undef STR_DETAIL_THREAD_LOCAL
+#undef STR_DETAIL_STATS_FN
+#undef STR_DETAIL_INNER
+#undef STR_DETAIL_STATS_ADD
+#undef STR_DETAIL_STATS_SLACK
+#undef STR_DETAIL_STATS_LEN
+#undef STR_DETAIL_TRACE_RECORD_MAX
+#undef STR_DETAIL_TRACE
+#undef STR_DETAIL_MALLOC
+#undef STR_DETAIL_FREE
+#undef STR_DETAIL_IS_MAPPED
+#undef STR_DETAIL_ALLOC_BLOCK
+#undef STR_DETAIL_FREE_BLOCK
+#undef STR_DETAIL_MADVISE
+#undef STR_DETAIL_OWN
+#undef STR_DETAIL_TABLE_MAGIC
+#undef STR_DETAIL_TABLE_ENTRY_SIZE
+#undef STR_DETAIL_RING_FILES
+#undef STR_DETAIL_EDIT_RESERVE
+#undef STR_DETAIL_VEC_RESERVE
+#undef STR_DETAIL_FOLD
+#undef STR_DETAIL_SCAN_BLOCK
+#undef STR_DETAIL_SCAN_PROBE
+#undef STR_DETAIL_CASE_MISMATCH
+#undef STR_DETAIL_CASE_MISMATCH_STR
+#undef STR_DETAIL_UNFOLD
+#undef STR_DETAIL_IS_UPPER
+#undef STR_DETAIL_IS_LOWER
+#undef STR_DETAIL_FIND
+#undef STR_DETAIL_FIND_STR
+#undef STR_DETAIL_PAD_BYTES
+#undef STR_DETAIL_PATTERN_FILL
+#undef STR_DETAIL_PAD
+#undef STR_DETAIL_HEX_VAL
+#undef STR_DETAIL_HEX4
+#undef STR_DETAIL_JSON_ESC
+#undef STR_DETAIL_CSV_ESC
+#undef STR_DETAIL_URL_ESC
+#undef STR_DETAIL_SWAR_DIGITS
+#undef STR_DETAIL_BYTES
+#undef STR_DETAIL_LOAD_DIGITS
+#undef STR_DETAIL_ALL_DIGITS
+#undef STR_DETAIL_DIGITS_VALUE
+#undef STR_DETAIL_SKIP_DIGITS
+#undef STR_DETAIL_ACC_DIGITS
+#undef STR_DETAIL_EXACT_DOUBLE
+#undef STR_DETAIL_SORT_KEY
+#undef STR_DETAIL_SORT_MIN
+#undef STR_DETAIL_SORT_STACK
+#undef STR_DETAIL_SORT_SWAP
+#undef STR_DETAIL_IOV_MAX
+#undef STR_DETAIL_BUILDER_COPY
 /*                                                     */ /* clang-format on  */
 
 #ifdef __cplusplus
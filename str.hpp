@@ -0,0 +1,849 @@
+#ifndef STR_STR_HPP_INCLUDED
+#define STR_STR_HPP_INCLUDED
+/* /////////////////////////////////////////////////////////////////////////////
+//                ___
+//              ,--.'|_            str: C string management header [1.0.0]
+//              |  | :,'   __  ,-. Copyright (C) 2020 Justin Collier
+//    .--.--.   :  : ' : ,' ,'/ /|
+//   /  /    '.;__,'  /  '  | |' | - - - - - - - - - - - - - - - - - - -
+//  |  :  /`./|  |   |   |  |   ,'
+//  |  :  ;_  :__,'| :   '  :  /   This program is free software: you can
+//   \  \    `. '  : |__ |  | '    redistribute it and/or modify it under the
+//    `----.   \|  | '.'|;  : |    terms of the GNU General Public License
+//   /  /`--'  /;  :    ;|  , ;    as published by the Free Software Foundation,
+//  '--'.     / |  ,   /  ---'     either version 3 of the License, or (at your
+//    `--'---'   ---`-'            option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the internalied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//                                                                             /
+//  You should have received a copy of the GNU General Public License         //
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.   ///
+///////////////////////////////////////////////////////////////////////////// */
+
+/*
+                                    Synopsis
+                                    --------
+
+note: C++11; the std::string_view conversions require C++17
+
+strpp::string owns a str and frees it on destruction. the null str is its
+empty state [default constructed and moved from]; allocation failures throw
+std::bad_alloc
+
+ - - -                        ~ ~ construction ~ ~                        - - -
+
+string ()                                       : empty [no alloc]
+string (const char *s)                          : str_new [1 alloc]
+string (const char *s, size_type n)             : str_sub [1 alloc]
+explicit string (std::string_view v)            : str_sub of v [1 alloc]
+string (const concat<L, R> &e)                  : materialize e [1 alloc]
+string (const string &o)                        : str_dup [1 alloc if o is not
+                                                  empty]
+string (string &&o)             noexcept        : take o's str [no alloc]
+string & operator= (const string &o)            : str_dup [1 alloc if o is not
+                                                  empty]
+string & operator= (string &&o) noexcept        : free, take o's str [no alloc]
+static string adopt (str s)     noexcept        : own an existing str
+str      release ()             noexcept        : give up the str [may be null]
+void     swap (string &o)       noexcept        : exchange strs [no alloc]
+
+ - - -                         ~ ~ properties ~ ~                         - - -
+
+size_type    capacity () const  noexcept        : str_cap [0 if empty]
+const char * c_str () const     noexcept        : the chars ["" if empty]
+const char * data () const      noexcept        : the chars ["" if empty]
+bool         empty () const     noexcept        : true if size is 0
+str          get () const       noexcept        : the str [may be null]
+size_type    size () const      noexcept        : str_len [0 if empty]
+operator     std::string_view () const noexcept : view of the chars [no copy]
+
+// access //
+char &       operator[] (size_type i) noexcept  : s[i] [i < size]
+char *       begin (), end ()   noexcept        : the chars
+const char * begin (), end () const noexcept
+
+ - - -                         ~ ~ comparison ~ ~                         - - -
+
+int      compare (const string &a,              : order by bytes, then length
+                  const string &b) noexcept
+bool     operator==, !=, <, <=, >, >=           : compare a and b
+         (const string &a, const string &b)
+         noexcept
+bool     operator==, !=                         : equal to a c string
+         (const string &a, const char *b)         [either order]
+         noexcept
+void     swap (string &a, string &b) noexcept   : exchange strs [no alloc]
+
+ - - -                       ~ ~ concatenation ~ ~                        - - -
+
+a + b builds a lazy concat that refers to its operands; converting it to a
+string or appending it measures every part, allocates once, and copies each
+part once. one operand of + must be a string, a ref, or a concat; the other
+may also be a char *, a char array, a std::string, a std::string_view, a
+char, or an integer [written in decimal]. a char * is measured with strlen
+
+concat<L, R>  operator+ (const A &a,            : lazy a + b [no alloc]
+                         const B &b) noexcept
+detail::piece ref (const str s) noexcept        : a str operand measured with
+                                                  str_len [null is ""]
+
+ - - -                          ~ ~ literals ~ ~                          - - -
+
+a literal<N> is a read-only str block [cap, len, chars, \0]; as a constexpr
+object it is a static constant that needs no allocation or strlen. its str
+can be passed to any str function: manipulators copy it first and str_free
+only nullifies the pointer. it is also a concatenation operand
+
+constexpr literal<N> lit (const char (&s)[N])   : block holding s [no alloc;
+                          noexcept                length N - 1]
+str      literal<N>::get () const noexcept      : the read-only str
+
+ - - -                        ~ ~ manipulation ~ ~                        - - -
+
+string & operator+= (const string &o)           : str_append_ [<= 1 alloc;
+                                                  2 if o is *this]
+string & operator+= (const char *s)             : str_append [<= 1 alloc;
+                                                  2 if s points into *this]
+string & operator+= (const concat<L, R> &e)     : str_append_n of each part
+                                                  [<= 1 alloc; 2 if a part
+                                                  points into *this]
+void     clear ()                noexcept       : str_clear [no realloc]
+void     reserve (size_type n)                  : str_fit [<= 1 alloc]
+void     shrink_to_fit ()                       : str_shrinkfit [<= 1 alloc]
+
+*/
+
+#include "str.h"
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#if defined _MSVC_LANG && _MSVC_LANG > __cplusplus
+#  define STR_HPP_CPLUSPLUS _MSVC_LANG
+#else
+#  define STR_HPP_CPLUSPLUS __cplusplus
+#endif
+
+#if STR_HPP_CPLUSPLUS < 201103L
+#  error "str.hpp requires C++11"
+#endif
+
+#if STR_HPP_CPLUSPLUS >= 201703L
+#  include <string_view>
+#  define STR_HPP_STRING_VIEW
+#endif
+
+/** temporary definitions for project readability; undefined at end of file
+ *  [str.h keeps STR_CONFIG_NAMESPACE defined only if it is customized] */
+#ifdef STR_CONFIG_NAMESPACE
+#  define STR_HPP_CAT(a, b)   STR_HPP_CAT_X(a, b)
+#  define STR_HPP_CAT_X(a, b) a##b
+#  define STR_HPP_NS_FN(name) \
+    STR_HPP_CAT(STR_CONFIG_NAMESPACE, STR_HPP_CAT(_, name))
+#  define str           STR_CONFIG_NAMESPACE
+#  define str_alloc     STR_HPP_NS_FN(alloc)
+#  define str_dup       STR_HPP_NS_FN(dup)
+#  define str_new       STR_HPP_NS_FN(new)
+#  define str_sub       STR_HPP_NS_FN(sub)
+#  define str_cap       STR_HPP_NS_FN(cap)
+#  define str_len       STR_HPP_NS_FN(len)
+#  define str_append    STR_HPP_NS_FN(append)
+#  define str_append_   STR_HPP_NS_FN(append_)
+#  define str_append_n  STR_HPP_NS_FN(append_n)
+#  define str_clear     STR_HPP_NS_FN(clear)
+#  define str_fit       STR_HPP_NS_FN(fit)
+#  define str_shrinkfit STR_HPP_NS_FN(shrinkfit)
+#  define str_free      STR_HPP_NS_FN(free)
+#endif
+
+namespace strpp {
+
+template <class L, class R>
+struct concat;
+
+namespace detail {
+
+/* the parts of a concatenation; each appends itself with one memcpy */
+
+/** n chars at p [refers to the operand] */
+struct piece {
+  const char *p;
+  std::size_t n;
+
+  std::size_t
+  size() const noexcept {
+    return n;
+  }
+
+  void
+  write(str *s) const noexcept {
+    str_append_n(s, p, n);
+  }
+
+  /** true if the chars overlap [b, e) */
+  bool
+  overlaps(const char *b, const char *e) const noexcept {
+    return n != 0 && std::less<const char *>()(p, e) &&
+           std::less<const char *>()(b, p + n);
+  }
+};
+
+/** a char */
+struct character {
+  char c;
+
+  std::size_t
+  size() const noexcept {
+    return 1;
+  }
+
+  void
+  write(str *s) const noexcept {
+    str_append_n(s, &c, 1);
+  }
+
+  bool
+  overlaps(const char *, const char *) const noexcept {
+    return false;
+  }
+};
+
+template <class T>
+constexpr bool
+is_negative(T v, std::true_type) noexcept {
+  return v < 0;
+}
+
+template <class T>
+constexpr bool
+is_negative(T, std::false_type) noexcept {
+  return false;
+}
+
+/** an integer in decimal [formatted when the expression is built] */
+struct number {
+  char        buf[3 * sizeof(unsigned long long) + 1];
+  std::size_t off;
+
+  template <class T>
+  explicit number(T v) noexcept : off(sizeof(buf)) {
+    bool neg = is_negative(v, std::is_signed<T>());
+    unsigned long long u =
+        neg ? 0 - (unsigned long long)v : (unsigned long long)v;
+    do {
+      buf[--off] = (char)('0' + u % 10);
+      u /= 10;
+    } while (u != 0);
+    if (neg)
+      buf[--off] = '-';
+  }
+
+  std::size_t
+  size() const noexcept {
+    return sizeof(buf) - off;
+  }
+
+  void
+  write(str *s) const noexcept {
+    str_append_n(s, buf + off, size());
+  }
+
+  bool
+  overlaps(const char *, const char *) const noexcept {
+    return false;
+  }
+};
+
+/** maps an operand type to its part [no type if T is not an operand] */
+template <class T, class = void>
+struct operand {};
+
+template <>
+struct operand<const char *> {
+  typedef piece type;
+  static piece
+  make(const char *p) noexcept {
+    return piece{p, std::strlen(p)};
+  }
+};
+
+template <>
+struct operand<char *> : operand<const char *> {};
+
+/* arrays stop at their first null char [folded for literals] */
+template <std::size_t N>
+struct operand<char[N]> {
+  typedef piece type;
+  static piece
+  make(const char (&a)[N]) noexcept {
+    const void *z = std::memchr(a, '\0', N);
+    return piece{a, z == nullptr ? N : (std::size_t)((const char *)z - a)};
+  }
+};
+
+template <>
+struct operand<std::string> {
+  typedef piece type;
+  static piece
+  make(const std::string &s) noexcept {
+    return piece{s.data(), s.size()};
+  }
+};
+
+#ifdef STR_HPP_STRING_VIEW
+template <>
+struct operand<std::string_view> {
+  typedef piece type;
+  static piece
+  make(std::string_view v) noexcept {
+    return piece{v.data(), v.size()};
+  }
+};
+#endif
+
+template <>
+struct operand<char> {
+  typedef character type;
+  static character
+  make(char c) noexcept {
+    return character{c};
+  }
+};
+
+template <class T>
+struct operand<
+    T, typename std::enable_if<std::is_integral<T>::value &&
+                               !std::is_same<T, bool>::value &&
+                               !std::is_same<T, char>::value>::type> {
+  typedef number type;
+  static number
+  make(T v) noexcept {
+    return number(v);
+  }
+};
+
+template <>
+struct operand<piece> {
+  typedef piece type;
+  static piece
+  make(const piece &p) noexcept {
+    return p;
+  }
+};
+
+template <class L, class R>
+struct operand<concat<L, R> > {
+  typedef concat<L, R> type;
+  static const concat<L, R> &
+  make(const concat<L, R> &e) noexcept {
+    return e;
+  }
+};
+
+/** true for the operands that start a concatenation */
+template <class T>
+struct is_lazy : std::false_type {};
+
+template <>
+struct is_lazy<piece> : std::true_type {};
+
+template <class L, class R>
+struct is_lazy<concat<L, R> > : std::true_type {};
+
+} // namespace detail
+
+/** a lazy concatenation [see operator+]
+ *  refers to its string operands; materialize it within the full expression
+ *  that built it, by constructing, assigning, or appending to a string */
+template <class L, class R>
+struct concat {
+  L l;
+  R r;
+
+  /** the total length [constant parts fold at compile time] */
+  std::size_t
+  size() const noexcept {
+    return l.size() + r.size();
+  }
+
+  /** appends each part [no alloc if *s has room] */
+  void
+  write(str *s) const noexcept {
+    l.write(s);
+    r.write(s);
+  }
+
+  /** true if a part overlaps [b, e) */
+  bool
+  overlaps(const char *b, const char *e) const noexcept {
+    return l.overlaps(b, e) || r.overlaps(b, e);
+  }
+};
+
+/** an operand that reads the length of a str instead of searching for its
+ *  null char [a str is also accepted as a char *] */
+inline detail::piece
+ref(const str s) noexcept {
+  return s == nullptr ? detail::piece{"", 0} : detail::piece{s, str_len(s)};
+}
+
+/*                                  literals                                  */
+
+/** a read-only str block holding a string literal [see lit]
+ *  laid out as [cap, len, chars, \0] with the read-only flag in cap */
+template <std::size_t N>
+struct literal {
+  std::size_t cap;
+  std::size_t len;
+  char        chars[N];
+
+  /** the str [manipulators copy it first; str_free only nullifies it] */
+  str
+  get() const noexcept {
+    return const_cast<char *>(chars);
+  }
+};
+
+static_assert(offsetof(literal<1>, chars) == 2 * sizeof(std::size_t),
+              "a literal must be laid out as a str block");
+
+namespace detail {
+
+/** the indices [0, sizeof...(I)) [make_indices<N> recurses log N deep] */
+template <std::size_t... I>
+struct indices {};
+
+template <class A, class B>
+struct join_indices;
+
+template <std::size_t... I, std::size_t... J>
+struct join_indices<indices<I...>, indices<J...> > {
+  typedef indices<I..., (sizeof...(I) + J)...> type;
+};
+
+template <std::size_t N>
+struct make_indices
+    : join_indices<typename make_indices<N / 2>::type,
+                   typename make_indices<N - N / 2>::type> {};
+
+template <>
+struct make_indices<0> {
+  typedef indices<> type;
+};
+
+template <>
+struct make_indices<1> {
+  typedef indices<0> type;
+};
+
+template <std::size_t N, std::size_t... I>
+constexpr literal<N>
+make_literal(const char (&s)[N], indices<I...>) noexcept {
+  return literal<N>{(N - 1) | ~(~std::size_t(0) >> 1), N - 1, {s[I]...}};
+}
+
+template <std::size_t N>
+struct operand<literal<N> > {
+  typedef piece type;
+  static piece
+  make(const literal<N> &l) noexcept {
+    return piece{l.chars, l.len};
+  }
+};
+
+} // namespace detail
+
+/** the string literal s as a read-only str block [no alloc; length N - 1]
+ *  a constexpr literal is a static constant:
+ *    static constexpr auto sep = strpp::lit(", ");
+ *    str_append_(&s, sep.get()); */
+template <std::size_t N>
+constexpr literal<N>
+lit(const char (&s)[N]) noexcept {
+  return detail::make_literal(s, typename detail::make_indices<N>::type());
+}
+
+/** an owning str
+ *  moves exchange pointers and never allocate; copies call str_dup */
+class string {
+public:
+  typedef std::size_t size_type;
+
+  /*                              construction                              */
+
+  /** empty [no alloc] */
+  string() noexcept : s_(nullptr) {
+  }
+
+  /** str_new [1 alloc] */
+  string(const char *s) : s_(check(str_new(s))) {
+  }
+
+  /** str_sub [1 alloc; stops at a null char] */
+  string(const char *s, size_type n) : s_(check(str_sub(s, n))) {
+  }
+
+#ifdef STR_HPP_STRING_VIEW
+  /** str_sub of v [1 alloc; stops at a null char] */
+  explicit string(std::string_view v) : string(v.data(), v.size()) {
+  }
+#endif
+
+  /** materialize a concatenation [1 alloc; 1 memcpy per part] */
+  template <class L, class R>
+  string(const concat<L, R> &e) : s_(check(str_alloc(e.size()))) {
+    e.write(&s_);
+  }
+
+  /** str_dup [1 alloc if o is not empty; the copy has o's capacity] */
+  string(const string &o)
+      : s_(o.s_ == nullptr ? nullptr : check(str_dup(o.s_))) {
+  }
+
+  /** take o's str [no alloc] */
+  string(string &&o) noexcept : s_(o.s_) {
+    o.s_ = nullptr;
+  }
+
+  ~string() {
+    if (s_ != nullptr)
+      str_free(&s_);
+  }
+
+  /** str_dup [1 alloc if o is not empty] */
+  string &
+  operator=(const string &o) {
+    string(o).swap(*this);
+    return *this;
+  }
+
+  /** free, take o's str [no alloc] */
+  string &
+  operator=(string &&o) noexcept {
+    string(std::move(o)).swap(*this);
+    return *this;
+  }
+
+  /** own an existing str [may be null; a read-only str is never freed] */
+  static string
+  adopt(str s) noexcept {
+    string r;
+    r.s_ = s;
+    return r;
+  }
+
+  /** give up the str [may be null; the caller frees it] */
+  str
+  release() noexcept {
+    str s = s_;
+    s_    = nullptr;
+    return s;
+  }
+
+  /** exchange strs [no alloc] */
+  void
+  swap(string &o) noexcept {
+    str s = s_;
+    s_    = o.s_;
+    o.s_  = s;
+  }
+
+  /*                               properties                               */
+
+  /** str_cap [0 if empty] */
+  size_type
+  capacity() const noexcept {
+    return s_ == nullptr ? 0 : str_cap(s_);
+  }
+
+  /** the chars ["" if empty] */
+  const char *
+  c_str() const noexcept {
+    return s_ == nullptr ? "" : s_;
+  }
+
+  /** the chars ["" if empty] */
+  const char *
+  data() const noexcept {
+    return c_str();
+  }
+
+  /** true if size is 0 */
+  bool
+  empty() const noexcept {
+    return size() == 0;
+  }
+
+  /** the str [may be null] */
+  str
+  get() const noexcept {
+    return s_;
+  }
+
+  /** str_len [0 if empty] */
+  size_type
+  size() const noexcept {
+    return s_ == nullptr ? 0 : str_len(s_);
+  }
+
+#ifdef STR_HPP_STRING_VIEW
+  /** view of the chars [no copy] */
+  operator std::string_view() const noexcept {
+    return std::string_view(c_str(), size());
+  }
+#endif
+
+  /** s[i] [i < size] */
+  char &
+  operator[](size_type i) noexcept {
+    return s_[i];
+  }
+
+  const char &
+  operator[](size_type i) const noexcept {
+    return s_[i];
+  }
+
+  char *
+  begin() noexcept {
+    return s_;
+  }
+
+  char *
+  end() noexcept {
+    return s_ + size();
+  }
+
+  const char *
+  begin() const noexcept {
+    return c_str();
+  }
+
+  const char *
+  end() const noexcept {
+    return c_str() + size();
+  }
+
+  /*                              manipulation                              */
+
+  /** str_append_ [<= 1 alloc; 2 if o is *this] */
+  string &
+  operator+=(const string &o) {
+    size_type len = size();
+    size_type n   = o.size();
+    if (n != 0) {
+      if (&o == this) /* the C functions do not accept overlapping args */
+        return *this += string(o);
+      reserve(len + n);
+      str_append_(&s_, o.s_);
+      if (str_len(s_) != len + n)
+        throw std::bad_alloc(); /* a read-only str could not be copied */
+    }
+    return *this;
+  }
+
+  /** str_append [<= 1 alloc; 2 if s points into *this] */
+  string &
+  operator+=(const char *s) {
+    size_type len = size();
+    size_type n   = std::strlen(s);
+    if (n != 0) {
+      if (s_ != nullptr && std::less_equal<const char *>()(s_, s) &&
+          std::less_equal<const char *>()(s, s_ + len))
+        return *this += string(s, n);
+      reserve(len + n);
+      str_append(&s_, s);
+      if (str_len(s_) != len + n)
+        throw std::bad_alloc();
+    }
+    return *this;
+  }
+
+  /** append a concatenation [<= 1 alloc; 1 memcpy per part; 2 allocs if a
+   *  part points into *this] */
+  template <class L, class R>
+  string &
+  operator+=(const concat<L, R> &e) {
+    size_type len = size();
+    size_type n   = e.size();
+    if (s_ != nullptr && e.overlaps(s_, s_ + str_cap(s_) + 1))
+      return *this += string(e);
+    reserve(len + n);
+    e.write(&s_);
+    if (str_len(s_) != len + n)
+      throw std::bad_alloc();
+    return *this;
+  }
+
+  /** str_clear [no realloc] */
+  void
+  clear() noexcept {
+    if (s_ != nullptr)
+      str_clear(&s_);
+  }
+
+  /** str_fit [<= 1 alloc] */
+  void
+  reserve(size_type n) {
+    if (s_ == nullptr)
+      s_ = check(str_alloc(n));
+    else if (str_cap(s_) < n && (str_fit(&s_, n), str_cap(s_) < n))
+      throw std::bad_alloc();
+  }
+
+  /** str_shrinkfit [<= 1 alloc] */
+  void
+  shrink_to_fit() {
+    size_type n = size();
+    if (s_ != nullptr && str_cap(s_) > n &&
+        (str_shrinkfit(&s_), str_cap(s_) != n))
+      throw std::bad_alloc();
+  }
+
+private:
+  str s_;
+
+  static str
+  check(str s) {
+    if (s == nullptr)
+      throw std::bad_alloc();
+    return s;
+  }
+};
+
+/*                               concatenation                                */
+
+namespace detail {
+
+template <>
+struct operand<string> {
+  typedef piece type;
+  static piece
+  make(const string &s) noexcept {
+    return piece{s.c_str(), s.size()};
+  }
+};
+
+template <>
+struct is_lazy<string> : std::true_type {};
+
+/** concatenate lazily [no alloc]
+ *  one operand must be a string, a ref, or a concatenation; the other may
+ *  also be a char *, a char array, a std::string, a std::string_view, a
+ *  char, or an integer [in decimal] */
+template <class A, class B>
+typename std::enable_if<
+    is_lazy<A>::value || is_lazy<B>::value,
+    concat<typename operand<A>::type, typename operand<B>::type> >::type
+operator+(const A &a, const B &b) noexcept {
+  return concat<typename operand<A>::type, typename operand<B>::type>{
+      operand<A>::make(a), operand<B>::make(b)};
+}
+
+} // namespace detail
+
+// declared in detail so that lookup also finds it for a lone ref operand
+using detail::operator+;
+
+/*                                 comparison                                 */
+
+/** order by bytes, then length */
+inline int
+compare(const string &a, const string &b) noexcept {
+  string::size_type alen = a.size();
+  string::size_type blen = b.size();
+  int c = std::memcmp(a.c_str(), b.c_str(), alen < blen ? alen : blen);
+  return c != 0 ? c : (alen > blen) - (alen < blen);
+}
+
+inline bool
+operator==(const string &a, const string &b) noexcept {
+  return a.size() == b.size() &&
+         std::memcmp(a.c_str(), b.c_str(), a.size()) == 0;
+}
+
+inline bool
+operator==(const string &a, const char *b) noexcept {
+  return std::strcmp(a.c_str(), b) == 0 && std::strlen(b) == a.size();
+}
+
+inline bool
+operator==(const char *a, const string &b) noexcept {
+  return b == a;
+}
+
+inline bool
+operator!=(const string &a, const string &b) noexcept {
+  return !(a == b);
+}
+
+inline bool
+operator!=(const string &a, const char *b) noexcept {
+  return !(a == b);
+}
+
+inline bool
+operator!=(const char *a, const string &b) noexcept {
+  return !(b == a);
+}
+
+inline bool
+operator<(const string &a, const string &b) noexcept {
+  return compare(a, b) < 0;
+}
+
+inline bool
+operator<=(const string &a, const string &b) noexcept {
+  return compare(a, b) <= 0;
+}
+
+inline bool
+operator>(const string &a, const string &b) noexcept {
+  return compare(a, b) > 0;
+}
+
+inline bool
+operator>=(const string &a, const string &b) noexcept {
+  return compare(a, b) >= 0;
+}
+
+/** exchange strs [no alloc] */
+inline void
+swap(string &a, string &b) noexcept {
+  a.swap(b);
+}
+
+} // namespace strpp
+
+#ifdef STR_CONFIG_NAMESPACE
+#  undef STR_HPP_CAT
+#  undef STR_HPP_CAT_X
+#  undef STR_HPP_NS_FN
+#  undef str
+#  undef str_alloc
+#  undef str_dup
+#  undef str_new
+#  undef str_sub
+#  undef str_cap
+#  undef str_len
+#  undef str_append
+#  undef str_append_
+#  undef str_append_n
+#  undef str_clear
+#  undef str_fit
+#  undef str_shrinkfit
+#  undef str_free
+#endif
+
+#undef STR_HPP_CPLUSPLUS
+#undef STR_HPP_STRING_VIEW
+
+#endif
@@ -21,11 +21,52 @@
 //  along with this program.  If not, see <https://www.gnu.org/licenses/>.   ///
 ///////////////////////////////////////////////////////////////////////////// */
 
+#if (defined IS_MMAP_TEST || defined IS_URING_TEST) && defined __linux__ && \
+    !defined _GNU_SOURCE
+/* mremap, MAP_ANONYMOUS, and statx are extensions */
+#define _GNU_SOURCE
+#endif
+
+#if defined __unix__ || defined __APPLE__
+#define _POSIX_C_SOURCE 200809L
+#define STR_CONFIG_POSIX
+#endif
+
 #include <assert.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+/* small segments exercise the segment chain of str_builder */
+#define STR_CONFIG_BUILDER_SEGMENT 8
+/* a small buffer exercises the refill and growth paths of str_reader */
+#define STR_CONFIG_READER_BUFFER 8
+
+#ifdef IS_STATS_TEST
+/* validation results are cached and must be dropped by every manipulator */
+#define STR_CONFIG_UTF8_CACHE
+/* every manipulator is instrumented; the counters must stay consistent */
+#define STR_CONFIG_STATS
+/* block events are recorded while a trace is started */
+#define STR_CONFIG_TRACE
+#endif
+
+#ifdef IS_ALIGN_TEST
+/* every allocated str is aligned and padded; the kernels read the padding */
+#define STR_CONFIG_ALIGN 64
+#endif
+
+#if defined IS_MMAP_TEST && defined __linux__
+/* strs of a page or more are mapped; the large tests remap them */
+#define STR_CONFIG_MMAP_THRESHOLD 4096
+#define STR_CONFIG_MMAP_HUGEPAGE
+#endif
+
+#if defined IS_URING_TEST && defined __linux__
+/* str_read_files reads through an io_uring [sequential if refused] */
+#define STR_CONFIG_IO_URING
+#endif
+
 #ifdef IS_NAMESPACE_TEST
 #define STR_CONFIG_NAMESPACE xyz
 #define TEST_REPORT_NS       xyz
@@ -40,9 +81,10 @@ static size_t last_alloc_sz  = SIZE_MAX;
 static void  *last_alloc_ptr = NULL;
 static void  *last_freed_ptr = NULL;
 static void  *tracked_ptr    = NULL;
+static int    fail_allocs    = 0; /* track_alloc returns null while set */
 void *track_alloc(size_t n) {
   last_alloc_sz  = n;
-  last_alloc_ptr = malloc(n);
+  last_alloc_ptr = fail_allocs ? NULL : malloc(n);
   return last_alloc_ptr;
 }
 void  track_free(void *p)   { last_freed_ptr = p;  free(p); }
@@ -52,10 +94,10 @@ void  track_free(void *p)   { last_freed_ptr = p;  free(p); }
                           last_alloc_ptr = NULL;     \
                           last_freed_ptr = NULL;     \
                           tracked_ptr    = NULL
-#define ASSERT_ALLOC(cap, str)                        \
-    assert(last_alloc_sz ==                           \
-    (sizeof(size_t) * 2 + sizeof(char) * ((cap) + 1)) \
-    && last_alloc_ptr == str_mbegin(str)              \
+#define ASSERT_ALLOC(cap, str)                                      \
+    assert(last_alloc_sz ==                                         \
+    (sizeof(size_t) * 2 + sizeof(char) * ((cap) + 1) + ALIGN_EXTRA) \
+    && last_alloc_ptr == str_mbegin(str)                            \
     && last_alloc_ptr != NULL)
 #define ASSERT_NO_ALLOC   assert(last_alloc_sz     == SIZE_MAX \
                                  && last_alloc_ptr == NULL)
@@ -111,32 +153,85 @@ void  track_free(void *p)   { last_freed_ptr = p;  free(p); }
   ASSERT_EQ(str_cap(str), cap);           \
   ASSERT_EQ(str_len(str), strlen(streq))
 
+/* bytes added to an allocation by STR_CONFIG_ALIGN [gap and padding] */
+#ifdef STR_CONFIG_ALIGN
+#define ALIGN_EXTRA (2 * STR_CONFIG_ALIGN)
+#else
+#define ALIGN_EXTRA 0
+#endif
+
 /* simplify namespace testing */
 #ifdef IS_NAMESPACE_TEST
-#define str           STR_CONFIG_NAMESPACE
-#define str_alloc     NS_FN(alloc)
-#define str_dup       NS_FN(dup)
-#define str_new       NS_FN(new)
-#define str_sub       NS_FN(sub)
-#define str_avail     NS_FN(avail)
-#define str_cap       NS_FN(cap)
-#define str_end       NS_FN(end)
-#define str_len       NS_FN(len)
-#define str_mbegin    NS_FN(mbegin)
-#define str_mend      NS_FN(mend)
-#define str_msize     NS_FN(msize)
-#define str_mstr      NS_FN(mstr)
+#define str               STR_CONFIG_NAMESPACE
+#define str_alloc         NS_FN(alloc)
+#define str_alloc_aligned NS_FN(alloc_aligned)
+#define str_dup           NS_FN(dup)
+#define str_new           NS_FN(new)
+#define str_sub           NS_FN(sub)
+#define str_avail         NS_FN(avail)
+#define str_cap           NS_FN(cap)
+#define str_end           NS_FN(end)
+#define str_islower       NS_FN(islower)
+#define str_isupper       NS_FN(isupper)
+#define str_len           NS_FN(len)
+#define str_mbegin        NS_FN(mbegin)
+#define str_mend          NS_FN(mend)
+#define str_msize         NS_FN(msize)
+#define str_mstr          NS_FN(mstr)
+#define str_casecmp      NS_FN(casecmp)
+#define str_casecmp_     NS_FN(casecmp_)
+#define str_caseeq       NS_FN(caseeq)
+#define str_caseeq_      NS_FN(caseeq_)
+#define str_cmp          NS_FN(cmp)
+#define str_cmp_         NS_FN(cmp_)
+#define str_ends_with    NS_FN(ends_with)
+#define str_ends_with_   NS_FN(ends_with_)
+#define str_eq           NS_FN(eq)
+#define str_eq_          NS_FN(eq_)
+#define str_starts_with  NS_FN(starts_with)
+#define str_starts_with_ NS_FN(starts_with_)
+#define str_utf8_len   NS_FN(utf8_len)
+#define str_utf8_valid NS_FN(utf8_valid)
+#define str_append_base64       NS_FN(append_base64)
+#define str_append_csv_field    NS_FN(append_csv_field)
+#define str_append_hex          NS_FN(append_hex)
+#define str_append_json_escaped NS_FN(append_json_escaped)
+#define str_append_unbase64     NS_FN(append_unbase64)
+#define str_append_uncsv        NS_FN(append_uncsv)
+#define str_append_unhex        NS_FN(append_unhex)
+#define str_append_unjson       NS_FN(append_unjson)
+#define str_append_unurl        NS_FN(append_unurl)
+#define str_append_url_encoded  NS_FN(append_url_encoded)
+#define str_to_double  NS_FN(to_double)
+#define str_to_double_ NS_FN(to_double_)
+#define str_to_long    NS_FN(to_long)
+#define str_to_long_   NS_FN(to_long_)
+#define str_to_ulong   NS_FN(to_ulong)
+#define str_to_ulong_  NS_FN(to_ulong_)
 #define str_append    NS_FN(append)
 #define str_append_   NS_FN(append_)
+#define str_append_n  NS_FN(append_n)
 #define str_prepend   NS_FN(prepend)
 #define str_prepend_  NS_FN(prepend_)
 #define str_emplace   NS_FN(emplace)
 #define str_emplace_  NS_FN(emplace_)
+#define str_erase     NS_FN(erase)
 #define str_insert    NS_FN(insert)
 #define str_insert_   NS_FN(insert_)
+#define str_splice    NS_FN(splice)
+#define str_substr    NS_FN(substr)
+#define str_cpylower  NS_FN(cpylower)
+#define str_cpylower_ NS_FN(cpylower_)
+#define str_cpyupper  NS_FN(cpyupper)
+#define str_cpyupper_ NS_FN(cpyupper_)
+#define str_tolower   NS_FN(tolower)
+#define str_toupper   NS_FN(toupper)
 #define str_cpad      NS_FN(cpad)
+#define str_cpadf     NS_FN(cpadf)
 #define str_lpad      NS_FN(lpad)
+#define str_lpadf     NS_FN(lpadf)
 #define str_rpad      NS_FN(rpad)
+#define str_rpadf     NS_FN(rpadf)
 #define str_trim      NS_FN(trim)
 #define str_clear     NS_FN(clear)
 #define str_fit       NS_FN(fit)
@@ -144,6 +239,60 @@ void  track_free(void *p)   { last_freed_ptr = p;  free(p); }
 #define str_realloc   NS_FN(realloc)
 #define str_shrink    NS_FN(shrink)
 #define str_shrinkfit NS_FN(shrinkfit)
+#define str_edit         NS_FN(edit)
+#define str_edit_begin   NS_FN(edit_begin)
+#define str_edit_commit  NS_FN(edit_commit)
+#define str_edit_erase   NS_FN(edit_erase)
+#define str_edit_insert  NS_FN(edit_insert)
+#define str_edit_insert_ NS_FN(edit_insert_)
+#define str_edit_len     NS_FN(edit_len)
+#define str_edit_seek    NS_FN(edit_seek)
+#define str_builder         NS_FN(builder)
+#define str_builder_append  NS_FN(builder_append)
+#define str_builder_append_ NS_FN(builder_append_)
+#define str_builder_finish  NS_FN(builder_finish)
+#define str_builder_free    NS_FN(builder_free)
+#define str_builder_init    NS_FN(builder_init)
+#define str_builder_len     NS_FN(builder_len)
+#define str_builder_reserve NS_FN(builder_reserve)
+#define str_builder_writev  NS_FN(builder_writev)
+#define str_vec         NS_FN(vec)
+#define str_vec_free    NS_FN(vec_free)
+#define str_vec_get     NS_FN(vec_get)
+#define str_vec_get_str NS_FN(vec_get_str)
+#define str_vec_init    NS_FN(vec_init)
+#define str_vec_len     NS_FN(vec_len)
+#define str_vec_pop     NS_FN(vec_pop)
+#define str_vec_push    NS_FN(vec_push)
+#define str_vec_push_   NS_FN(vec_push_)
+#define str_vec_split   NS_FN(vec_split)
+#define str_sort NS_FN(sort)
+#define str_getline       NS_FN(getline)
+#define str_getline_view  NS_FN(getline_view)
+#define str_reader        NS_FN(reader)
+#define str_reader_free   NS_FN(reader_free)
+#define str_reader_init   NS_FN(reader_init)
+#define str_reader_initfd NS_FN(reader_initfd)
+#define str_read_file  NS_FN(read_file)
+#define str_read_files NS_FN(read_files)
+#define str_sendfile   NS_FN(sendfile)
+#define str_write_file NS_FN(write_file)
+#define str_writev     NS_FN(writev)
+#define str_table       NS_FN(table)
+#define str_table_close NS_FN(table_close)
+#define str_table_get   NS_FN(table_get)
+#define str_table_open  NS_FN(table_open)
+#define str_table_write NS_FN(table_write)
+#define str_stats        NS_FN(stats)
+#define str_stats_add    NS_FN(stats_add)
+#define str_stats_entry  NS_FN(stats_entry)
+#define str_stats_format NS_FN(stats_format)
+#define str_stats_get    NS_FN(stats_get)
+#define str_stats_reset  NS_FN(stats_reset)
+#define str_trace_read   NS_FN(trace_read)
+#define str_trace_record NS_FN(trace_record)
+#define str_trace_start  NS_FN(trace_start)
+#define str_trace_stop   NS_FN(trace_stop)
 #define str_free      NS_FN(free)
 
 #endif
@@ -175,6 +324,65 @@ TEST(alloc) {
   }
 }
 
+#ifdef STR_CONFIG_ALIGN
+TEST(alloc_aligned) {
+  {
+    /* capacity fills whole blocks */
+    str s = str_alloc_aligned(0);
+    ASSERT_STR_PROPS(s, "", STR_CONFIG_ALIGN - 1);
+    str_free(&s);
+    s = str_alloc_aligned(STR_CONFIG_ALIGN - 1);
+    ASSERT_EQ(str_cap(s), STR_CONFIG_ALIGN - 1);
+    str_free(&s);
+    s = str_alloc_aligned(STR_CONFIG_ALIGN);
+    ASSERT_EQ(str_cap(s), STR_CONFIG_ALIGN * 2 - 1);
+    str_free(&s);
+  }
+  {
+    /* every allocated str is aligned */
+    str s = str_new("abc");
+    str d = str_dup(s);
+    ASSERT_EQ((size_t)s % STR_CONFIG_ALIGN, 0);
+    ASSERT_EQ((size_t)d % STR_CONFIG_ALIGN, 0);
+    str_realloc(&s, 100);
+    ASSERT_EQ((size_t)s % STR_CONFIG_ALIGN, 0);
+    ASSERT_STR_PROPS(s, "abc", 100);
+    str_free(&s);
+    str_free(&d);
+  }
+  {
+    /* the kernels ignore the chars and padding past the length */
+    size_t lens[] = {1, STR_CONFIG_ALIGN - 1, STR_CONFIG_ALIGN,
+                     STR_CONFIG_ALIGN + 1, STR_CONFIG_ALIGN * 3 - 1};
+    char   buf[STR_CONFIG_ALIGN * 3];
+    size_t i;
+    for (i = 0; i < sizeof(lens) / sizeof(*lens); ++i) {
+      str a = str_alloc(lens[i]);
+      str b = str_alloc(lens[i]);
+      memset(a, 'A', lens[i] + STR_CONFIG_ALIGN);
+      memset(b, 'x', lens[i] + STR_CONFIG_ALIGN);
+      memset(buf, 'b', lens[i]);
+      buf[lens[i]] = '\0';
+      str_append(&a, buf);
+      memset(buf, 'B', lens[i]);
+      str_append(&b, buf);
+      ASSERT_TRUE(str_islower(a));
+      ASSERT_TRUE(str_isupper(b));
+      ASSERT_TRUE(str_caseeq_(a, b));
+      ASSERT_EQ(str_casecmp_(a, b), 0);
+      a[lens[i] - 1] = 'C';
+      ASSERT_FALSE(str_islower(a));
+      ASSERT_FALSE(str_caseeq_(a, b));
+      ASSERT_TRUE((str_casecmp_(a, b) > 0));
+      str_tolower(&a);
+      ASSERT_EQ(a[lens[i] - 1], 'c');
+      str_free(&a);
+      str_free(&b);
+    }
+  }
+}
+#endif
+
 TEST(dup) {
   {
     str s = str_new("foobar");
@@ -277,6 +485,55 @@ TEST(sub) {
   }
 }
 
+STR_LIT(file_lit, "file scope");
+
+static str
+block_lit(void) {
+  STR_LIT(s, "block scope");
+  return s;
+}
+
+TEST(lit) {
+  {
+    str s = file_lit;
+    /*                                                 */ RESET_TRACKING;
+    ASSERT_STR_PROPS(s, "file scope", 10);
+    ASSERT_EQ(s[10], '\0');
+    ASSERT_EQ(block_lit(), block_lit()); /* static storage */
+    ASSERT_STR_PROPS(block_lit(), "block scope", 11);
+    ASSERT_TRUE(str_eq_(s, file_lit));
+    str_free(&s);
+    ASSERT_EQ(s, NULL);
+    ASSERT_STR_PROPS(file_lit, "file scope", 10);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+  }
+  {
+    /* the length counts embedded null chars */
+    STR_LIT(s, "a\0b");
+    ASSERT_EQ(str_len(s), 3);
+    ASSERT_EQ(memcmp(s, "a\0b", 4), 0);
+  }
+  {
+    /* usable as the source of the _ variants */
+    str s = str_new("x");
+    str_append_(&s, file_lit);
+    ASSERT_STR_PROPS(s, "xfile scope", 11);
+    str_free(&s);
+  }
+  {
+    /* manipulators copy it to an owned block */
+    str s = file_lit;
+    /*                                                 */ RESET_TRACKING;
+    str_append(&s, "!");
+    ASSERT_NEQ(s, file_lit);
+    ASSERT_STR_PROPS(s, "file scope!", 11);
+    ASSERT_STR_PROPS(file_lit, "file scope", 10);
+    /*                                                 */ ASSERT_NO_FREE;
+    str_free(&s);
+  }
+}
+
 TEST(avail) {
   str s = str_alloc(0);
   {
@@ -327,6 +584,38 @@ TEST(end) {
   str_free(&s);
 }
 
+TEST(islower) {
+  str s = str_new("foo bar-baz_[@]");
+  str l = str_new("the quick brown fox jumps over the lazy dog, the quick "
+                  "brown fox jumps over the lazy Dog");
+  /*                                                   */ RESET_TRACKING;
+  ASSERT_TRUE(str_islower(s));
+  ASSERT_FALSE(str_islower(l)); /* past the first block */
+  str_emplace(&s, "Z", 14);
+  ASSERT_FALSE(str_islower(s));
+  str_clear(&s);
+  ASSERT_TRUE(str_islower(s));
+  /*                                                   */ ASSERT_NO_ALLOC;
+  /*                                                   */ ASSERT_NO_FREE;
+  str_free(&s);
+  str_free(&l);
+}
+
+TEST(isupper) {
+  str s = str_new("FOO BAR-BAZ_[@]\xe9");
+  /*                                                   */ RESET_TRACKING;
+  ASSERT_TRUE(str_isupper(s));
+  str_emplace(&s, "`{z", 12);
+  ASSERT_FALSE(str_isupper(s));
+  str_emplace(&s, "`{", 12);
+  ASSERT_FALSE(str_isupper(s));
+  str_emplace(&s, "Z", 14);
+  ASSERT_TRUE(str_isupper(s));
+  /*                                                   */ ASSERT_NO_ALLOC;
+  /*                                                   */ ASSERT_NO_FREE;
+  str_free(&s);
+}
+
 TEST(len) {
   str s = str_new("foo");
   {
@@ -343,13 +632,24 @@ TEST(mbegin) {
   {
     void *m = (size_t *)s - 2;
     /*                                                 */ RESET_TRACKING;
+#ifdef STR_CONFIG_ALIGN
+    /* the gap before the header holds 1 to STR_CONFIG_ALIGN bytes */
+    ASSERT_TRUE(((char *)m - (char *)str_mbegin(s) >= 1));
+    ASSERT_TRUE(((char *)m - (char *)str_mbegin(s) <= STR_CONFIG_ALIGN));
+#else
     ASSERT_EQ(str_mbegin(s), m);
+#endif
     /*                                                 */ ASSERT_NO_ALLOC;
     /*                                                 */ ASSERT_NO_FREE;
     str_realloc(&s, 4);
     m = (size_t *)s - 2;
     /*                                                 */ RESET_TRACKING;
+#ifdef STR_CONFIG_ALIGN
+    ASSERT_TRUE(((char *)m - (char *)str_mbegin(s) >= 1));
+    ASSERT_TRUE(((char *)m - (char *)str_mbegin(s) <= STR_CONFIG_ALIGN));
+#else
     ASSERT_EQ(str_mbegin(s), m);
+#endif
     /*                                                 */ ASSERT_NO_ALLOC;
     /*                                                 */ ASSERT_NO_FREE;
   }
@@ -376,12 +676,13 @@ TEST(msize) {
   str s = str_alloc(0);
   {
     /*                                                 */ RESET_TRACKING;
-    ASSERT_EQ(str_msize(s), sizeof(size_t) * 2 + sizeof(char));
+    ASSERT_EQ(str_msize(s), sizeof(size_t) * 2 + sizeof(char) + ALIGN_EXTRA);
     /*                                                 */ ASSERT_NO_ALLOC;
     /*                                                 */ ASSERT_NO_FREE;
     str_realloc(&s, 6);
     /*                                                 */ RESET_TRACKING;
-    ASSERT_EQ(str_msize(s), sizeof(size_t) * 2 + sizeof(char) * 7);
+    ASSERT_EQ(str_msize(s),
+              sizeof(size_t) * 2 + sizeof(char) * 7 + ALIGN_EXTRA);
     /*                                                 */ ASSERT_NO_ALLOC;
     /*                                                 */ ASSERT_NO_FREE;
   }
@@ -391,13 +692,13 @@ TEST(msize) {
 TEST(mstr) {
   str s = str_alloc(0);
   {
-    void *m = (size_t *)s - 2;
+    void *m = str_mbegin(s);
     /*                                                 */ RESET_TRACKING;
     ASSERT_EQ(str_mstr(m), s);
     /*                                                 */ ASSERT_NO_ALLOC;
     /*                                                 */ ASSERT_NO_FREE;
     str_realloc(&s, 6);
-    m = (size_t *)s - 2;
+    m = str_mbegin(s);
     /*                                                 */ RESET_TRACKING;
     ASSERT_EQ(str_mstr(m), s);
     /*                                                 */ ASSERT_NO_ALLOC;
@@ -406,6 +707,846 @@ TEST(mstr) {
   str_free(&s);
 }
 
+#define STR_CASECMP_TEST(str_casecmp_fn, HeLLo, help, hell, blank, at)     \
+  str s = str_new("hello");                                                \
+  str l = str_new("Lorem ipsum dolor sit amet, consectetur adipiscing "    \
+                  "elit, sed do eiusmod tempor incididunt");               \
+  /*                                                   */ RESET_TRACKING;  \
+  ASSERT_EQ(str_casecmp_fn(s, HeLLo), 0);                                  \
+  ASSERT_TRUE((str_casecmp_fn(s, help) < 0));                              \
+  ASSERT_TRUE((str_casecmp_fn(s, hell) > 0));                              \
+  ASSERT_TRUE((str_casecmp_fn(s, blank) > 0));                             \
+  ASSERT_TRUE((str_casecmp_fn(s, at) > 0)); /* '@' < 'h' < 'H' | 0x20 */   \
+  ASSERT_TRUE((str_casecmp_fn(l, s) > 0));                                 \
+  /*                                                   */ ASSERT_NO_ALLOC; \
+  /*                                                   */ ASSERT_NO_FREE;  \
+  str_free(&s);                                                            \
+  str_free(&l)
+
+TEST(casecmp) {
+  STR_CASECMP_TEST(str_casecmp, "HeLLo", "HELP", "hell", "", "@");
+  {
+    str l = str_new("Lorem ipsum dolor sit amet, consectetur adipiscing "
+                    "elit, sed do eiusmod tempor incididunt");
+    ASSERT_EQ(str_casecmp(l, "LOREM IPSUM DOLOR SIT AMET, CONSECTETUR "
+                             "ADIPISCING ELIT, SED DO EIUSMOD TEMPOR "
+                             "INCIDIDUNT"), 0);
+    ASSERT_TRUE((str_casecmp(l, "LOREM IPSUM DOLOR SIT AMET, CONSECTETUR "
+                               "ADIPISCING ELIT, SED DO EIUSMOD TEMPOR "
+                               "INCIDIDUNU") < 0));
+    ASSERT_TRUE((str_casecmp(l, "lorem ipsum dolor sit amet, consectetur "
+                               "adipiscing elit, sed do eiusmod tempor "
+                               "incididunt!") < 0));
+    str_free(&l);
+  }
+}
+
+TEST(casecmp_) {
+  str HeLLo = str_new("HeLLo");
+  str help  = str_new("HELP");
+  str hell  = str_new("hell");
+  str blank = str_new("");
+  str at    = str_new("@");
+
+  STR_CASECMP_TEST(str_casecmp_, HeLLo, help, hell, blank, at);
+
+  str_free(&HeLLo);
+  str_free(&help);
+  str_free(&hell);
+  str_free(&blank);
+  str_free(&at);
+}
+
+#define STR_CASEEQ_TEST(str_caseeq_fn, HeLLo, help, hell, hellos, brkt)    \
+  str s = str_new("hello[");                                               \
+  /*                                                   */ RESET_TRACKING;  \
+  ASSERT_TRUE(str_caseeq_fn(s, HeLLo));                                    \
+  ASSERT_FALSE(str_caseeq_fn(s, help));                                    \
+  ASSERT_FALSE(str_caseeq_fn(s, hell));                                    \
+  ASSERT_FALSE(str_caseeq_fn(s, hellos));                                  \
+  ASSERT_FALSE(str_caseeq_fn(s, brkt)); /* '[' | 0x20 == '{' */            \
+  /*                                                   */ ASSERT_NO_ALLOC; \
+  /*                                                   */ ASSERT_NO_FREE;  \
+  str_free(&s)
+
+TEST(caseeq) {
+  STR_CASEEQ_TEST(str_caseeq, "HeLLo[", "HELP[[", "hell", "hello[s",
+                  "hello{");
+}
+
+TEST(caseeq_) {
+  str HeLLo  = str_new("HeLLo[");
+  str help   = str_new("HELP[[");
+  str hell   = str_new("hell");
+  str hellos = str_new("hello[s");
+  str brkt   = str_new("hello{");
+
+  STR_CASEEQ_TEST(str_caseeq_, HeLLo, help, hell, hellos, brkt);
+
+  str_free(&HeLLo);
+  str_free(&help);
+  str_free(&hell);
+  str_free(&hellos);
+  str_free(&brkt);
+}
+
+#define STR_CMP_TEST(str_cmp_fn, foo, fop, fo, foo_, blank, hi)            \
+  str s = str_new("foo");                                                  \
+  /*                                                   */ RESET_TRACKING;  \
+  ASSERT_EQ(str_cmp_fn(s, foo), 0);                                        \
+  ASSERT_TRUE((str_cmp_fn(s, fop) < 0));                                   \
+  ASSERT_TRUE((str_cmp_fn(s, fo) > 0));                                    \
+  ASSERT_TRUE((str_cmp_fn(s, foo_) < 0));                                  \
+  ASSERT_TRUE((str_cmp_fn(s, blank) > 0));                                 \
+  ASSERT_TRUE((str_cmp_fn(s, hi) < 0)); /* unsigned */                     \
+  /*                                                   */ ASSERT_NO_ALLOC; \
+  /*                                                   */ ASSERT_NO_FREE;  \
+  str_free(&s)
+
+TEST(cmp) {
+  STR_CMP_TEST(str_cmp, "foo", "fop", "fo", "foo ", "", "\xff");
+}
+
+TEST(cmp_) {
+  str foo   = str_new("foo");
+  str fop   = str_new("fop");
+  str fo    = str_new("fo");
+  str foo_  = str_new("foo\1");
+  str blank = str_new("");
+  str hi    = str_new("\xff");
+
+  STR_CMP_TEST(str_cmp_, foo, fop, fo, foo_, blank, hi);
+
+  foo_[3] = '\0'; /* embedded null bytes are compared */
+  ASSERT_TRUE((str_cmp_(foo, foo_) < 0));
+  ASSERT_TRUE((str_cmp_(foo_, foo) > 0));
+
+  str_free(&foo);
+  str_free(&fop);
+  str_free(&fo);
+  str_free(&foo_);
+  str_free(&blank);
+  str_free(&hi);
+}
+
+#define STR_ENDS_WITH_TEST(str_ends_with_fn, baz, foobarbaz, bar, longer,  \
+                           blank)                                          \
+  str s = str_new("foobarbaz");                                            \
+  /*                                                   */ RESET_TRACKING;  \
+  ASSERT_TRUE(str_ends_with_fn(s, baz));                                   \
+  ASSERT_TRUE(str_ends_with_fn(s, foobarbaz));                             \
+  ASSERT_TRUE(str_ends_with_fn(s, blank));                                 \
+  ASSERT_FALSE(str_ends_with_fn(s, bar));                                  \
+  ASSERT_FALSE(str_ends_with_fn(s, longer));                               \
+  /*                                                   */ ASSERT_NO_ALLOC; \
+  /*                                                   */ ASSERT_NO_FREE;  \
+  str_free(&s)
+
+TEST(ends_with) {
+  STR_ENDS_WITH_TEST(str_ends_with, "baz", "foobarbaz", "bar", "_foobarbaz",
+                     "");
+}
+
+TEST(ends_with_) {
+  str baz       = str_new("baz");
+  str foobarbaz = str_new("foobarbaz");
+  str bar       = str_new("bar");
+  str longer    = str_new("_foobarbaz");
+  str blank     = str_new("");
+
+  STR_ENDS_WITH_TEST(str_ends_with_, baz, foobarbaz, bar, longer, blank);
+
+  str_free(&baz);
+  str_free(&foobarbaz);
+  str_free(&bar);
+  str_free(&longer);
+  str_free(&blank);
+}
+
+#define STR_EQ_TEST(str_eq_fn, foo, fo, foo_, fob, Foo)                    \
+  str s = str_new("foo");                                                  \
+  /*                                                   */ RESET_TRACKING;  \
+  ASSERT_TRUE(str_eq_fn(s, foo));                                          \
+  ASSERT_FALSE(str_eq_fn(s, fo));                                          \
+  ASSERT_FALSE(str_eq_fn(s, foo_));                                        \
+  ASSERT_FALSE(str_eq_fn(s, fob));                                         \
+  ASSERT_FALSE(str_eq_fn(s, Foo));                                         \
+  /*                                                   */ ASSERT_NO_ALLOC; \
+  /*                                                   */ ASSERT_NO_FREE;  \
+  str_free(&s)
+
+TEST(eq) {
+  STR_EQ_TEST(str_eq, "foo", "fo", "foo ", "fob", "Foo");
+}
+
+TEST(eq_) {
+  str foo  = str_new("foo");
+  str fo   = str_new("fo");
+  str foo_ = str_new("foo ");
+  str fob  = str_new("fob");
+  str Foo  = str_new("Foo");
+
+  STR_EQ_TEST(str_eq_, foo, fo, foo_, fob, Foo);
+
+  foo_[3] = '\0'; /* embedded null bytes are compared */
+  ASSERT_FALSE(str_eq_(foo, foo_));
+  ASSERT_TRUE(str_eq_(foo_, foo_));
+
+  str_free(&foo);
+  str_free(&fo);
+  str_free(&foo_);
+  str_free(&fob);
+  str_free(&Foo);
+}
+
+#define STR_STARTS_WITH_TEST(str_starts_with_fn, foo, foobarbaz, bar,      \
+                             longer, blank)                                \
+  str s = str_new("foobarbaz");                                            \
+  /*                                                   */ RESET_TRACKING;  \
+  ASSERT_TRUE(str_starts_with_fn(s, foo));                                 \
+  ASSERT_TRUE(str_starts_with_fn(s, foobarbaz));                           \
+  ASSERT_TRUE(str_starts_with_fn(s, blank));                               \
+  ASSERT_FALSE(str_starts_with_fn(s, bar));                                \
+  ASSERT_FALSE(str_starts_with_fn(s, longer));                             \
+  /*                                                   */ ASSERT_NO_ALLOC; \
+  /*                                                   */ ASSERT_NO_FREE;  \
+  str_free(&s)
+
+TEST(starts_with) {
+  STR_STARTS_WITH_TEST(str_starts_with, "foo", "foobarbaz", "bar",
+                       "foobarbaz_", "");
+}
+
+TEST(starts_with_) {
+  str foo       = str_new("foo");
+  str foobarbaz = str_new("foobarbaz");
+  str bar       = str_new("bar");
+  str longer    = str_new("foobarbaz_");
+  str blank     = str_new("");
+
+  STR_STARTS_WITH_TEST(str_starts_with_, foo, foobarbaz, bar, longer, blank);
+
+  str_free(&foo);
+  str_free(&foobarbaz);
+  str_free(&bar);
+  str_free(&longer);
+  str_free(&blank);
+}
+
+TEST(utf8_len) {
+  str s = str_new("na\xc3\xafve caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80");
+  /*                                                   */ RESET_TRACKING;
+  ASSERT_EQ(str_utf8_len(s), 14);
+  ASSERT_TRUE(str_utf8_valid(s));
+  ASSERT_EQ(str_utf8_len(s), 14);
+  str_cpylower(&s, "ASCII ONLY");
+  ASSERT_EQ(str_utf8_len(s), 10);
+  ASSERT_TRUE(str_utf8_valid(s));
+  ASSERT_EQ(str_utf8_len(s), 10); /* cached: the length */
+  str_clear(&s);
+  ASSERT_EQ(str_utf8_len(s), 0);
+  /*                                                   */ ASSERT_NO_ALLOC;
+  /*                                                   */ ASSERT_NO_FREE;
+  str_free(&s);
+}
+
+TEST(utf8_valid) {
+  static const char *const valid[] = {
+      "", "plain ascii, longer than one machine word", "\xc2\x80",
+      "\xdf\xbf", "\xe0\xa0\x80", "\xed\x9f\xbf", "\xee\x80\x80",
+      "\xef\xbf\xbf", "\xf0\x90\x80\x80", "\xf4\x8f\xbf\xbf",
+      "word-aligned ascii, then \xe2\x82\xac, then ascii again"};
+  static const char *const invalid[] = {
+      "\x80", "\xbf", "\xc0\x80", "\xc1\xbf", "\xc2", "\xc2\x41",
+      "\xe0\x80\x80", "\xe0\x9f\xbf", "\xed\xa0\x80", "\xed\xbf\xbf",
+      "\xe1\x80", "\xf0\x80\x80\x80", "\xf0\x8f\xbf\xbf", "\xf4\x90\x80\x80",
+      "\xf5\x80\x80\x80", "\xff", "ascii until the very last byte \xe2\x82"};
+  size_t i;
+  str    s = str_alloc(64);
+  /*                                                   */ RESET_TRACKING;
+  for (i = 0; i < sizeof(valid) / sizeof(*valid); ++i) {
+    str_cpylower(&s, valid[i]);
+    ASSERT_TRUE(str_utf8_valid(s));
+  }
+  for (i = 0; i < sizeof(invalid) / sizeof(*invalid); ++i) {
+    str_cpylower(&s, invalid[i]);
+    ASSERT_FALSE(str_utf8_valid(s));
+  }
+  str_cpylower(&s, "a\xc3\xa9");
+  s[3] = '\0'; /* embedded null bytes are valid */
+  ASSERT_TRUE(str_utf8_valid(s));
+  /*                                                   */ ASSERT_NO_ALLOC;
+  /*                                                   */ ASSERT_NO_FREE;
+
+#ifdef STR_CONFIG_UTF8_CACHE
+  /* cached until the library writes to s */
+  str_cpylower(&s, "caf\xc3\xa9");
+  ASSERT_TRUE(str_utf8_valid(s));
+  s[4] = '\xff'; /* direct writes are not tracked */
+  ASSERT_TRUE(str_utf8_valid(s));
+  str_toupper(&s); /* case conversion keeps the cache */
+  ASSERT_TRUE(str_utf8_valid(s));
+  str_append(&s, "");
+  ASSERT_FALSE(str_utf8_valid(s));
+#else
+  /* validated on every call */
+  str_cpylower(&s, "caf\xc3\xa9");
+  ASSERT_TRUE(str_utf8_valid(s));
+  s[4] = '\xff';
+  ASSERT_FALSE(str_utf8_valid(s));
+  str_toupper(&s);
+  ASSERT_FALSE(str_utf8_valid(s));
+#endif
+  str_emplace(&s, "\xa9", 4);
+  ASSERT_TRUE(str_utf8_valid(s));
+  str_emplace(&s, "\xc3", 4);
+  ASSERT_FALSE(str_utf8_valid(s));
+  ASSERT_EQ(str_cap(s), 64);
+  str_free(&s);
+}
+
+TEST(append_base64) {
+  static const char *const std[] = {"",         "Zg==",     "Zm8=",
+                                    "Zm9v",     "Zm9vYg==", "Zm9vYmE=",
+                                    "Zm9vYmFy"};
+  static const char *const url[] = {"",       "Zg",     "Zm8",     "Zm9v",
+                                    "Zm9vYg", "Zm9vYmE", "Zm9vYmFy"};
+  size_t i;
+  str    s = str_alloc(0);
+  for (i = 0; i < sizeof(std) / sizeof(*std); ++i) { /* RFC 4648 10 */
+    str_clear(&s);
+    str_append_base64(&s, "foobar", i, STR_BASE64_STD);
+    ASSERT_STREQ(s, std[i]);
+    ASSERT_EQ(str_len(s), strlen(std[i]));
+    str_clear(&s);
+    str_append_base64(&s, "foobar", i, STR_BASE64_URL);
+    ASSERT_STREQ(s, url[i]);
+    ASSERT_EQ(str_len(s), strlen(url[i]));
+  }
+  str_free(&s);
+
+  s = str_alloc(0);
+  str_append(&s, ">");
+  /*                                                   */ RESET_TRACKING;
+  /*                                                   */ TRACK_STR(s);
+  str_append_base64(&s, "\xfb\xff\xbf", 3, STR_BASE64_STD);
+  ASSERT_STR_PROPS(s, ">+/+/", 5);
+  /*                                                   */ ASSERT_ALLOC(5, s);
+  /*                                                   */ ASSERT_FREE;
+  str_realloc(&s, 9);
+  /*                                                   */ RESET_TRACKING;
+  str_append_base64(&s, "\xfb\xff\xbf", 3, STR_BASE64_URL);
+  ASSERT_STR_PROPS(s, ">+/+/-_-_", 9);
+  str_append_base64(&s, "", 0, STR_BASE64_STD);
+  ASSERT_STR_PROPS(s, ">+/+/-_-_", 9);
+  /*                                                   */ ASSERT_NO_ALLOC;
+  /*                                                   */ ASSERT_NO_FREE;
+  str_free(&s);
+}
+
+TEST(append_csv_field) {
+  str s = str_alloc(0);
+  str_append(&s, "a,");
+  /*                                                   */ RESET_TRACKING;
+  /*                                                   */ TRACK_STR(s);
+  str_append_csv_field(&s, "say \"hi\", bob", 13);
+  ASSERT_STR_PROPS(s, "a,\"say \"\"hi\"\", bob\"", 19);
+  /*                                                   */ ASSERT_ALLOC(19, s);
+  /*                                                   */ ASSERT_FREE;
+  str_realloc(&s, 28);
+  /*                                                   */ RESET_TRACKING;
+  str_append_csv_field(&s, ",plain", 6);
+  ASSERT_STR_PROPS(s, "a,\"say \"\"hi\"\", bob\"\",plain\"", 28);
+  str_clear(&s);
+  str_append_csv_field(&s, "plain", 5);
+  ASSERT_STR_PROPS(s, "plain", 28);
+  str_append_csv_field(&s, "", 0);
+  ASSERT_STR_PROPS(s, "plain", 28);
+  str_append_csv_field(&s, "\"", 1);
+  ASSERT_STR_PROPS(s, "plain\"\"\"\"", 28);
+  str_clear(&s);
+  str_append_csv_field(&s, "a\nb", 3);
+  ASSERT_STR_PROPS(s, "\"a\nb\"", 28);
+  str_clear(&s);
+  str_append_csv_field(&s, "a\r", 2);
+  ASSERT_STR_PROPS(s, "\"a\r\"", 28);
+  /*                                                   */ ASSERT_NO_ALLOC;
+  /*                                                   */ ASSERT_NO_FREE;
+  str_free(&s);
+}
+
+TEST(append_hex) {
+  str s = str_alloc(0);
+  str_append(&s, "0x");
+  /*                                                   */ RESET_TRACKING;
+  /*                                                   */ TRACK_STR(s);
+  str_append_hex(&s, "\x00\x1f\xa0\xff", 4);
+  ASSERT_STR_PROPS(s, "0x001fa0ff", 10);
+  /*                                                   */ ASSERT_ALLOC(10, s);
+  /*                                                   */ ASSERT_FREE;
+  str_realloc(&s, 14);
+  /*                                                   */ RESET_TRACKING;
+  str_append_hex(&s, "Hi", 2);
+  ASSERT_STR_PROPS(s, "0x001fa0ff4869", 14);
+  str_append_hex(&s, "", 0);
+  ASSERT_STR_PROPS(s, "0x001fa0ff4869", 14);
+  /*                                                   */ ASSERT_NO_ALLOC;
+  /*                                                   */ ASSERT_NO_FREE;
+  str_free(&s);
+}
+
+TEST(append_json_escaped) {
+  str s = str_alloc(0);
+  str_append(&s, "\"");
+  /*                                                   */ RESET_TRACKING;
+  /*                                                   */ TRACK_STR(s);
+  str_append_json_escaped(&s, "a\"b\\c\n\x01\x1f\xc3\xa9/", 11);
+  ASSERT_STR_PROPS(s, "\"a\\\"b\\\\c\\n\\u0001\\u001f\xc3\xa9/", 25);
+  /*                                                   */ ASSERT_ALLOC(25, s);
+  /*                                                   */ ASSERT_FREE;
+  str_clear(&s);
+  /*                                                   */ RESET_TRACKING;
+  str_append_json_escaped(&s, "\b\f\n\r\t", 5);
+  ASSERT_STR_PROPS(s, "\\b\\f\\n\\r\\t", 25);
+  str_clear(&s);
+  str_append_json_escaped(&s, "a\0b", 3);
+  ASSERT_STR_PROPS(s, "a\\u0000b", 25);
+  str_clear(&s);
+  str_append_json_escaped(&s, "a long run of clean chars that spans blocks "
+                              "of the class scan before one quote: \"", 81);
+  ASSERT_EQ(str_len(s), 82);
+  ASSERT_STREQ(&s[80], "\\\"");
+  /*                                                   */ ASSERT_ALLOC(82, s);
+  str_free(&s);
+}
+
+TEST(append_unbase64) {
+  static const char *const std[] = {"",         "Zg==",     "Zm8=",
+                                    "Zm9v",     "Zm9vYg==", "Zm9vYmE=",
+                                    "Zm9vYmFy"};
+  static const char *const bad[] = {"Z",    "Zg=",   "Zh==", "Zm9=",
+                                    "Zg=a", "Z===",  "Zm 9", "Zm9vY",
+                                    "-_==", "Zg==Zg=="};
+  static const size_t      off[] = {0, 2, 1, 2, 2, 1, 2, 4, 0, 2};
+  size_t i;
+  size_t at;
+  str    s = str_alloc(0);
+  for (i = 0; i < sizeof(std) / sizeof(*std); ++i) {
+    str_clear(&s);
+    ASSERT_EQ(str_append_unbase64(&s, std[i], strlen(std[i]), STR_BASE64_STD,
+                                  NULL),
+              0);
+    ASSERT_EQ(str_len(s), i);
+    ASSERT_TRUE((memcmp(s, "foobar", i) == 0));
+    str_clear(&s); /* padding is optional in both alphabets */
+    ASSERT_EQ(str_append_unbase64(&s, std[i], (i * 4 + 2) / 3, STR_BASE64_URL,
+                                  NULL),
+              0);
+    ASSERT_EQ(str_len(s), i);
+    ASSERT_TRUE((memcmp(s, "foobar", i) == 0));
+  }
+  str_clear(&s);
+  str_append(&s, "ok");
+  for (i = 0; i < sizeof(bad) / sizeof(*bad); ++i) {
+    at = SIZE_MAX;
+    ASSERT_EQ(str_append_unbase64(&s, bad[i], strlen(bad[i]), STR_BASE64_STD,
+                                  &at),
+              -1);
+    ASSERT_EQ(at, off[i]);
+    ASSERT_STREQ(s, "ok");
+    ASSERT_EQ(str_len(s), 2);
+  }
+  ASSERT_EQ(str_append_unbase64(&s, "+/+/", 4, STR_BASE64_URL, &at), -1);
+  ASSERT_EQ(at, 0);
+  ASSERT_EQ(str_append_unbase64(&s, "-_-_", 4, STR_BASE64_URL, &at), 0);
+  ASSERT_STREQ(s, "ok\xfb\xff\xbf");
+  str_free(&s);
+
+  s = str_alloc(0);
+  str_append(&s, ">");
+  /*                                                   */ RESET_TRACKING;
+  /*                                                   */ TRACK_STR(s);
+  ASSERT_EQ(str_append_unbase64(&s, "Zm9vYmE=", 8, STR_BASE64_STD, NULL), 0);
+  ASSERT_STR_PROPS(s, ">fooba", 6);
+  /*                                                   */ ASSERT_ALLOC(6, s);
+  /*                                                   */ ASSERT_FREE;
+  str_free(&s);
+}
+
+TEST(append_uncsv) {
+  static const char *const bad[] = {"\"", "\"abc", "\"a\"b\"", "\"a\"\"",
+                                    "\"\"\"\"\""};
+  static const size_t      off[] = {0, 0, 2, 2, 3};
+  size_t i;
+  size_t at;
+  str    s = str_alloc(0);
+  str_append(&s, ">");
+  /*                                                   */ RESET_TRACKING;
+  /*                                                   */ TRACK_STR(s);
+  ASSERT_EQ(str_append_uncsv(&s, "\"say \"\"hi\"\", bob\"", 17, NULL), 0);
+  ASSERT_STR_PROPS(s, ">say \"hi\", bob", 14);
+  /*                                                   */ ASSERT_ALLOC(14, s);
+  /*                                                   */ ASSERT_FREE;
+  str_clear(&s);
+  /*                                                   */ RESET_TRACKING;
+  ASSERT_EQ(str_append_uncsv(&s, "plain \"as\" is", 13, NULL), 0);
+  ASSERT_STR_PROPS(s, "plain \"as\" is", 14);
+  str_clear(&s);
+  ASSERT_EQ(str_append_uncsv(&s, "\"\"", 2, NULL), 0);
+  ASSERT_EQ(str_append_uncsv(&s, "", 0, NULL), 0);
+  ASSERT_STR_PROPS(s, "", 14);
+  ASSERT_EQ(str_append_uncsv(&s, "\"\"\"\"", 4, NULL), 0);
+  ASSERT_STR_PROPS(s, "\"", 14);
+  for (i = 0; i < sizeof(bad) / sizeof(*bad); ++i) {
+    at = SIZE_MAX;
+    ASSERT_EQ(str_append_uncsv(&s, bad[i], strlen(bad[i]), &at), -1);
+    ASSERT_EQ(at, off[i]);
+    ASSERT_STR_PROPS(s, "\"", 14);
+  }
+  /*                                                   */ ASSERT_NO_ALLOC;
+  /*                                                   */ ASSERT_NO_FREE;
+  str_free(&s);
+}
+
+TEST(append_unhex) {
+  size_t at;
+  str    s = str_alloc(0);
+  str_append(&s, "0x");
+  /*                                                   */ RESET_TRACKING;
+  /*                                                   */ TRACK_STR(s);
+  ASSERT_EQ(str_append_unhex(&s, "4869", 4, NULL), 0);
+  ASSERT_STR_PROPS(s, "0xHi", 4);
+  /*                                                   */ ASSERT_ALLOC(4, s);
+  /*                                                   */ ASSERT_FREE;
+  /*                                                   */ RESET_TRACKING;
+  ASSERT_EQ(str_append_unhex(&s, "", 0, &at), 0);
+  ASSERT_STR_PROPS(s, "0xHi", 4);
+  /*                                                   */ ASSERT_NO_ALLOC;
+  /*                                                   */ ASSERT_NO_FREE;
+  str_free(&s);
+
+  s = str_alloc(0);
+  ASSERT_EQ(str_append_unhex(&s, "00fFaA9f", 8, &at), 0);
+  ASSERT_EQ(str_len(s), 4);
+  ASSERT_TRUE((memcmp(s, "\x00\xff\xaa\x9f", 5) == 0));
+  str_clear(&s);
+  ASSERT_EQ(str_append_unhex(&s, "00fg", 4, &at), -1);
+  ASSERT_EQ(at, 3);
+  ASSERT_EQ(str_append_unhex(&s, "0:", 2, &at), -1);
+  ASSERT_EQ(at, 1);
+  ASSERT_EQ(str_append_unhex(&s, "@0", 2, &at), -1);
+  ASSERT_EQ(at, 0);
+  ASSERT_EQ(str_append_unhex(&s, "abc", 3, &at), -1);
+  ASSERT_EQ(at, 2);
+  ASSERT_EQ(str_append_unhex(&s, "abcG", 4, NULL), -1);
+  ASSERT_STR_PROPS(s, "", 4);
+  str_free(&s);
+}
+
+TEST(append_unjson) {
+  static const char *const bad[] = {"\\",      "a\\x",     "a\"",
+                                    "\n",      "\\u12",    "\\u12g4",
+                                    "\\ud800", "\\udc00",  "\\ud800\\u0041",
+                                    "ok\\ud83d\\ude0"};
+  static const size_t      off[] = {0, 1, 1, 0, 0, 0, 0, 0, 0, 2};
+  size_t i;
+  size_t at;
+  str    s = str_alloc(0);
+  str_append(&s, ">");
+  /*                                                   */ RESET_TRACKING;
+  /*                                                   */ TRACK_STR(s);
+  ASSERT_EQ(str_append_unjson(&s, "a\\\"b\\\\c\\/\\n\\u0041", 17, NULL), 0);
+  ASSERT_STR_PROPS(s, ">a\"b\\c/\nA", 9);
+  /*                                                   */ ASSERT_ALLOC(9, s);
+  /*                                                   */ ASSERT_FREE;
+  str_clear(&s);
+  /*                                                   */ RESET_TRACKING;
+  /*                                                   */ TRACK_STR(s);
+  ASSERT_EQ(str_append_unjson(&s, "\\u00e9\\u20AC\\ud83d\\ude00\\b\\f\\r\\t",
+                              32, NULL),
+            0);
+  ASSERT_STR_PROPS(s, "\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80\b\f\r\t", 13);
+  /*                                                   */ ASSERT_ALLOC(13, s);
+  /*                                                   */ ASSERT_FREE;
+  str_clear(&s);
+  ASSERT_EQ(str_append_unjson(&s, "\\u0000", 6, NULL), 0);
+  ASSERT_EQ(str_len(s), 1);
+  ASSERT_EQ(s[0], '\0');
+  str_clear(&s);
+  /*                                                   */ RESET_TRACKING;
+  for (i = 0; i < sizeof(bad) / sizeof(*bad); ++i) {
+    at = SIZE_MAX;
+    ASSERT_EQ(str_append_unjson(&s, bad[i], strlen(bad[i]), &at), -1);
+    ASSERT_EQ(at, off[i]);
+    ASSERT_STR_PROPS(s, "", 13);
+  }
+  /*                                                   */ ASSERT_NO_ALLOC;
+  /*                                                   */ ASSERT_NO_FREE;
+  str_free(&s);
+}
+
+TEST(append_unurl) {
+  static const char *const bad[] = {"%", "a%2", "a%g0", "%0g", "ok%41%"};
+  static const size_t      off[] = {0, 1, 1, 0, 5};
+  size_t i;
+  size_t at;
+  str    s = str_alloc(0);
+  str_append(&s, ">");
+  /*                                                   */ RESET_TRACKING;
+  /*                                                   */ TRACK_STR(s);
+  ASSERT_EQ(str_append_unurl(&s, "a%20b+c%2f%2F%C3%A9", 19, NULL), 0);
+  ASSERT_STR_PROPS(s, ">a b+c//\xc3\xa9", 10);
+  /*                                                   */ ASSERT_ALLOC(10, s);
+  /*                                                   */ ASSERT_FREE;
+  str_clear(&s);
+  /*                                                   */ RESET_TRACKING;
+  ASSERT_EQ(str_append_unurl(&s, "", 0, NULL), 0);
+  ASSERT_EQ(str_append_unurl(&s, "%00", 3, NULL), 0);
+  ASSERT_EQ(str_len(s), 1);
+  str_clear(&s);
+  for (i = 0; i < sizeof(bad) / sizeof(*bad); ++i) {
+    at = SIZE_MAX;
+    ASSERT_EQ(str_append_unurl(&s, bad[i], strlen(bad[i]), &at), -1);
+    ASSERT_EQ(at, off[i]);
+    ASSERT_STR_PROPS(s, "", 10);
+  }
+  /*                                                   */ ASSERT_NO_ALLOC;
+  /*                                                   */ ASSERT_NO_FREE;
+  str_free(&s);
+}
+
+TEST(append_url_encoded) {
+  str s = str_alloc(0);
+  str_append(&s, "?q=");
+  /*                                                   */ RESET_TRACKING;
+  /*                                                   */ TRACK_STR(s);
+  str_append_url_encoded(&s, "a b/c?\xc3\xa9-._~Z9", 14);
+  ASSERT_STR_PROPS(s, "?q=a%20b%2Fc%3F%C3%A9-._~Z9", 27);
+  /*                                                   */ ASSERT_ALLOC(27, s);
+  /*                                                   */ ASSERT_FREE;
+  str_clear(&s);
+  /*                                                   */ RESET_TRACKING;
+  str_append_url_encoded(&s, "", 0);
+  str_append_url_encoded(&s, "@[`{", 4);
+  ASSERT_STR_PROPS(s, "%40%5B%60%7B", 27);
+  /*                                                   */ ASSERT_NO_ALLOC;
+  /*                                                   */ ASSERT_NO_FREE;
+  str_free(&s);
+}
+
+TEST(to_double) {
+  static const char *const nums[] = {
+      "0",
+      "-0",
+      "1.5",
+      ".5",
+      "5.",
+      "-12.25e+2x",
+      "1e10",
+      "1E-5",
+      "0.1",
+      "123456789012345e10",
+      "123456789012345e-22",
+      "1e36",
+      "1e37",
+      "12e-23",
+      "3.141592653589793",
+      "9007199254740993",
+      "2.2250738585072014e-308",
+      "4.9e-324",
+      "1e-400",
+      "1.7976931348623157e308",
+      "1e",
+      "1e+",
+      "1.5e-x",
+      "0e999999",
+      "00000000000000000001.5",
+      "0.000000000000000000000000000001",
+      "1234567890123456789012345678901234567890123456789012345678901234567890."
+      "0123456789e-50"};
+  static const char *const bad[] = {"", ".", "+", "-.e1", "e5", " 1", "inf"};
+  size_t i;
+  size_t used;
+  double d;
+  for (i = 0; i < sizeof(nums) / sizeof(*nums); ++i) {
+    char  *end;
+    double ref = strtod(nums[i], &end);
+    ASSERT_EQ(str_to_double(nums[i], strlen(nums[i]), &d, &used), 0);
+    ASSERT_TRUE((d == ref));
+    ASSERT_EQ(used, (size_t)(end - nums[i]));
+  }
+  ASSERT_EQ(str_to_double("-0", 2, &d, NULL), 0);
+  ASSERT_TRUE((1 / d < 0));
+  ASSERT_EQ(str_to_double("1e309", 5, &d, &used), 1);
+  ASSERT_TRUE((d == HUGE_VAL));
+  ASSERT_EQ(used, 5);
+  ASSERT_EQ(str_to_double("-1e309", 6, &d, &used), 1);
+  ASSERT_TRUE((d == -HUGE_VAL));
+  ASSERT_EQ(str_to_double("1.25e3", 4, &d, &used), 0); /* bounded by n */
+  ASSERT_TRUE((d == 1.25));
+  ASSERT_EQ(used, 4);
+  for (i = 0; i < sizeof(bad) / sizeof(*bad); ++i) {
+    used = 1;
+    d    = 7;
+    ASSERT_EQ(str_to_double(bad[i], strlen(bad[i]), &d, &used), -1);
+    ASSERT_EQ(used, 0);
+    ASSERT_TRUE((d == 7));
+  }
+#ifdef IS_ALLOCATION_TEST
+  {
+    /* a long number whose copy cannot be allocated is told apart */
+    const char *num = nums[sizeof(nums) / sizeof(*nums) - 1];
+    used            = 1;
+    d               = 7;
+    fail_allocs     = 1;
+    ASSERT_EQ(str_to_double(num, strlen(num), &d, &used), -2);
+    fail_allocs = 0;
+    ASSERT_EQ(used, 0);
+    ASSERT_TRUE((d == 7));
+  }
+#endif
+
+  /* matches strtod on random inputs from both paths */
+  srand(41);
+  for (i = 0; i < 20000; ++i) {
+    char   buf[64];
+    char  *end;
+    size_t len = 0;
+    size_t k;
+    size_t nd = 1 + rand() % 20;
+    if (rand() % 2)
+      buf[len++] = '-';
+    for (k = 0; k < nd; ++k) {
+      if (k == (size_t)rand() % (nd + 1))
+        buf[len++] = '.';
+      buf[len++] = (char)('0' + rand() % 10);
+    }
+    if (rand() % 2)
+      len += sprintf(&buf[len], "e%d", rand() % 80 - 40);
+    buf[len] = '\0';
+    ASSERT_EQ(str_to_double(buf, len, &d, &used), 0);
+    ASSERT_TRUE((d == strtod(buf, &end)));
+    ASSERT_EQ(used, (size_t)(end - buf));
+  }
+
+  /* the locale's decimal point is ignored */
+  if (setlocale(LC_NUMERIC, "de_DE.UTF-8") != NULL) {
+    ASSERT_EQ(str_to_double("1.5", 3, &d, NULL), 0);
+    ASSERT_TRUE((d == 1.5));
+    ASSERT_EQ(str_to_double("3.141592653589793", 17, &d, NULL), 0);
+    ASSERT_TRUE((d == 3.141592653589793));
+    setlocale(LC_NUMERIC, "C");
+  }
+}
+
+TEST(to_double_) {
+  size_t used;
+  double d;
+  str    s = str_new("0.25e1");
+  ASSERT_EQ(str_to_double_(s, &d, &used), 0);
+  ASSERT_TRUE((d == 2.5));
+  ASSERT_EQ(used, 6);
+  str_free(&s);
+  s = str_sub("0.25e1", 4); /* bounded by the length */
+  ASSERT_EQ(str_to_double_(s, &d, &used), 0);
+  ASSERT_TRUE((d == 0.25));
+  ASSERT_EQ(used, 4);
+  str_free(&s);
+}
+
+TEST(to_long) {
+  static const char *const bad[] = {"", "-", "+", "--1", "+-1", "-x", " 1"};
+  char   max[32];
+  char   min[32];
+  size_t used;
+  size_t i;
+  long   l;
+  ASSERT_EQ(str_to_long("-42x", 4, &l, &used), 0);
+  ASSERT_EQ(l, -42);
+  ASSERT_EQ(used, 3);
+  ASSERT_EQ(str_to_long("+0000000000000000000000007", 26, &l, &used), 0);
+  ASSERT_EQ(l, 7);
+  ASSERT_EQ(used, 26);
+  ASSERT_EQ(str_to_long("-0", 2, &l, NULL), 0);
+  ASSERT_EQ(l, 0);
+  sprintf(max, "%ld", LONG_MAX);
+  sprintf(min, "%ld", LONG_MIN);
+  ASSERT_EQ(str_to_long(max, strlen(max), &l, &used), 0);
+  ASSERT_EQ(l, LONG_MAX);
+  ASSERT_EQ(str_to_long(min, strlen(min), &l, &used), 0);
+  ASSERT_EQ(l, LONG_MIN);
+  ASSERT_EQ(used, strlen(min));
+  ++max[strlen(max) - 1];
+  ++min[strlen(min) - 1];
+  ASSERT_EQ(str_to_long(max, strlen(max), &l, &used), 1);
+  ASSERT_EQ(l, LONG_MAX);
+  ASSERT_EQ(str_to_long(min, strlen(min), &l, &used), 1);
+  ASSERT_EQ(l, LONG_MIN);
+  ASSERT_EQ(used, strlen(min));
+  for (i = 0; i < sizeof(bad) / sizeof(*bad); ++i) {
+    used = 1;
+    l    = 7;
+    ASSERT_EQ(str_to_long(bad[i], strlen(bad[i]), &l, &used), -1);
+    ASSERT_EQ(used, 0);
+    ASSERT_EQ(l, 7);
+  }
+}
+
+TEST(to_long_) {
+  size_t used;
+  long   l;
+  str    s = str_sub("-12345", 3); /* bounded by the length */
+  ASSERT_EQ(str_to_long_(s, &l, &used), 0);
+  ASSERT_EQ(l, -12);
+  ASSERT_EQ(used, 3);
+  str_free(&s);
+}
+
+TEST(to_ulong) {
+  static const char *const bad[] = {"", "+", "-1", "x1", " 1"};
+  char          max[32];
+  size_t        used;
+  size_t        i;
+  unsigned long u;
+  ASSERT_EQ(str_to_ulong("+123456789x", 11, &u, &used), 0);
+  ASSERT_EQ(u, 123456789);
+  ASSERT_EQ(used, 10);
+  ASSERT_EQ(str_to_ulong("12345678", 5, &u, &used), 0); /* bounded by n */
+  ASSERT_EQ(u, 12345);
+  ASSERT_EQ(used, 5);
+  ASSERT_EQ(str_to_ulong("000000000000000000000000000000000", 33, &u, &used),
+            0);
+  ASSERT_EQ(u, 0);
+  ASSERT_EQ(used, 33);
+  sprintf(max, "%lu", ULONG_MAX);
+  ASSERT_EQ(str_to_ulong(max, strlen(max), &u, &used), 0);
+  ASSERT_EQ(u, ULONG_MAX);
+  ++max[strlen(max) - 1];
+  ASSERT_EQ(str_to_ulong(max, strlen(max), &u, &used), 1);
+  ASSERT_EQ(u, ULONG_MAX);
+  ASSERT_EQ(used, strlen(max));
+  strcat(max, "00000000");
+  ASSERT_EQ(str_to_ulong(max, strlen(max), &u, &used), 1);
+  ASSERT_EQ(used, strlen(max));
+  for (i = 0; i < sizeof(bad) / sizeof(*bad); ++i) {
+    used = 1;
+    u    = 7;
+    ASSERT_EQ(str_to_ulong(bad[i], strlen(bad[i]), &u, &used), -1);
+    ASSERT_EQ(used, 0);
+    ASSERT_EQ(u, 7);
+  }
+}
+
+TEST(to_ulong_) {
+  size_t        used;
+  unsigned long u;
+  str           s = str_sub("1234567890", 9); /* bounded by the length */
+  ASSERT_EQ(str_to_ulong_(s, &u, &used), 0);
+  ASSERT_EQ(u, 123456789);
+  ASSERT_EQ(used, 9);
+  str_free(&s);
+}
+
 #define STR_APPEND_TEST(str_append_fn, foo, bar, baz, isms, blank)            \
   str s = str_alloc(0);                                                       \
   /*                                                   */ RESET_TRACKING;     \
@@ -458,6 +1599,30 @@ TEST(append_) {
   str_free(&blank);
 }
 
+TEST(append_n) {
+  {
+    str s = str_alloc(0);
+    /*                                                 */ RESET_TRACKING;
+    /*                                                 */ TRACK_STR(s);
+    str_append_n(&s, "foobar", 3);
+    ASSERT_STR_PROPS(s, "foo", 3);
+    /*                                                 */ ASSERT_ALLOC(3, s);
+    /*                                                 */ ASSERT_FREE;
+    str_realloc(&s, 8);
+    /*                                                 */ RESET_TRACKING;
+    str_append_n(&s, "a\0b", 3);
+    ASSERT_EQ(str_len(s), 6);
+    ASSERT_EQ(memcmp(s, "fooa\0b", 7), 0);
+    str_append_n(&s, "", 0);
+    str_append_n(&s, "cd", 2);
+    ASSERT_EQ(str_len(s), 8);
+    ASSERT_EQ(memcmp(s, "fooa\0bcd", 9), 0);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+    str_free(&s);
+  }
+}
+
 #define STR_PREPEND_TEST(str_prepend_fn, bar, foo, more, blank)               \
   str s = str_alloc(0);                                                       \
   /*                                                   */ RESET_TRACKING;     \
@@ -558,6 +1723,36 @@ TEST(emplace_) {
   str_free(&blank);
 }
 
+TEST(erase) {
+  str s = str_new("hello, world");
+  {
+    /*                                                 */ RESET_TRACKING;
+    str_erase(&s, 5, 7);
+    ASSERT_STR_PROPS(s, "hello", 12);
+    str_erase(&s, 0, 1);
+    ASSERT_STR_PROPS(s, "ello", 12);
+    str_erase(&s, 2, 100); /* clamped */
+    ASSERT_STR_PROPS(s, "el", 12);
+    str_erase(&s, 9, 1); /* past the end */
+    str_erase(&s, 0, 0);
+    ASSERT_STR_PROPS(s, "el", 12);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+  }
+  {
+    /* a read-only str is copied once */
+    str r = file_lit;
+    /*                                                 */ RESET_TRACKING;
+    str_erase(&r, 4, 1);
+    ASSERT_STR_PROPS(r, "filescope", 10);
+    ASSERT_STR_PROPS(file_lit, "file scope", 10);
+    /*                                                 */ ASSERT_ALLOC(10, r);
+    /*                                                 */ ASSERT_NO_FREE;
+    str_free(&r);
+  }
+  str_free(&s);
+}
+
 #define STR_INSERT_TEST(str_insert_fn, sentence, this, is, a, blank)           \
   str s = str_alloc(0);                                                        \
   /*                                                   */ RESET_TRACKING;      \
@@ -612,24 +1807,234 @@ TEST(insert_) {
   str_free(&blank);
 }
 
-TEST(cpad) {
-  str s = str_alloc(0);
+TEST(splice) {
+  str s = str_alloc(32);
   {
+    str_append(&s, "hello, world");
     /*                                                 */ RESET_TRACKING;
-    /*                                                 */ TRACK_STR(s);
-    str_cpad(&s, 3);
-    ASSERT_STR_PROPS(s, "   ", 3);
-    /*                                                 */ ASSERT_ALLOC(3, s);
-    /*                                                 */ ASSERT_FREE;
-    str_emplace(&s, "<--->", 0);
-    str_realloc(&s, 11);
-    /*                                                 */ RESET_TRACKING;
-    str_cpad(&s, 11);
-    ASSERT_STR_PROPS(s, "   <--->   ", 11);
+    str_splice(&s, 7, 5, "there", 5);
+    ASSERT_STR_PROPS(s, "hello, there", 32);
+    str_splice(&s, 5, 7, "!", 1); /* shorter */
+    ASSERT_STR_PROPS(s, "hello!", 32);
+    str_splice(&s, 0, 0, "oh, ", 4); /* longer */
+    ASSERT_STR_PROPS(s, "oh, hello!", 32);
+    str_splice(&s, 4, 100, "hi", 2); /* clamped n */
+    ASSERT_STR_PROPS(s, "oh, hi", 32);
+    str_splice(&s, 99, 0, "!?", 1); /* clamped idx */
+    ASSERT_STR_PROPS(s, "oh, hi!", 32);
+    str_splice(&s, 2, 2, "", 0);
+    ASSERT_STR_PROPS(s, "ohhi!", 32);
     /*                                                 */ ASSERT_NO_ALLOC;
     /*                                                 */ ASSERT_NO_FREE;
-
-    /*                                                 */ RESET_TRACKING;
+  }
+  {
+    /* ins points into s: before, within, after, and across the range */
+    /*                                                 */ RESET_TRACKING;
+    str_clear(&s);
+    str_append(&s, "abcdefgh");
+    str_splice(&s, 4, 1, s, 3);
+    ASSERT_STR_PROPS(s, "abcdabcfgh", 32);
+    str_clear(&s);
+    str_append(&s, "abcdefgh");
+    str_splice(&s, 2, 2, s + 2, 4);
+    ASSERT_STR_PROPS(s, "abcdefefgh", 32);
+    str_clear(&s);
+    str_append(&s, "abcdefgh");
+    str_splice(&s, 1, 2, s + 5, 3);
+    ASSERT_STR_PROPS(s, "afghdefgh", 32);
+    str_clear(&s);
+    str_append(&s, "abcdefgh");
+    str_splice(&s, 2, 3, s + 3, 4);
+    ASSERT_STR_PROPS(s, "abdefgfgh", 32);
+    str_clear(&s);
+    str_append(&s, "abcdefgh");
+    str_splice(&s, 1, 4, s + 4, 3);
+    ASSERT_STR_PROPS(s, "aefgfgh", 32);
+    str_clear(&s);
+    str_append(&s, "abcdefgh");
+    str_splice(&s, 0, 8, s + 2, 2);
+    ASSERT_STR_PROPS(s, "cd", 32);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+  }
+  {
+    /* one reallocation when growing, which ins may point into */
+    str_clear(&s);
+    str_append(&s, "abcdefgh");
+    str_shrinkfit(&s);
+    /*                                                 */ RESET_TRACKING;
+    /*                                                 */ TRACK_STR(s);
+    str_splice(&s, 4, 0, s, 8);
+    ASSERT_STR_PROPS(s, "abcdabcdefghefgh", 16);
+    /*                                                 */ ASSERT_ALLOC(16, s);
+    /*                                                 */ ASSERT_FREE;
+  }
+  {
+    /* a read-only str is copied once */
+    str r = file_lit;
+    /*                                                 */ RESET_TRACKING;
+    str_splice(&r, 0, 4, r + 5, 5);
+    ASSERT_STR_PROPS(r, "scope scope", 11);
+    ASSERT_STR_PROPS(file_lit, "file scope", 10);
+    /*                                                 */ ASSERT_ALLOC(11, r);
+    /*                                                 */ ASSERT_NO_FREE;
+    str_free(&r);
+  }
+  str_free(&s);
+}
+
+TEST(substr) {
+  str s = str_new("hello, world");
+  {
+    /*                                                 */ RESET_TRACKING;
+    str_substr(&s, 7, 5);
+    ASSERT_STR_PROPS(s, "world", 12);
+    str_substr(&s, 0, 4);
+    ASSERT_STR_PROPS(s, "worl", 12);
+    str_substr(&s, 1, 100); /* clamped */
+    ASSERT_STR_PROPS(s, "orl", 12);
+    str_substr(&s, 0, 3);
+    ASSERT_STR_PROPS(s, "orl", 12);
+    str_substr(&s, 5, 2); /* past the end */
+    ASSERT_STR_PROPS(s, "", 12);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+  }
+  {
+    /* a read-only str is copied once, unless it is kept whole */
+    str r = file_lit;
+    /*                                                 */ RESET_TRACKING;
+    str_substr(&r, 0, 10);
+    ASSERT_EQ(r, file_lit);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    str_substr(&r, 5, 5);
+    ASSERT_STR_PROPS(r, "scope", 10);
+    ASSERT_STR_PROPS(file_lit, "file scope", 10);
+    /*                                                 */ ASSERT_ALLOC(10, r);
+    /*                                                 */ ASSERT_NO_FREE;
+    str_free(&r);
+  }
+  str_free(&s);
+}
+
+#define STR_CPYLOWER_TEST(str_cpylower_fn, HeLLo, header, blank)           \
+  str s = str_alloc(0);                                                    \
+  /*                                                   */ RESET_TRACKING;  \
+  /*                                                   */ TRACK_STR(s);    \
+  str_cpylower_fn(&s, HeLLo);                                              \
+  ASSERT_STR_PROPS(s, "hello, [world]@\xc9", 16);                          \
+  /*                                                   */ ASSERT_ALLOC(    \
+  /*                                                   */     16, s);      \
+  /*                                                   */ ASSERT_FREE;     \
+                                                                           \
+  /*                                                   */ RESET_TRACKING;  \
+  str_cpylower_fn(&s, header);                                             \
+  ASSERT_STR_PROPS(s, "content-type", 16);                                 \
+  str_cpylower_fn(&s, blank);                                              \
+  ASSERT_STR_PROPS(s, "", 16);                                             \
+  /*                                                   */ ASSERT_NO_ALLOC; \
+  /*                                                   */ ASSERT_NO_FREE;  \
+  str_free(&s)
+
+TEST(cpylower) {
+  STR_CPYLOWER_TEST(str_cpylower, "HeLLo, [WORLD]@\xc9", "Content-Type", "");
+}
+
+TEST(cpylower_) {
+  str HeLLo  = str_new("HeLLo, [WORLD]@\xc9");
+  str header = str_new("Content-Type");
+  str blank  = str_new("");
+
+  STR_CPYLOWER_TEST(str_cpylower_, HeLLo, header, blank);
+
+  str_cpylower_(&header, header);
+  ASSERT_STR_PROPS(header, "content-type", 12);
+
+  str_free(&HeLLo);
+  str_free(&header);
+  str_free(&blank);
+}
+
+#define STR_CPYUPPER_TEST(str_cpyupper_fn, HeLLo, header, blank)           \
+  str s = str_alloc(0);                                                    \
+  /*                                                   */ RESET_TRACKING;  \
+  /*                                                   */ TRACK_STR(s);    \
+  str_cpyupper_fn(&s, HeLLo);                                              \
+  ASSERT_STR_PROPS(s, "HELLO, {WORLD}`\xe9", 16);                          \
+  /*                                                   */ ASSERT_ALLOC(    \
+  /*                                                   */     16, s);      \
+  /*                                                   */ ASSERT_FREE;     \
+                                                                           \
+  /*                                                   */ RESET_TRACKING;  \
+  str_cpyupper_fn(&s, header);                                             \
+  ASSERT_STR_PROPS(s, "CONTENT-TYPE", 16);                                 \
+  str_cpyupper_fn(&s, blank);                                              \
+  ASSERT_STR_PROPS(s, "", 16);                                             \
+  /*                                                   */ ASSERT_NO_ALLOC; \
+  /*                                                   */ ASSERT_NO_FREE;  \
+  str_free(&s)
+
+TEST(cpyupper) {
+  STR_CPYUPPER_TEST(str_cpyupper, "HeLLo, {world}`\xe9", "Content-Type", "");
+}
+
+TEST(cpyupper_) {
+  str HeLLo  = str_new("HeLLo, {world}`\xe9");
+  str header = str_new("Content-Type");
+  str blank  = str_new("");
+
+  STR_CPYUPPER_TEST(str_cpyupper_, HeLLo, header, blank);
+
+  str_cpyupper_(&header, header);
+  ASSERT_STR_PROPS(header, "CONTENT-TYPE", 12);
+
+  str_free(&HeLLo);
+  str_free(&header);
+  str_free(&blank);
+}
+
+TEST(tolower) {
+  str s = str_new("Content-Type: TEXT/html; [charset]=@UTF-8 \xc9");
+  /*                                                   */ RESET_TRACKING;
+  str_tolower(&s);
+  ASSERT_STR_PROPS(s, "content-type: text/html; [charset]=@utf-8 \xc9", 43);
+  str_tolower(&s);
+  ASSERT_STR_PROPS(s, "content-type: text/html; [charset]=@utf-8 \xc9", 43);
+  /*                                                   */ ASSERT_NO_ALLOC;
+  /*                                                   */ ASSERT_NO_FREE;
+  str_free(&s);
+}
+
+TEST(toupper) {
+  str s = str_new("Content-Type: TEXT/html; {charset}=`utf-8 \xe9");
+  /*                                                   */ RESET_TRACKING;
+  str_toupper(&s);
+  ASSERT_STR_PROPS(s, "CONTENT-TYPE: TEXT/HTML; {CHARSET}=`UTF-8 \xe9", 43);
+  str_toupper(&s);
+  ASSERT_STR_PROPS(s, "CONTENT-TYPE: TEXT/HTML; {CHARSET}=`UTF-8 \xe9", 43);
+  /*                                                   */ ASSERT_NO_ALLOC;
+  /*                                                   */ ASSERT_NO_FREE;
+  str_free(&s);
+}
+
+TEST(cpad) {
+  str s = str_alloc(0);
+  {
+    /*                                                 */ RESET_TRACKING;
+    /*                                                 */ TRACK_STR(s);
+    str_cpad(&s, 3);
+    ASSERT_STR_PROPS(s, "   ", 3);
+    /*                                                 */ ASSERT_ALLOC(3, s);
+    /*                                                 */ ASSERT_FREE;
+    str_emplace(&s, "<--->", 0);
+    str_realloc(&s, 11);
+    /*                                                 */ RESET_TRACKING;
+    str_cpad(&s, 11);
+    ASSERT_STR_PROPS(s, "   <--->   ", 11);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+
+    /*                                                 */ RESET_TRACKING;
     /*                                                 */ TRACK_STR(s);
     str_cpad(&s, 14);
     ASSERT_STR_PROPS(s, "    <--->     ", 14);
@@ -639,6 +2044,33 @@ TEST(cpad) {
   str_free(&s);
 }
 
+TEST(cpadf) {
+  str s = str_new("ab");
+  {
+    /*                                                 */ RESET_TRACKING;
+    /*                                                 */ TRACK_STR(s);
+    str_cpadf(&s, 9, "-=", STR_PAD_BYTES);
+    ASSERT_STR_PROPS(s, "-=-ab-=-=", 9);
+    /*                                                 */ ASSERT_ALLOC(9, s);
+    /*                                                 */ ASSERT_FREE;
+
+    /*                                                 */ RESET_TRACKING;
+    str_cpadf(&s, 9, "*", STR_PAD_BYTES);
+    str_cpadf(&s, 12, "", STR_PAD_BYTES);
+    ASSERT_STR_PROPS(s, "-=-ab-=-=", 9);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+
+    /* "\xc2\xb7" is a middle dot: one codepoint, two bytes */
+    str_cpylower(&s, "caf\xc3\xa9");
+    str_cpadf(&s, 8, "\xc2\xb7", STR_PAD_CODEPOINTS);
+    ASSERT_STREQ(s, "\xc2\xb7\xc2\xb7" "caf\xc3\xa9\xc2\xb7\xc2\xb7");
+    ASSERT_EQ(str_utf8_len(s), 8);
+    ASSERT_EQ(str_len(s), 13);
+  }
+  str_free(&s);
+}
+
 TEST(lpad) {
   str s = str_alloc(0);
   {
@@ -666,6 +2098,28 @@ TEST(lpad) {
   str_free(&s);
 }
 
+TEST(lpadf) {
+  str s = str_new("42");
+  {
+    /*                                                 */ RESET_TRACKING;
+    /*                                                 */ TRACK_STR(s);
+    str_lpadf(&s, 7, "0", STR_PAD_BYTES);
+    ASSERT_STR_PROPS(s, "0000042", 7);
+    /*                                                 */ ASSERT_ALLOC(7, s);
+    /*                                                 */ ASSERT_FREE;
+
+    /* patterns are cut at a codepoint boundary */
+    str_cpylower(&s, "\xe2\x82\xac");
+    str_lpadf(&s, 5, "\xc2\xb7-", STR_PAD_CODEPOINTS);
+    ASSERT_STREQ(s, "\xc2\xb7-\xc2\xb7-\xe2\x82\xac");
+    str_lpadf(&s, 6, "\xc2\xb7-", STR_PAD_CODEPOINTS);
+    ASSERT_STREQ(s, "\xc2\xb7\xc2\xb7-\xc2\xb7-\xe2\x82\xac");
+    str_lpadf(&s, 6, "\xc2\xb7-", STR_PAD_CODEPOINTS);
+    ASSERT_EQ(str_len(s), 11);
+  }
+  str_free(&s);
+}
+
 TEST(rpad) {
   str s = str_alloc(0);
   {
@@ -693,6 +2147,25 @@ TEST(rpad) {
   str_free(&s);
 }
 
+TEST(rpadf) {
+  str s = str_new("ab");
+  {
+    /*                                                 */ RESET_TRACKING;
+    /*                                                 */ TRACK_STR(s);
+    str_rpadf(&s, 10, "abc", STR_PAD_BYTES);
+    ASSERT_STR_PROPS(s, "ababcabcab", 10);
+    /*                                                 */ ASSERT_ALLOC(10, s);
+    /*                                                 */ ASSERT_FREE;
+
+    str_cpylower(&s, "na\xc3\xafve");
+    str_rpadf(&s, 7, "\xe2\x94\x80", STR_PAD_CODEPOINTS); /* box drawing */
+    ASSERT_STREQ(s, "na\xc3\xafve\xe2\x94\x80\xe2\x94\x80");
+    str_rpadf(&s, 7, "\xe2\x94\x80", STR_PAD_BYTES); /* 12 bytes already */
+    ASSERT_EQ(str_len(s), 12);
+  }
+  str_free(&s);
+}
+
 TEST(trim) {
   str s = str_alloc(0);
   {
@@ -725,6 +2198,12 @@ TEST(trim) {
     ASSERT_STR_PROPS(s, ":)", 6);
     /*                                                 */ ASSERT_NO_ALLOC;
     /*                                                 */ ASSERT_NO_FREE;
+    str_emplace(&s, " \t\n ", 0);
+    /*                                                 */ RESET_TRACKING;
+    str_trim(&s);
+    ASSERT_STR_PROPS(s, "", 6);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
   }
   str_free(&s);
 }
@@ -772,6 +2251,7 @@ TEST(fit) {
 TEST(grow) {
   str s = str_alloc(0);
   {
+    size_t msize;
     /*                                                 */ RESET_TRACKING;
     /*                                                 */ TRACK_STR(s);
     str_grow(&s, 1);
@@ -785,6 +2265,9 @@ TEST(grow) {
     ASSERT_STR_PROPS(s, "foo", 5);
     /*                                                 */ ASSERT_ALLOC(5, s);
     /*                                                 */ ASSERT_FREE;
+    msize = str_msize(s);
+    str_grow(&s, 3);
+    ASSERT_EQ(str_msize(s), msize + 3);
   }
   str_free(&s);
 }
@@ -823,6 +2306,78 @@ TEST(realloc) {
   str_free(&s);
 }
 
+#ifdef STR_CONFIG_MMAP_THRESHOLD
+TEST(realloc_mapped) {
+  str    s = str_alloc(8192);
+  str    d;
+  size_t i;
+  for (i = 0; i < 512; ++i)
+    str_append(&s, "0123456789abcdef");
+  ASSERT_EQ(str_cap(s), 8192);
+  ASSERT_EQ(str_len(s), 8192);
+  d = str_dup(s); /* mapped as well */
+  ASSERT_EQ(str_cap(d), 8192);
+  ASSERT_TRUE(str_eq_(s, d));
+  {
+#ifdef STR_CONFIG_STATS
+    str_stats st;
+    str_stats_reset();
+#endif
+    str_realloc(&s, 1 << 20);
+    ASSERT_EQ(str_cap(s), 1 << 20);
+    ASSERT_TRUE(str_eq_(s, d));
+#ifdef STR_CONFIG_STATS
+    str_stats_get(&st);
+    ASSERT_EQ(st.fn[STR_STATS_REALLOC].reallocs, 1);
+    ASSERT_EQ(st.fn[STR_STATS_REALLOC].allocs, 1);
+    ASSERT_EQ(st.fn[STR_STATS_REALLOC].frees, 1);
+#ifdef MREMAP_MAYMOVE
+    ASSERT_EQ(st.fn[STR_STATS_REALLOC].bytes_copied, 0);
+#endif
+    ASSERT_EQ(st.fn[STR_STATS_REALLOC].slack, (1 << 20) - 8192);
+#endif
+  }
+  {
+    str_realloc(&s, 5000); /* stays mapped; truncated */
+    ASSERT_EQ(str_cap(s), 5000);
+    ASSERT_EQ(str_len(s), 5000);
+    ASSERT_EQ(s[5000], '\0');
+    ASSERT_EQ(strncmp(s, d, 5000), 0);
+    str_realloc(&s, 100); /* allocated */
+    ASSERT_EQ(str_cap(s), 100);
+    ASSERT_EQ(strncmp(s, d, 100), 0);
+    str_append(&s, d + 100); /* mapped again */
+    ASSERT_TRUE(str_eq_(s, d));
+  }
+#if defined MREMAP_MAYMOVE && defined STR_CONFIG_TRACE
+  {
+    /* a remap is traced as a free and a new block */
+    str_trace_record r;
+    FILE            *fp = tmpfile();
+    size_t           id = (size_t)s;
+    str_trace_start(fp);
+    str_grow(&s, 1 << 20);
+    str_trace_stop();
+    rewind(fp);
+    ASSERT_TRUE(str_trace_read(fp, &r));
+    ASSERT_EQ(r.fn, STR_STATS_GROW);
+    ASSERT_EQ(r.id, id);
+    ASSERT_EQ(r.to, 0);
+    ASSERT_TRUE(str_trace_read(fp, &r));
+    ASSERT_EQ(r.id, 0);
+    ASSERT_EQ(r.to, (size_t)s);
+    ASSERT_EQ(r.cap, str_cap(s));
+    ASSERT_EQ(r.len, 8192);
+    ASSERT_FALSE(str_trace_read(fp, &r));
+    fclose(fp);
+  }
+#endif
+  str_free(&s);
+  ASSERT_EQ(s, NULL);
+  str_free(&d);
+}
+#endif
+
 TEST(shrink) {
   str s = str_alloc(0);
   {
@@ -886,70 +2441,1533 @@ TEST(shrinkfit) {
   str_free(&s);
 }
 
-TEST(free) {
+TEST(edit_begin) {
+  str s = str_new("foobar");
+  str_grow(&s, 4);
   {
-    str s = str_alloc(0);
+    str_edit e;
     /*                                                 */ RESET_TRACKING;
-    /*                                                 */ TRACK_STR(s);
-    str_free(&s);
-    ASSERT_EQ(s, NULL);
+    str_edit_begin(&e, &s, 3);
+    ASSERT_EQ(e.s, &s);
+    ASSERT_EQ(e.gap, 3);
+    ASSERT_EQ(e.end, 7);
+    ASSERT_EQ(memcmp(s, "foo", 3), 0);
+    ASSERT_EQ(memcmp(&s[7], "bar", 3), 0);
     /*                                                 */ ASSERT_NO_ALLOC;
-    /*                                                 */ ASSERT_FREE;
+    /*                                                 */ ASSERT_NO_FREE;
+    str_edit_commit(&e);
+    ASSERT_STR_PROPS(s, "foobar", 10);
   }
+  str_free(&s);
+}
+
+TEST(edit_commit) {
+  str s = str_new("foobar");
   {
-    str s = str_alloc(3);
+    str_edit e;
+    str_edit_begin(&e, &s, 6);
     /*                                                 */ RESET_TRACKING;
-    /*                                                 */ TRACK_STR(s);
-    str_free(&s);
-    ASSERT_EQ(s, NULL);
+    str_edit_commit(&e);
+    ASSERT_STR_PROPS(s, "foobar", 6);
     /*                                                 */ ASSERT_NO_ALLOC;
-    /*                                                 */ ASSERT_FREE;
+    /*                                                 */ ASSERT_NO_FREE;
+    str_grow(&s, 3);
+    str_edit_begin(&e, &s, 0);
+    str_edit_erase(&e, 3);
+    /*                                                 */ RESET_TRACKING;
+    str_edit_commit(&e);
+    ASSERT_STR_PROPS(s, "bar", 9);
+    ASSERT_EQ(e.gap, 3);
+    ASSERT_EQ(e.end, 3);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
   }
+  str_free(&s);
+}
+
+TEST(edit_erase) {
+  str s = str_new("foobarbaz");
   {
-    str s = str_new("finished testing! :D");
+    str_edit e;
+    str_edit_begin(&e, &s, 3);
     /*                                                 */ RESET_TRACKING;
-    /*                                                 */ TRACK_STR(s);
+    str_edit_erase(&e, 3);
+    ASSERT_EQ(str_edit_len(&e), 6);
+    str_edit_erase(&e, 0);
+    ASSERT_EQ(str_edit_len(&e), 6);
+    str_edit_erase(&e, 10); /* stops at the end of the text */
+    ASSERT_EQ(str_edit_len(&e), 3);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+    str_edit_commit(&e);
+    ASSERT_STR_PROPS(s, "foo", 9);
+  }
+  str_free(&s);
+}
+
+#define STR_EDIT_INSERT_TEST(str_edit_insert_fn, comma, dear, bang, blank)     \
+  str s = str_new("hello world");                                              \
+  str_edit e;                                                                  \
+  str_edit_begin(&e, &s, 5);                                                   \
+  /*                                                   */ RESET_TRACKING;      \
+  /*                                                   */ TRACK_STR(s);        \
+  str_edit_insert_fn(&e, comma);                                               \
+  ASSERT_EQ(e.gap, 6);                                                         \
+  ASSERT_EQ(str_edit_len(&e), 12);                                             \
+  /*                                                   */ ASSERT_ALLOC(22, s); \
+  /*                                                   */ ASSERT_FREE;         \
+                                                                               \
+  /*                                                   */ RESET_TRACKING;      \
+  str_edit_insert_fn(&e, dear);                                                \
+  str_edit_insert_fn(&e, blank);                                               \
+  ASSERT_EQ(e.gap, 11);                                                        \
+  ASSERT_EQ(str_edit_len(&e), 17);                                             \
+  /*                                                   */ ASSERT_NO_ALLOC;     \
+  /*                                                   */ ASSERT_NO_FREE;      \
+  str_edit_seek(&e, 17);                                                       \
+  str_edit_insert_fn(&e, bang);                                                \
+  str_edit_commit(&e);                                                         \
+  ASSERT_STR_PROPS(s, "hello, dear world!", 22);                               \
+  str_free(&s)
+
+TEST(edit_insert) {
+  STR_EDIT_INSERT_TEST(str_edit_insert, ",", " dear", "!", "");
+}
+
+TEST(edit_insert_) {
+  str comma = str_new(",");
+  str dear  = str_new(" dear");
+  str bang  = str_new("!");
+  str blank = str_new("");
+
+  STR_EDIT_INSERT_TEST(str_edit_insert_, comma, dear, bang, blank);
+
+  str_free(&comma);
+  str_free(&dear);
+  str_free(&bang);
+  str_free(&blank);
+}
+
+TEST(edit_len) {
+  str s = str_new("foo");
+  {
+    str_edit e;
+    str_edit_begin(&e, &s, 1);
+    /*                                                 */ RESET_TRACKING;
+    ASSERT_EQ(str_edit_len(&e), 3);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+    str_edit_insert(&e, "bar");
+    ASSERT_EQ(str_edit_len(&e), 6);
+    str_edit_erase(&e, 1);
+    ASSERT_EQ(str_edit_len(&e), 5);
+    str_edit_commit(&e);
+    ASSERT_STR_PROPS(s, "fbaro", 6);
+  }
+  str_free(&s);
+}
+
+TEST(edit_seek) {
+  str s = str_new("abcdef");
+  str_grow(&s, 3);
+  {
+    str_edit e;
+    str_edit_begin(&e, &s, 0);
+    /*                                                 */ RESET_TRACKING;
+    str_edit_seek(&e, 3);
+    str_edit_insert(&e, "X");
+    str_edit_seek(&e, 1);
+    str_edit_insert(&e, "Y");
+    str_edit_seek(&e, 8);
+    str_edit_insert(&e, "Z");
+    str_edit_seek(&e, 8);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+    str_edit_commit(&e);
+    ASSERT_STR_PROPS(s, "aYbcXdefZ", 9);
+  }
+  str_free(&s);
+}
+
+#define STR_BUILDER_APPEND_TEST(str_builder_append_fn, foo, barbazqux, blank) \
+  str_builder b;                                                            \
+  str_builder_init(&b);                                                     \
+  /*                                                   */ RESET_TRACKING;   \
+  str_builder_append_fn(&b, foo);                                           \
+  ASSERT_EQ(b.nsegs, 1);                                                    \
+  ASSERT_STR_PROPS(b.segs[0], "foo", 8);                                    \
+  /*                                                   */ ASSERT_ALLOC(     \
+  /*                                                   */   8, b.segs[0]);  \
+  /*                                                   */ ASSERT_NO_FREE;   \
+                                                                            \
+  /*                                                   */ RESET_TRACKING;   \
+  str_builder_append_fn(&b, barbazqux); /* fills, then one new segment */   \
+  ASSERT_EQ(b.nsegs, 2);                                                    \
+  ASSERT_STR_PROPS(b.segs[0], "foobarba", 8);                               \
+  ASSERT_STR_PROPS(b.segs[1], "zqux", 8);                                   \
+  /*                                                   */ ASSERT_ALLOC(     \
+  /*                                                   */   8, b.segs[1]);  \
+  /*                                                   */ ASSERT_NO_FREE;   \
+                                                                            \
+  /*                                                   */ RESET_TRACKING;   \
+  str_builder_append_fn(&b, blank);                                         \
+  ASSERT_EQ(str_builder_len(&b), 12);                                       \
+  /*                                                   */ ASSERT_NO_ALLOC;  \
+  /*                                                   */ ASSERT_NO_FREE;   \
+  str_builder_free(&b)
+
+TEST(builder_append) {
+  STR_BUILDER_APPEND_TEST(str_builder_append, "foo", "barbazqux", "");
+}
+
+TEST(builder_append_) {
+  str foo       = str_new("foo");
+  str barbazqux = str_new("barbazqux");
+  str blank     = str_new("");
+
+  STR_BUILDER_APPEND_TEST(str_builder_append_, foo, barbazqux, blank);
+
+  str_free(&foo);
+  str_free(&barbazqux);
+  str_free(&blank);
+}
+
+TEST(builder_finish) {
+  str_builder b;
+  str_builder_init(&b);
+  {
+    str s;
+    /*                                                 */ RESET_TRACKING;
+    s = str_builder_finish(&b);
+    ASSERT_STR_PROPS(s, "", 0);
+    /*                                                 */ ASSERT_ALLOC(0, s);
+    /*                                                 */ ASSERT_NO_FREE;
     str_free(&s);
-    ASSERT_EQ(s, NULL);
+
+    str_builder_append(&b, "the quick brown ");
+    str_builder_append(&b, "fox");
+    /*                                                 */ RESET_TRACKING;
+    s = str_builder_finish(&b);
+    ASSERT_STR_PROPS(s, "the quick brown fox", 19);
+    ASSERT_EQ(b.nsegs, 0);
+    ASSERT_EQ(b.segs, NULL);
+    ASSERT_EQ(str_builder_len(&b), 0);
+    /*                                                 */ ASSERT_ALLOC(19, s);
+    str_free(&s);
+  }
+}
+
+TEST(builder_free) {
+  str_builder b;
+  str_builder_init(&b);
+  {
+    /*                                                 */ RESET_TRACKING;
+    str_builder_free(&b);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+    str_builder_append(&b, "foo");
+    /*                                                 */ RESET_TRACKING;
+    str_builder_free(&b);
+    ASSERT_EQ(b.segs, NULL);
+    ASSERT_EQ(b.nsegs, 0);
+    ASSERT_EQ(str_builder_len(&b), 0);
     /*                                                 */ ASSERT_NO_ALLOC;
-    /*                                                 */ ASSERT_FREE;
   }
 }
 
-/*.----------------------------------------------------------------------------,
- /                                    main                                   */
+TEST(builder_init) {
+  str_builder b;
+  /*                                                   */ RESET_TRACKING;
+  str_builder_init(&b);
+  ASSERT_EQ(b.segs, NULL);
+  ASSERT_EQ(b.nsegs, 0);
+  ASSERT_EQ(b.avail, 0);
+  ASSERT_EQ(str_builder_len(&b), 0);
+  /*                                                   */ ASSERT_NO_ALLOC;
+  /*                                                   */ ASSERT_NO_FREE;
+}
 
-TEST_MAIN {
-  RUN_TEST(alloc);
-  RUN_TEST(dup);
-  RUN_TEST(new);
-  RUN_TEST(sub);
-  RUN_TEST(avail);
-  RUN_TEST(cap);
-  RUN_TEST(end);
-  RUN_TEST(len);
-  RUN_TEST(mbegin);
-  RUN_TEST(mend);
-  RUN_TEST(msize);
-  RUN_TEST(mstr);
-  RUN_TEST(append);
-  RUN_TEST(append_);
-  RUN_TEST(prepend);
-  RUN_TEST(prepend_);
-  RUN_TEST(emplace);
-  RUN_TEST(emplace_);
-  RUN_TEST(insert);
-  RUN_TEST(insert_);
-  RUN_TEST(cpad);
-  RUN_TEST(lpad);
-  RUN_TEST(rpad);
-  RUN_TEST(trim);
-  RUN_TEST(clear);
-  RUN_TEST(fit);
-  RUN_TEST(grow);
-  RUN_TEST(realloc);
+TEST(builder_len) {
+  str_builder b;
+  str_builder_init(&b);
+  {
+    str_builder_append(&b, "foobarbaz");
+    /*                                                 */ RESET_TRACKING;
+    ASSERT_EQ(str_builder_len(&b), 9);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+  }
+  str_builder_free(&b);
+}
+
+TEST(builder_reserve) {
+  str_builder b;
+  str_builder_init(&b);
+  {
+    /*                                                 */ RESET_TRACKING;
+    str_builder_reserve(&b, 20);
+    ASSERT_EQ(b.nsegs, 1);
+    ASSERT_EQ(b.avail, 20);
+    /*                                                 */ ASSERT_ALLOC(
+    /*                                                 */     20, b.segs[0]);
+    /*                                                 */ ASSERT_NO_FREE;
+
+    /*                                                 */ RESET_TRACKING;
+    str_builder_reserve(&b, 20);
+    str_builder_append(&b, "twenty chars of text");
+    ASSERT_EQ(b.avail, 0);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+
+    /*                                                 */ RESET_TRACKING;
+    str_builder_reserve(&b, 1); /* at least one segment */
+    ASSERT_EQ(b.nsegs, 2);
+    ASSERT_EQ(b.avail, 8);
+    /*                                                 */ ASSERT_ALLOC(
+    /*                                                 */     8, b.segs[1]);
+    /*                                                 */ ASSERT_NO_FREE;
+  }
+  str_builder_free(&b);
+}
+
+#ifdef STR_CONFIG_POSIX
+TEST(builder_writev) {
+  str_builder b;
+  str_builder_init(&b);
+  {
+    int  fds[2];
+    char buf[64];
+    ASSERT_EQ(pipe(fds), 0);
+    /*                                                 */ RESET_TRACKING;
+    ASSERT_EQ(str_builder_writev(&b, fds[1]), 0);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+    str_builder_append(&b, "the quick brown ");
+    str_builder_append(&b, "fox ");
+    str_builder_reserve(&b, 32);
+    str_builder_append(&b, "jumps");
+    /*                                                 */ RESET_TRACKING;
+    ASSERT_EQ(str_builder_writev(&b, fds[1]), 0);
+    ASSERT_EQ(read(fds[0], buf, sizeof(buf)), 25);
+    ASSERT_EQ(memcmp(buf, "the quick brown fox jumps", 25), 0);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+    close(fds[0]);
+    close(fds[1]);
+  }
+  str_builder_free(&b);
+}
+#endif
+
+TEST(vec_free) {
+  str_vec v;
+  str_vec_init(&v);
+  {
+    /*                                                 */ RESET_TRACKING;
+    str_vec_free(&v);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+    str_vec_push(&v, "foo");
+    /*                                                 */ RESET_TRACKING;
+    str_vec_free(&v);
+    ASSERT_EQ(v.data, NULL);
+    ASSERT_EQ(v.offs, NULL);
+    ASSERT_EQ(str_vec_len(&v), 0);
+    /*                                                 */ ASSERT_NO_ALLOC;
+  }
+}
+
+TEST(vec_get) {
+  str_vec v;
+  str_vec_init(&v);
+  {
+    size_t len = 99;
+    ASSERT_EQ(str_vec_get(&v, 0, &len), NULL);
+    ASSERT_EQ(len, 99);
+    str_vec_push(&v, "foo");
+    str_vec_push(&v, "");
+    str_vec_push(&v, "barbaz");
+    /*                                                 */ RESET_TRACKING;
+    ASSERT_STREQ(str_vec_get(&v, 0, &len), "foo");
+    ASSERT_EQ(len, 3);
+    ASSERT_STREQ(str_vec_get(&v, 1, &len), "");
+    ASSERT_EQ(len, 0);
+    ASSERT_STREQ(str_vec_get(&v, 2, NULL), "barbaz");
+    ASSERT_EQ(str_vec_get(&v, 3, &len), NULL);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+  }
+  str_vec_free(&v);
+}
+
+TEST(vec_get_str) {
+  str_vec v;
+  str_vec_init(&v);
+  {
+    str s;
+    str_vec_push(&v, "foo");
+    str_vec_push(&v, "barbaz");
+    /*                                                 */ RESET_TRACKING;
+    s = str_vec_get_str(&v, 1);
+    ASSERT_STR_PROPS(s, "barbaz", 6);
+    /*                                                 */ ASSERT_ALLOC(6, s);
+    /*                                                 */ ASSERT_NO_FREE;
+    str_free(&s);
+    ASSERT_EQ(str_vec_get_str(&v, 2), NULL);
+  }
+  str_vec_free(&v);
+}
+
+TEST(vec_init) {
+  str_vec v;
+  /*                                                   */ RESET_TRACKING;
+  str_vec_init(&v);
+  ASSERT_EQ(v.data, NULL);
+  ASSERT_EQ(v.offs, NULL);
+  ASSERT_EQ(v.ocap, 0);
+  ASSERT_EQ(str_vec_len(&v), 0);
+  /*                                                   */ ASSERT_NO_ALLOC;
+  /*                                                   */ ASSERT_NO_FREE;
+}
+
+TEST(vec_len) {
+  str_vec v;
+  str_vec_init(&v);
+  {
+    str_vec_push(&v, "foo");
+    str_vec_push(&v, "bar");
+    /*                                                 */ RESET_TRACKING;
+    ASSERT_EQ(str_vec_len(&v), 2);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+  }
+  str_vec_free(&v);
+}
+
+TEST(vec_pop) {
+  str_vec v;
+  str_vec_init(&v);
+  {
+    str_vec_pop(&v);
+    ASSERT_EQ(str_vec_len(&v), 0);
+    str_vec_push(&v, "foo");
+    str_vec_push(&v, "barbaz");
+    /*                                                 */ RESET_TRACKING;
+    str_vec_pop(&v);
+    ASSERT_EQ(str_vec_len(&v), 1);
+    ASSERT_EQ(str_len(v.data), 4);
+    ASSERT_EQ(str_cap(v.data), 11);
+    ASSERT_EQ(str_vec_get(&v, 1, NULL), NULL);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+    str_vec_push(&v, "qux");
+    ASSERT_STREQ(str_vec_get(&v, 1, NULL), "qux");
+    str_vec_pop(&v);
+    str_vec_pop(&v);
+    ASSERT_EQ(str_vec_len(&v), 0);
+    ASSERT_EQ(str_len(v.data), 0);
+  }
+  str_vec_free(&v);
+}
+
+#define STR_VEC_PUSH_TEST(str_vec_push_fn, foo, barbaz, blank)           \
+  str_vec v;                                                            \
+  str_vec_init(&v);                                                     \
+  str_vec_push_fn(&v, foo);                                             \
+  ASSERT_EQ(str_vec_len(&v), 1);                                        \
+  ASSERT_EQ(v.ocap, 1);                                                 \
+  ASSERT_EQ(str_len(v.data), 4);                                        \
+  ASSERT_EQ(str_cap(v.data), 4);                                        \
+                                                                        \
+  str_vec_push_fn(&v, barbaz); /* both buffers double at least */       \
+  ASSERT_EQ(str_vec_len(&v), 2);                                        \
+  ASSERT_EQ(v.ocap, 2);                                                 \
+  ASSERT_EQ(str_len(v.data), 11);                                       \
+  ASSERT_EQ(str_cap(v.data), 11);                                       \
+  ASSERT_EQ(memcmp(v.data, "foo\0barbaz\0", 12), 0);                    \
+                                                                        \
+  str_vec_push_fn(&v, blank);                                           \
+  str_vec_push_fn(&v, blank);                                           \
+  ASSERT_EQ(v.ocap, 4);                                                 \
+  str_vec_push_fn(&v, blank); /* room in data, not in offs */           \
+  ASSERT_EQ(str_len(v.data), 14);                                       \
+  ASSERT_EQ(str_cap(v.data), 22);                                       \
+  ASSERT_EQ(v.ocap, 8);                                                 \
+  ASSERT_EQ(v.offs[5], 14);                                             \
+  ASSERT_STREQ(str_vec_get(&v, 4, NULL), "");                           \
+  ASSERT_STREQ(str_vec_get(&v, 1, NULL), "barbaz");                     \
+  str_vec_free(&v)
+
+TEST(vec_push) {
+  STR_VEC_PUSH_TEST(str_vec_push, "foo", "barbaz", "");
+}
+
+TEST(vec_push_) {
+  str foo    = str_new("foo");
+  str barbaz = str_new("barbaz");
+  str blank  = str_new("");
+
+  STR_VEC_PUSH_TEST(str_vec_push_, foo, barbaz, blank);
+
+  str_free(&foo);
+  str_free(&barbaz);
+  str_free(&blank);
+}
+
+TEST(vec_split) {
+  str_vec v;
+  str_vec_init(&v);
+  {
+    size_t len;
+    str_vec_split(&v, "", 0, '\n');
+    ASSERT_EQ(str_vec_len(&v), 0);
+    ASSERT_EQ(v.data, NULL);
+
+    str_vec_split(&v, "ab\n\ncde\nf", 9, '\n'); /* offs grows in the scan */
+    ASSERT_EQ(str_vec_len(&v), 4);
+    ASSERT_EQ(str_len(v.data), 10);
+    ASSERT_EQ(memcmp(v.data, "ab\0\0cde\0f\0", 11), 0);
+    ASSERT_STREQ(str_vec_get(&v, 0, &len), "ab");
+    ASSERT_EQ(len, 2);
+    ASSERT_STREQ(str_vec_get(&v, 1, &len), "");
+    ASSERT_EQ(len, 0);
+    ASSERT_STREQ(str_vec_get(&v, 2, &len), "cde");
+    ASSERT_EQ(len, 3);
+    ASSERT_STREQ(str_vec_get(&v, 3, &len), "f");
+    ASSERT_EQ(len, 1);
+
+    /* appends; a trailing delim does not start a field */
+    str_vec_split(&v, "g,h,", 4, ',');
+    ASSERT_EQ(str_vec_len(&v), 6);
+    ASSERT_STREQ(str_vec_get(&v, 4, NULL), "g");
+    ASSERT_STREQ(str_vec_get(&v, 5, NULL), "h");
+    ASSERT_EQ(str_len(v.data), 14);
+    str_vec_split(&v, ",", 1, ',');
+    ASSERT_EQ(str_vec_len(&v), 7);
+    ASSERT_STREQ(str_vec_get(&v, 6, &len), "");
+    ASSERT_EQ(len, 0);
+    str_vec_pop(&v);
+    str_vec_push(&v, "i");
+    ASSERT_STREQ(str_vec_get(&v, 6, NULL), "i");
+    ASSERT_STREQ(str_vec_get(&v, 3, NULL), "f");
+  }
+  str_vec_free(&v);
+}
+
+/* reference order for str_sort: bytes, then length */
+static int
+cmp_str(const void *a, const void *b) {
+  str    x   = *(const str *)a;
+  str    y   = *(const str *)b;
+  size_t min = str_len(x) < str_len(y) ? str_len(x) : str_len(y);
+  int    cmp = memcmp(x, y, min);
+  if (cmp != 0)
+    return cmp;
+  return str_len(x) < str_len(y) ? -1 : str_len(x) > str_len(y);
+}
+
+TEST(sort) {
+  str    small[5];
+  str    arr[600];
+  str    ref[600];
+  size_t i;
+  small[0] = str_new("foo");
+  small[1] = str_new("");
+  small[2] = str_new("fo");
+  small[3] = str_new("bar");
+  small[4] = str_new("foo");
+  /*                                                   */ RESET_TRACKING;
+  str_sort(small, 0);
+  str_sort(small, 5);
+  ASSERT_STREQ(small[0], "");
+  ASSERT_STREQ(small[1], "bar");
+  ASSERT_STREQ(small[2], "fo");
+  ASSERT_STREQ(small[3], "foo");
+  ASSERT_STREQ(small[4], "foo");
+  /*                                                   */ ASSERT_NO_ALLOC;
+  /*                                                   */ ASSERT_NO_FREE;
+  for (i = 0; i < 5; ++i)
+    str_free(&small[i]);
+
+  /* shared prefixes, duplicates, null bytes, and high bytes */
+  srand(7);
+  for (i = 0; i < 600; ++i) {
+    size_t len = (size_t)rand() % 12;
+    size_t j;
+    arr[i] = str_sub("http://a/...", len);
+    for (j = 9; j < len; ++j)
+      arr[i][j] = "\0ab\xff"[rand() % 4];
+    ref[i] = arr[i];
+  }
+  str_sort(arr, 600);
+  qsort(ref, 600, sizeof(str), cmp_str);
+  for (i = 0; i < 600; ++i)
+    ASSERT_EQ(cmp_str(&arr[i], &ref[i]), 0);
+  for (i = 0; i < 600; ++i)
+    str_free(&arr[i]);
+}
+
+static FILE *
+tmpfile_with(const char *text) {
+  FILE *fp = tmpfile();
+  assert(fp != NULL);
+  fputs(text, fp);
+  rewind(fp);
+  return fp;
+}
+
+TEST(getline) {
+  FILE      *fp = tmpfile_with("ab\ncdefghijkl\n\nlast");
+  str_reader r;
+  str        line = str_alloc(4);
+  str_reader_init(&r, fp);
+  {
+    /*                                                 */ RESET_TRACKING;
+    ASSERT_EQ(str_getline(&r, &line), 1);
+    ASSERT_STR_PROPS(line, "ab", 4);
+    /*                                                 */ ASSERT_ALLOC(
+    /*                                                 */     8, r.buf);
+    /*                                                 */ ASSERT_NO_FREE;
+
+    /*                                                 */ RESET_TRACKING;
+    /*                                                 */ TRACK_STR(line);
+    ASSERT_EQ(str_getline(&r, &line), 1); /* crosses a refill, grows buf */
+    ASSERT_STR_PROPS(line, "cdefghijkl", 10);
+    /*                                                 */ ASSERT_ALLOC(
+    /*                                                 */     10, line);
+    /*                                                 */ ASSERT_FREE;
+
+    /*                                                 */ RESET_TRACKING;
+    ASSERT_EQ(str_getline(&r, &line), 1);
+    ASSERT_STR_PROPS(line, "", 10);
+    ASSERT_EQ(str_getline(&r, &line), 1); /* no trailing newline */
+    ASSERT_STR_PROPS(line, "last", 10);
+    ASSERT_EQ(str_getline(&r, &line), 0);
+    ASSERT_STR_PROPS(line, "last", 10);
+    ASSERT_EQ(str_getline(&r, &line), 0);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+  }
+  str_reader_free(&r);
+  str_free(&line);
+  fclose(fp);
+}
+
+TEST(getline_view) {
+  FILE       *fp = tmpfile_with("ab\ncdefghijkl\n\nlast\n");
+  str_reader  r;
+  const char *line;
+  size_t      len;
+  str_reader_init(&r, fp);
+  {
+    /*                                                 */ RESET_TRACKING;
+    ASSERT_EQ(str_getline_view(&r, &line, &len), 1);
+    ASSERT_EQ(len, 2);
+    ASSERT_STREQ(line, "ab");
+    ASSERT_EQ(line, r.buf);
+    /*                                                 */ ASSERT_ALLOC(
+    /*                                                 */     8, r.buf);
+    /*                                                 */ ASSERT_NO_FREE;
+
+    /*                                                 */ RESET_TRACKING;
+    /*                                                 */ TRACK_STR(r.buf);
+    ASSERT_EQ(str_getline_view(&r, &line, &len), 1);
+    ASSERT_EQ(len, 10);
+    ASSERT_STREQ(line, "cdefghijkl");
+    ASSERT_EQ(line, r.buf);
+    /*                                                 */ ASSERT_ALLOC(
+    /*                                                 */     16, r.buf);
+    /*                                                 */ ASSERT_FREE;
+
+    /*                                                 */ RESET_TRACKING;
+    ASSERT_EQ(str_getline_view(&r, &line, &len), 1);
+    ASSERT_EQ(len, 0);
+    ASSERT_STREQ(line, "");
+    ASSERT_EQ(str_getline_view(&r, &line, &len), 1);
+    ASSERT_EQ(len, 4);
+    ASSERT_STREQ(line, "last");
+    ASSERT_EQ(str_getline_view(&r, &line, &len), 0);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+  }
+  str_reader_free(&r);
+  fclose(fp);
+}
+
+TEST(reader_free) {
+  FILE      *fp = tmpfile_with("foo\n");
+  str_reader r;
+  str_reader_init(&r, fp);
+  {
+    /*                                                 */ RESET_TRACKING;
+    str_reader_free(&r);
+    ASSERT_EQ(r.buf, NULL);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+    {
+      const char *line;
+      size_t      len;
+      ASSERT_EQ(str_getline_view(&r, &line, &len), 1);
+    }
+    /*                                                 */ RESET_TRACKING;
+    /*                                                 */ TRACK_STR(r.buf);
+    str_reader_free(&r);
+    ASSERT_EQ(r.buf, NULL);
+    ASSERT_EQ(r.pos, 0);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_FREE;
+  }
+  fclose(fp);
+}
+
+TEST(reader_init) {
+  str_reader r;
+  /*                                                   */ RESET_TRACKING;
+  str_reader_init(&r, stdin);
+  ASSERT_EQ(r.buf, NULL);
+  ASSERT_EQ(r.fp, stdin);
+  ASSERT_EQ(r.pos, 0);
+  ASSERT_EQ(r.eof, 0);
+  /*                                                   */ ASSERT_NO_ALLOC;
+  /*                                                   */ ASSERT_NO_FREE;
+}
+
+#ifdef STR_CONFIG_POSIX
+TEST(reader_initfd) {
+  int        fds[2];
+  str_reader r;
+  str        line = str_alloc(0);
+  ASSERT_EQ(pipe(fds), 0);
+  ASSERT_EQ(write(fds[1], "foo\nbarbazqux\n", 14), 14);
+  close(fds[1]);
+  {
+    /*                                                 */ RESET_TRACKING;
+    str_reader_initfd(&r, fds[0]);
+    ASSERT_EQ(r.buf, NULL);
+    ASSERT_EQ(r.fp, NULL);
+    ASSERT_EQ(r.fd, fds[0]);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+    ASSERT_EQ(str_getline(&r, &line), 1);
+    ASSERT_STREQ(line, "foo");
+    ASSERT_EQ(str_getline(&r, &line), 1);
+    ASSERT_STREQ(line, "barbazqux");
+    ASSERT_EQ(str_getline(&r, &line), 0);
+  }
+  str_reader_free(&r);
+  str_free(&line);
+  close(fds[0]);
+}
+#endif
+
+#ifdef STR_CONFIG_POSIX
+/* creates an empty temporary file; path must end with XXXXXX */
+static void
+tmppath(char *path) {
+  int fd = mkstemp(path);
+  assert(fd >= 0);
+  close(fd);
+}
+
+TEST(read_file) {
+  char path[] = "/tmp/str_test_XXXXXX";
+  tmppath(path);
+  {
+    str s;
+    int fd;
+    /*                                                 */ RESET_TRACKING;
+    s = str_read_file(path);
+    ASSERT_STR_PROPS(s, "", 0);
+    /*                                                 */ ASSERT_ALLOC(0, s);
+    /*                                                 */ ASSERT_NO_FREE;
+    str_free(&s);
+
+    fd = open(path, O_WRONLY);
+    ASSERT_EQ(write(fd, "foo\0bar", 7), 7);
+    close(fd);
+    /*                                                 */ RESET_TRACKING;
+    s = str_read_file(path); /* exact size, binary-safe */
+    ASSERT_EQ(str_len(s), 7);
+    ASSERT_EQ(str_cap(s), 7);
+    ASSERT_EQ(memcmp(s, "foo\0bar", 8), 0);
+    /*                                                 */ ASSERT_ALLOC(7, s);
+    /*                                                 */ ASSERT_NO_FREE;
+    str_free(&s);
+
+    /*                                                 */ RESET_TRACKING;
+    s = str_read_file("/dev/null"); /* no reported size */
+    ASSERT_STR_PROPS(s, "", 0);
+    str_free(&s);
+
+    ASSERT_EQ(str_read_file("/nonexistent/str_test"), NULL);
+  }
+  remove(path);
+}
+
+TEST(read_files) {
+  char path_a[] = "/tmp/str_test_XXXXXX";
+  char path_b[] = "/tmp/str_test_XXXXXX";
+  tmppath(path_a);
+  tmppath(path_b);
+  {
+    const char *paths[3];
+    str         out[3];
+    str         a = str_new("foo");
+    paths[0]      = path_a;
+    paths[1]      = "/nonexistent/str_test";
+    paths[2]      = path_b;
+    ASSERT_EQ(str_write_file(path_a, a), 0);
+    /*                                                 */ RESET_TRACKING;
+    ASSERT_EQ(str_read_files(paths, 3, out), 2);
+    ASSERT_STR_PROPS(out[0], "foo", 3);
+    ASSERT_EQ(out[1], NULL);
+    ASSERT_STR_PROPS(out[2], "", 0);
+    /*                                                 */ ASSERT_ALLOC(
+    /*                                                 */     0, out[2]);
+    /*                                                 */ ASSERT_NO_FREE;
+    ASSERT_EQ(str_read_files(paths, 0, out), 0);
+    str_free(&out[0]);
+    str_free(&out[2]);
+    str_free(&a);
+  }
+  {
+    /* spans several batches, with files that are not regular among them */
+    char        names[150][sizeof(path_a)];
+    const char *paths[150];
+    str         out[150];
+    str         a = str_new("");
+    size_t      i;
+    for (i = 0; i < 150; ++i) {
+      strcpy(names[i], "/tmp/str_test_XXXXXX");
+      tmppath(names[i]);
+      paths[i] = names[i];
+      ASSERT_EQ(str_write_file(names[i], a), 0);
+      str_append_n(&a, &"abcdefghijklmnopqrstuvwxyz"[i % 20], 7);
+    }
+    paths[63]  = "/dev/null";
+    paths[64]  = "/tmp";
+    paths[100] = "/nonexistent/str_test";
+    ASSERT_EQ(str_read_files(paths, 150, out), 148);
+    for (i = 0; i < 150; ++i) {
+      if (i == 63) {
+        ASSERT_STR_PROPS(out[i], "", 0);
+      } else if (i == 64 || i == 100) {
+        ASSERT_EQ(out[i], NULL);
+      } else {
+        ASSERT_EQ(str_len(out[i]), i * 7);
+        ASSERT_EQ(str_cap(out[i]), i * 7);
+        ASSERT_EQ(memcmp(out[i], a, i * 7), 0);
+        ASSERT_EQ(out[i][i * 7], '\0');
+      }
+      if (out[i] != NULL)
+        str_free(&out[i]);
+      remove(names[i]);
+    }
+    str_free(&a);
+  }
+  remove(path_a);
+  remove(path_b);
+}
+
+TEST(sendfile) {
+  char path[] = "/tmp/str_test_XXXXXX";
+  tmppath(path);
+  {
+    str  s = str_new("file-backed body");
+    char buf[64];
+    int  fds[2];
+    ASSERT_EQ(str_write_file(path, s), 0);
+    ASSERT_EQ(pipe(fds), 0);
+    ASSERT_EQ(write(fds[1], "head ", 5), 5);
+    /*                                                 */ RESET_TRACKING;
+    ASSERT_EQ(str_sendfile(fds[1], path), 0);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+    ASSERT_EQ(read(fds[0], buf, sizeof(buf)), 21);
+    ASSERT_EQ(memcmp(buf, "head file-backed body", 21), 0);
+#ifdef __linux__
+    /* procfs files report a size of 0 */
+    ASSERT_EQ(str_sendfile(fds[1], "/proc/self/stat"), 0);
+    ASSERT_TRUE((read(fds[0], buf, sizeof(buf)) > 0));
+    ASSERT_TRUE((buf[0] >= '1' && buf[0] <= '9')); /* starts with the pid */
+#endif
+    ASSERT_EQ(str_sendfile(fds[1], "/nonexistent/str_test"), -1);
+    close(fds[0]);
+    close(fds[1]);
+    str_free(&s);
+  }
+  remove(path);
+}
+
+TEST(write_file) {
+  char path[] = "/tmp/str_test_XXXXXX";
+  tmppath(path);
+  {
+    str s = str_new("foo bar");
+    str r;
+    s[3] = '\0'; /* binary-safe */
+    /*                                                 */ RESET_TRACKING;
+    ASSERT_EQ(str_write_file(path, s), 0);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+    r = str_read_file(path);
+    ASSERT_EQ(str_len(r), 7);
+    ASSERT_EQ(memcmp(r, "foo\0bar", 8), 0);
+    str_free(&r);
+
+    str_clear(&s);
+    ASSERT_EQ(str_write_file(path, s), 0); /* truncates */
+    r = str_read_file(path);
+    ASSERT_STR_PROPS(r, "", 0);
+    str_free(&r);
+
+    ASSERT_EQ(str_write_file("/nonexistent/str_test", s), -1);
+    str_free(&s);
+  }
+  remove(path);
+}
+
+/* writes a table of "foo", "", "barbaz" and "q\0x" to path */
+static void
+write_test_table(const char *path) {
+  str arr[4];
+  int i;
+  arr[0]    = str_new("foo");
+  arr[1]    = str_new("");
+  arr[2]    = str_new("barbaz");
+  arr[3]    = str_new("q x");
+  arr[3][1] = '\0';
+  ASSERT_EQ(str_table_write(path, arr, 4), 0);
+  for (i = 0; i < 4; ++i)
+    str_free(&arr[i]);
+}
+
+TEST(table_close) {
+  char path[] = "/tmp/str_test_XXXXXX";
+  tmppath(path);
+  write_test_table(path);
+  {
+    str_table t;
+    ASSERT_EQ(str_table_open(&t, path), 0);
+    /*                                                 */ RESET_TRACKING;
+    str_table_close(&t);
+    ASSERT_EQ(t.map, NULL);
+    ASSERT_EQ(t.n, 0);
+    str_table_close(&t);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+  }
+  remove(path);
+}
+
+TEST(table_get) {
+  char path[] = "/tmp/str_test_XXXXXX";
+  tmppath(path);
+  write_test_table(path);
+  {
+    str_table t;
+    str       s;
+    str       d;
+    ASSERT_EQ(str_table_open(&t, path), 0);
+    /*                                                 */ RESET_TRACKING;
+    ASSERT_STR_PROPS(str_table_get(&t, 0), "foo", 3);
+    ASSERT_STR_PROPS(str_table_get(&t, 1), "", 0);
+    ASSERT_STR_PROPS(str_table_get(&t, 2), "barbaz", 6);
+    ASSERT_EQ(str_len(str_table_get(&t, 3)), 3);
+    ASSERT_EQ(memcmp(str_table_get(&t, 3), "q\0x", 4), 0);
+    ASSERT_EQ(str_table_get(&t, 4), NULL);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+
+    /* read-only: str_free releases nothing */
+    s = str_table_get(&t, 0);
+    /*                                                 */ RESET_TRACKING;
+    str_free(&s);
+    ASSERT_EQ(s, NULL);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+
+    /* read-only: manipulators copy to an owned block */
+    s = str_table_get(&t, 2);
+    /*                                                 */ RESET_TRACKING;
+    str_trim(&s);
+    ASSERT_EQ(s, str_table_get(&t, 2)); /* nothing to trim */
+    str_emplace(&s, "B", 3);
+    ASSERT_STR_PROPS(s, "barBaz", 6);
+    ASSERT_STR_PROPS(str_table_get(&t, 2), "barbaz", 6);
+    /*                                                 */ ASSERT_ALLOC(6, s);
+    /*                                                 */ ASSERT_NO_FREE;
+    str_append(&s, "!");
+    ASSERT_STR_PROPS(s, "barBaz!", 7);
+    str_free(&s);
+    s = str_table_get(&t, 0);
+    str_clear(&s);
+    ASSERT_STR_PROPS(s, "", 3);
+    ASSERT_STR_PROPS(str_table_get(&t, 0), "foo", 3);
+    str_free(&s);
+
+    /* read-only: duplicates are owned */
+    /*                                                 */ RESET_TRACKING;
+    d = str_dup(str_table_get(&t, 0));
+    ASSERT_STR_PROPS(d, "foo", 3);
+    /*                                                 */ ASSERT_ALLOC(3, d);
+    /*                                                 */ TRACK_STR(d);
+    str_free(&d);
+    /*                                                 */ ASSERT_FREE;
+    str_table_close(&t);
+  }
+  {
+    /* entries that are not read-only or not terminated are rejected */
+    str_table t;
+    str       f = str_read_file(path);
+    size_t   *w = (size_t *)f;
+    w[w[2] / sizeof(size_t) - 2] &= ~(size_t)0 >> 1; /* "foo" owned */
+    f[w[4] + 6] = '!';                                /* "barbaz!" */
+    ASSERT_EQ(str_write_file(path, f), 0);
+    ASSERT_EQ(str_table_open(&t, path), 0);
+    ASSERT_EQ(str_table_get(&t, 0), NULL);
+    ASSERT_STR_PROPS(str_table_get(&t, 1), "", 0);
+    ASSERT_EQ(str_table_get(&t, 2), NULL);
+    str_table_close(&t);
+    str_free(&f);
+  }
+  remove(path);
+}
+
+TEST(table_open) {
+  char path[] = "/tmp/str_test_XXXXXX";
+  tmppath(path);
+  {
+    str_table t;
+    str       bad = str_new("not a string table");
+    ASSERT_EQ(str_table_open(&t, path), -1); /* empty */
+    ASSERT_EQ(str_write_file(path, bad), 0);
+    ASSERT_EQ(str_table_open(&t, path), -1);
+    ASSERT_EQ(str_table_open(&t, "/nonexistent/str_test"), -1);
+    write_test_table(path);
+    /*                                                 */ RESET_TRACKING;
+    ASSERT_EQ(str_table_open(&t, path), 0);
+    ASSERT_EQ(t.n, 4);
+    ASSERT_NEQ(t.map, NULL);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+    str_table_close(&t);
+    str_free(&bad);
+  }
+  remove(path);
+}
+
+TEST(table_write) {
+  char path[] = "/tmp/str_test_XXXXXX";
+  tmppath(path);
+  {
+    str_table t;
+    str       f;
+    /*                                                 */ RESET_TRACKING;
+    write_test_table(path);
+    f = str_read_file(path);
+    /* header, index, then word-aligned blocks (here 2 words + 8 chars) */
+    ASSERT_EQ(str_len(f), sizeof(size_t) * (2 + 4 + 4 * 2) + 8 * 4);
+    ASSERT_EQ(((size_t *)f)[1], 4);
+    str_free(&f);
+    ASSERT_EQ(str_table_open(&t, path), 0);
+    ASSERT_STR_PROPS(str_table_get(&t, 2), "barbaz", 6);
+    str_table_close(&t);
+    ASSERT_EQ(str_table_write(path, NULL, 0), 0);
+    ASSERT_EQ(str_table_open(&t, path), 0);
+    ASSERT_EQ(t.n, 0);
+    str_table_close(&t);
+    ASSERT_EQ(str_table_write("/nonexistent/str_test", NULL, 0), -1);
+  }
+  remove(path);
+}
+
+TEST(writev) {
+  char path[] = "/tmp/str_test_XXXXXX";
+  tmppath(path);
+  {
+    str    parts[2000]; /* more than one IOV_MAX chunk */
+    str    r;
+    size_t i;
+    int    fd = open(path, O_WRONLY);
+    parts[0]  = str_new("head ");
+    parts[1]  = str_new("");
+    parts[2]  = str_new("body ");
+    for (i = 3; i < 2000; ++i)
+      parts[i] = str_new(i == 1999 ? "!" : "x");
+    /*                                                 */ RESET_TRACKING;
+    ASSERT_EQ(str_writev(fd, parts, 2000), 0);
+    ASSERT_EQ(str_writev(fd, parts, 0), 0);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+    close(fd);
+    r = str_read_file(path);
+    ASSERT_EQ(str_len(r), 10 + 1997);
+    ASSERT_EQ(memcmp(r, "head body xxx", 13), 0);
+    ASSERT_EQ(r[str_len(r) - 2], 'x');
+    ASSERT_EQ(r[str_len(r) - 1], '!');
+    ASSERT_EQ(str_writev(-1, parts, 1), -1);
+    str_free(&r);
+    for (i = 0; i < 2000; ++i)
+      str_free(&parts[i]);
+  }
+  remove(path);
+}
+#endif
+
+#ifdef STR_CONFIG_STATS
+TEST(stats_add) {
+  {
+    str_stats a;
+    str_stats b;
+    memset(&a, 0, sizeof(a));
+    memset(&b, 0, sizeof(b));
+    a.fn[STR_STATS_APPEND].allocs       = 1;
+    a.fn[STR_STATS_APPEND].slack        = -3;
+    b.fn[STR_STATS_APPEND].allocs       = 2;
+    b.fn[STR_STATS_APPEND].slack        = 5;
+    b.fn[STR_STATS_FREE].frees          = 4;
+    b.fn[STR_STATS_INSERT].bytes_copied = 7;
+    a.live_slack                        = 10;
+    b.live_slack                        = -4;
+    /*                                                 */ RESET_TRACKING;
+    str_stats_add(&a, &b);
+    ASSERT_EQ(a.fn[STR_STATS_APPEND].allocs, 3);
+    ASSERT_EQ(a.fn[STR_STATS_APPEND].slack, 2);
+    ASSERT_EQ(a.live_slack, 6);
+    ASSERT_EQ(a.fn[STR_STATS_FREE].frees, 4);
+    ASSERT_EQ(a.fn[STR_STATS_INSERT].bytes_copied, 7);
+    ASSERT_EQ(b.fn[STR_STATS_APPEND].allocs, 2);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_NO_FREE;
+  }
+}
+
+TEST(stats_format) {
+  {
+    str       s = str_alloc(0);
+    str_stats st;
+    memset(&st, 0, sizeof(st));
+    str_stats_format(&s, &st);
+    ASSERT_STREQ(s, "fn,allocs,frees,reallocs,bytes_allocated,bytes_copied,"
+                    "bytes_shifted,slack\n"
+                    "total,0,0,0,0,0,0,0\n"
+                    "live,,,,,,,0\n");
+    str_free(&s);
+  }
+  {
+    str       s = str_alloc(0);
+    str_stats st;
+    memset(&st, 0, sizeof(st));
+    st.fn[STR_STATS_ALLOC].allocs          = 2;
+    st.fn[STR_STATS_ALLOC].bytes_allocated = 40;
+    st.fn[STR_STATS_ALLOC].slack           = 6;
+    st.fn[STR_STATS_INSERT].reallocs       = 1;
+    st.fn[STR_STATS_INSERT].allocs         = 1;
+    st.fn[STR_STATS_INSERT].frees          = 1;
+    st.fn[STR_STATS_INSERT].bytes_copied   = 20;
+    st.fn[STR_STATS_INSERT].bytes_shifted  = 3;
+    st.fn[STR_STATS_TRIM].slack            = -4;
+    st.fn[STR_STATS_FREE].frees            = 1;
+    st.live_slack                          = 9;
+    str_stats_format(&s, &st);
+    ASSERT_STREQ(s, "fn,allocs,frees,reallocs,bytes_allocated,bytes_copied,"
+                    "bytes_shifted,slack\n"
+                    "alloc,2,0,0,40,0,0,6\n"
+                    "insert,1,1,1,0,20,3,0\n"
+                    "trim,0,0,0,0,0,0,-4\n"
+                    "free,0,1,0,0,0,0,0\n"
+                    "total,3,2,1,40,20,3,2\n"
+                    "live,,,,,,,9\n");
+    str_free(&s);
+  }
+}
+
+TEST(stats_get) {
+  {
+    /* the calls made by the library are attributed to the called function */
+    str       s;
+    str_stats st;
+    str_stats_reset();
+    s = str_new("abc");
+    str_append(&s, "de");
+    str_prepend(&s, "xy");
+    str_rpad(&s, 10);
+    str_trim(&s);
+    str_stats_get(&st);
+    ASSERT_EQ(st.fn[STR_STATS_NEW].allocs, 1);
+    ASSERT_EQ(st.fn[STR_STATS_NEW].bytes_allocated,
+              sizeof(size_t) * 2 + 4 + ALIGN_EXTRA);
+    ASSERT_EQ(st.fn[STR_STATS_ALLOC].allocs, 0);
+    ASSERT_EQ(st.fn[STR_STATS_APPEND].allocs, 1);
+    ASSERT_EQ(st.fn[STR_STATS_APPEND].frees, 1);
+    ASSERT_EQ(st.fn[STR_STATS_APPEND].reallocs, 1);
+    ASSERT_EQ(st.fn[STR_STATS_APPEND].bytes_copied, sizeof(size_t) * 2 + 4);
+    ASSERT_EQ(st.fn[STR_STATS_PREPEND].bytes_shifted, 6);
+    ASSERT_EQ(st.fn[STR_STATS_FIT].allocs, 0);
+    ASSERT_EQ(st.fn[STR_STATS_REALLOC].allocs, 0);
+    ASSERT_EQ(st.fn[STR_STATS_RPADF].allocs, 1);
+    ASSERT_EQ(st.fn[STR_STATS_RPADF].slack, 0);
+    ASSERT_EQ(st.fn[STR_STATS_TRIM].bytes_shifted, 0);
+    ASSERT_EQ(st.fn[STR_STATS_TRIM].slack, 3);
+    str_free(&s);
+    str_stats_get(&st);
+    ASSERT_EQ(st.fn[STR_STATS_FREE].frees, 1);
+    ASSERT_EQ(st.fn[STR_STATS_FREE].slack, -3);
+  }
+  {
+    /* slack sums to the unused capacity of the live strs */
+    str       a;
+    str       b;
+    str_stats st;
+    ptrdiff_t slack = 0;
+    size_t    i;
+    str_stats_reset();
+    a = str_alloc(16);
+    b = str_new("  padded  ");
+    str_append(&a, "0123456789");
+    str_cpylower(&a, "ABC");
+    str_trim(&b);
+    str_insert(&b, "--", 3);
+    str_shrinkfit(&a);
+    str_grow(&b, 5);
+    str_stats_get(&st);
+    for (i = 0; i < STR_STATS_FNS; ++i)
+      slack += st.fn[i].slack;
+    ASSERT_EQ(slack, (ptrdiff_t)(str_cap(a) - str_len(a) + str_cap(b) -
+                                 str_len(b)));
+    ASSERT_EQ(st.fn[STR_STATS_TRIM].bytes_shifted, 6);
+    ASSERT_EQ(st.fn[STR_STATS_INSERT].bytes_shifted, 4);
+    str_free(&a);
+    str_free(&b);
+    str_stats_get(&st);
+    for (i = 0, slack = 0; i < STR_STATS_FNS; ++i)
+      slack += st.fn[i].slack;
+    ASSERT_EQ(slack, 0);
+  }
+}
+
+TEST(stats_reset) {
+  {
+    str       s = str_new("counted");
+    str_stats st;
+    size_t    i;
+    str_stats_reset();
+    str_stats_get(&st);
+    for (i = 0; i < STR_STATS_FNS; ++i) {
+      ASSERT_EQ(st.fn[i].allocs, 0);
+      ASSERT_EQ(st.fn[i].frees, 0);
+      ASSERT_EQ(st.fn[i].slack, 0);
+    }
+    str_free(&s);
+    str_stats_get(&st);
+    ASSERT_EQ(st.fn[STR_STATS_FREE].frees, 1);
+  }
+  {
+    /* the live slack survives a reset; slack is the change since it */
+    str       s;
+    str_stats st;
+    ptrdiff_t live;
+    ptrdiff_t slack;
+    size_t    i;
+    str_stats_get(&st);
+    live = st.live_slack;
+    s    = str_alloc(32);
+    str_append(&s, "0123456789");
+    slack = (ptrdiff_t)(str_cap(s) - str_len(s));
+    str_stats_reset();
+    str_stats_get(&st);
+    ASSERT_EQ(st.live_slack, live + slack);
+    str_free(&s);
+    str_stats_get(&st);
+    ASSERT_EQ(st.live_slack, live);
+    ASSERT_EQ(st.fn[STR_STATS_FREE].slack, -slack);
+    for (i = 0; i < STR_STATS_FNS; ++i)
+      slack += st.fn[i].slack;
+    ASSERT_EQ(slack, 0);
+  }
+}
+#endif
+
+#ifdef STR_CONFIG_TRACE
+/* asserts that the next record of fp is fn: id -> to [cap, len] */
+static void
+assert_record(FILE *fp, int fn, size_t id, size_t to, size_t cap,
+              size_t len) {
+  str_trace_record r;
+  ASSERT_TRUE(str_trace_read(fp, &r));
+  ASSERT_EQ(r.fn, fn);
+  ASSERT_EQ(r.id, id);
+  ASSERT_EQ(r.to, to);
+  ASSERT_EQ(r.cap, cap);
+  ASSERT_EQ(r.len, len);
+}
+
+/* asserts that fp has no further records */
+static void
+assert_no_record(FILE *fp) {
+  str_trace_record r;
+  ASSERT_FALSE(str_trace_read(fp, &r));
+}
+
+TEST(trace_read) {
+  {
+    /* varints; to is stored relative to id */
+    static const unsigned char rec[] = {5, 0x81, 0x02, 0, 3, 0x84, 0x01};
+    FILE                      *fp    = tmpfile_with("");
+    fwrite(rec, 1, sizeof(rec), fp);
+    rewind(fp);
+    assert_record(fp, 5, 0x101, 0x101, 3, 0x84);
+    assert_no_record(fp);
+    fclose(fp);
+  }
+  {
+    /* a truncated record is not read */
+    static const unsigned char rec[] = {7, 1, 0x80};
+    FILE                      *fp    = tmpfile_with("");
+    str_trace_record           r;
+    fwrite(rec, 1, sizeof(rec), fp);
+    rewind(fp);
+    ASSERT_FALSE(str_trace_read(fp, &r));
+    fclose(fp);
+  }
+}
+
+TEST(trace_start) {
+  {
+    /* events are attributed to the called function */
+    FILE  *fp = tmpfile_with("");
+    str    s;
+    size_t a;
+    size_t b;
+    str_trace_start(fp);
+    s = str_new("ab");
+    a = (size_t)s;
+    str_append(&s, "cd");
+    b = (size_t)s;
+    str_free(&s);
+    str_trace_stop();
+    rewind(fp);
+    assert_record(fp, STR_STATS_NEW, 0, a, 2, 0);
+    assert_record(fp, STR_STATS_NEW, a, a, 2, 2);
+    assert_record(fp, STR_STATS_APPEND, a, b, 4, 2);
+    assert_record(fp, STR_STATS_APPEND, a, 0, 2, 2);
+    assert_record(fp, STR_STATS_APPEND, b, b, 4, 4);
+    assert_record(fp, STR_STATS_FREE, b, 0, 4, 4);
+    assert_no_record(fp);
+    fclose(fp);
+  }
+  {
+    /* starting again writes the records of the previous trace */
+    FILE  *fp1 = tmpfile_with("");
+    FILE  *fp2 = tmpfile_with("");
+    str    s;
+    size_t a;
+    str_trace_start(fp1);
+    s = str_alloc(3);
+    a = (size_t)s;
+    str_trace_start(fp2);
+    str_free(&s);
+    str_trace_stop();
+    rewind(fp1);
+    rewind(fp2);
+    assert_record(fp1, STR_STATS_ALLOC, 0, a, 3, 0);
+    assert_no_record(fp1);
+    assert_record(fp2, STR_STATS_FREE, a, 0, 3, 0);
+    assert_no_record(fp2);
+    fclose(fp1);
+    fclose(fp2);
+  }
+}
+
+TEST(trace_stop) {
+  {
+    FILE *fp = tmpfile_with("");
+    str   s;
+    str_trace_start(fp);
+    str_trace_stop();
+    s = str_new("untraced");
+    str_free(&s);
+    str_trace_stop();
+    rewind(fp);
+    assert_no_record(fp);
+    fclose(fp);
+  }
+}
+#endif
+
+TEST(free) {
+  {
+    str s = str_alloc(0);
+    /*                                                 */ RESET_TRACKING;
+    /*                                                 */ TRACK_STR(s);
+    str_free(&s);
+    ASSERT_EQ(s, NULL);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_FREE;
+  }
+  {
+    str s = str_alloc(3);
+    /*                                                 */ RESET_TRACKING;
+    /*                                                 */ TRACK_STR(s);
+    str_free(&s);
+    ASSERT_EQ(s, NULL);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_FREE;
+  }
+  {
+    str s = str_new("finished testing! :D");
+    /*                                                 */ RESET_TRACKING;
+    /*                                                 */ TRACK_STR(s);
+    str_free(&s);
+    ASSERT_EQ(s, NULL);
+    /*                                                 */ ASSERT_NO_ALLOC;
+    /*                                                 */ ASSERT_FREE;
+  }
+}
+
+/*.----------------------------------------------------------------------------,
+ /                                    main                                   */
+
+TEST_MAIN {
+  RUN_TEST(alloc);
+#ifdef STR_CONFIG_ALIGN
+  RUN_TEST(alloc_aligned);
+#endif
+  RUN_TEST(dup);
+  RUN_TEST(new);
+  RUN_TEST(sub);
+  RUN_TEST(lit);
+  RUN_TEST(avail);
+  RUN_TEST(cap);
+  RUN_TEST(end);
+  RUN_TEST(islower);
+  RUN_TEST(isupper);
+  RUN_TEST(len);
+  RUN_TEST(mbegin);
+  RUN_TEST(mend);
+  RUN_TEST(msize);
+  RUN_TEST(mstr);
+  RUN_TEST(casecmp);
+  RUN_TEST(casecmp_);
+  RUN_TEST(caseeq);
+  RUN_TEST(caseeq_);
+  RUN_TEST(cmp);
+  RUN_TEST(cmp_);
+  RUN_TEST(ends_with);
+  RUN_TEST(ends_with_);
+  RUN_TEST(eq);
+  RUN_TEST(eq_);
+  RUN_TEST(starts_with);
+  RUN_TEST(starts_with_);
+  RUN_TEST(utf8_len);
+  RUN_TEST(utf8_valid);
+  RUN_TEST(append_base64);
+  RUN_TEST(append_csv_field);
+  RUN_TEST(append_hex);
+  RUN_TEST(append_json_escaped);
+  RUN_TEST(append_unbase64);
+  RUN_TEST(append_uncsv);
+  RUN_TEST(append_unhex);
+  RUN_TEST(append_unjson);
+  RUN_TEST(append_unurl);
+  RUN_TEST(append_url_encoded);
+  RUN_TEST(to_double);
+  RUN_TEST(to_double_);
+  RUN_TEST(to_long);
+  RUN_TEST(to_long_);
+  RUN_TEST(to_ulong);
+  RUN_TEST(to_ulong_);
+  RUN_TEST(append);
+  RUN_TEST(append_);
+  RUN_TEST(append_n);
+  RUN_TEST(prepend);
+  RUN_TEST(prepend_);
+  RUN_TEST(emplace);
+  RUN_TEST(emplace_);
+  RUN_TEST(erase);
+  RUN_TEST(insert);
+  RUN_TEST(insert_);
+  RUN_TEST(splice);
+  RUN_TEST(substr);
+  RUN_TEST(cpylower);
+  RUN_TEST(cpylower_);
+  RUN_TEST(cpyupper);
+  RUN_TEST(cpyupper_);
+  RUN_TEST(tolower);
+  RUN_TEST(toupper);
+  RUN_TEST(cpad);
+  RUN_TEST(cpadf);
+  RUN_TEST(lpad);
+  RUN_TEST(lpadf);
+  RUN_TEST(rpad);
+  RUN_TEST(rpadf);
+  RUN_TEST(trim);
+  RUN_TEST(clear);
+  RUN_TEST(fit);
+  RUN_TEST(grow);
+  RUN_TEST(realloc);
+#ifdef STR_CONFIG_MMAP_THRESHOLD
+  RUN_TEST(realloc_mapped);
+#endif
   RUN_TEST(shrink);
   RUN_TEST(shrinkfit);
+  RUN_TEST(edit_begin);
+  RUN_TEST(edit_commit);
+  RUN_TEST(edit_erase);
+  RUN_TEST(edit_insert);
+  RUN_TEST(edit_insert_);
+  RUN_TEST(edit_len);
+  RUN_TEST(edit_seek);
+  RUN_TEST(builder_append);
+  RUN_TEST(builder_append_);
+  RUN_TEST(builder_finish);
+  RUN_TEST(builder_free);
+  RUN_TEST(builder_init);
+  RUN_TEST(builder_len);
+  RUN_TEST(builder_reserve);
+#ifdef STR_CONFIG_POSIX
+  RUN_TEST(builder_writev);
+#endif
+  RUN_TEST(vec_free);
+  RUN_TEST(vec_get);
+  RUN_TEST(vec_get_str);
+  RUN_TEST(vec_init);
+  RUN_TEST(vec_len);
+  RUN_TEST(vec_pop);
+  RUN_TEST(vec_push);
+  RUN_TEST(vec_push_);
+  RUN_TEST(vec_split);
+  RUN_TEST(sort);
+  RUN_TEST(getline);
+  RUN_TEST(getline_view);
+  RUN_TEST(reader_free);
+  RUN_TEST(reader_init);
+#ifdef STR_CONFIG_POSIX
+  RUN_TEST(reader_initfd);
+#endif
+#ifdef STR_CONFIG_POSIX
+  RUN_TEST(read_file);
+  RUN_TEST(read_files);
+  RUN_TEST(sendfile);
+  RUN_TEST(write_file);
+  RUN_TEST(writev);
+  RUN_TEST(table_close);
+  RUN_TEST(table_get);
+  RUN_TEST(table_open);
+  RUN_TEST(table_write);
+#endif
+#ifdef STR_CONFIG_STATS
+  RUN_TEST(stats_add);
+  RUN_TEST(stats_format);
+  RUN_TEST(stats_get);
+  RUN_TEST(stats_reset);
+#endif
+#ifdef STR_CONFIG_TRACE
+  RUN_TEST(trace_read);
+  RUN_TEST(trace_start);
+  RUN_TEST(trace_stop);
+#endif
   RUN_TEST(free);
   return 0;
 }
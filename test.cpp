@@ -0,0 +1,478 @@
+/* /////////////////////////////////////////////////////////////////////////////
+//                ___
+//              ,--.'|_            str: C string management header [1.0.0]
+//              |  | :,'   __  ,-. Copyright (C) 2020 Justin Collier
+//    .--.--.   :  : ' : ,' ,'/ /|
+//   /  /    '.;__,'  /  '  | |' | - - - - - - - - - - - - - - - - - - -
+//  |  :  /`./|  |   |   |  |   ,'
+//  |  :  ;_  :__,'| :   '  :  /   This program is free software: you can
+//   \  \    `. '  : |__ |  | '    redistribute it and/or modify it under the
+//    `----.   \|  | '.'|;  : |    terms of the GNU General Public License
+//   /  /`--'  /;  :    ;|  , ;    as published by the Free Software Foundation,
+//  '--'.     / |  ,   /  ---'     either version 3 of the License, or (at your
+//    `--'---'   ---`-'            option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the internalied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//                                                                             /
+//  You should have received a copy of the GNU General Public License         //
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.   ///
+///////////////////////////////////////////////////////////////////////////// */
+
+#include <cassert>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/* counts the allocations of the library */
+static std::size_t allocs = 0;
+static std::size_t frees  = 0;
+void *
+track_alloc(std::size_t n) {
+  ++allocs;
+  return std::malloc(n);
+}
+void
+track_free(void *p) {
+  ++frees;
+  std::free(p);
+}
+#define STR_CONFIG_MALLOC track_alloc
+#define STR_CONFIG_FREE   track_free
+
+#ifdef IS_NAMESPACE_TEST
+#define STR_CONFIG_NAMESPACE xyz
+#define TEST_REPORT_NS       xyz
+#else
+#define TEST_REPORT_NS str
+#endif
+
+#include "str.hpp"
+
+/*.----------------------------------------------------------------------------,
+ /                                test detail                                */
+
+#define PP_CAT(a, b)      PP_CAT_X(a, b)
+#define PP_CAT_X(a, b)    a##b
+#define PP_STRINGIZE(x)   PP_STRINGIZE_X(x)
+#define PP_STRINGIZE_X(x) #x
+
+#define TEST(feature)      static void PP_CAT(test_, feature)()
+#define ASSERT_STREQ(a, b) assert(std::strcmp(a, b) == 0)
+#define ASSERT_EQ(a, b)    assert(a == b)
+#define ASSERT_NEQ(a, b)   assert(a != b)
+#define ASSERT_TRUE(c)     assert(c)
+#define ASSERT_FALSE(c)    assert(!(c))
+
+#define RUN_TEST(feature)   \
+  PP_CAT(test_, feature)(); \
+  std::printf("PASS " PP_STRINGIZE(TEST_REPORT_NS) "pp_" #feature "\n")
+
+#define RESET_TRACKING   allocs = frees = 0
+#define ASSERT_ALLOCS(n) ASSERT_EQ(allocs, n)
+#define ASSERT_FREES(n)  ASSERT_EQ(frees, n)
+
+#ifdef IS_NAMESPACE_TEST
+#define NS_FN(name) PP_CAT(STR_CONFIG_NAMESPACE, PP_CAT(_, name))
+#define str         STR_CONFIG_NAMESPACE
+#define str_new     NS_FN(new)
+#define str_cap     NS_FN(cap)
+#define str_len     NS_FN(len)
+#define str_append  NS_FN(append)
+#define str_free    NS_FN(free)
+#endif
+
+using strpp::string;
+
+/* moves must be chosen by std::vector when it reallocates */
+static_assert(std::is_nothrow_move_constructible<string>::value, "");
+static_assert(std::is_nothrow_move_assignable<string>::value, "");
+static_assert(std::is_nothrow_default_constructible<string>::value, "");
+
+/*.----------------------------------------------------------------------------,
+ /                                   tests                                   */
+
+TEST(construction) {
+  {
+    RESET_TRACKING;
+    string s;
+    ASSERT_ALLOCS(0);
+    ASSERT_EQ(s.get(), nullptr);
+    ASSERT_EQ(s.size(), 0);
+    ASSERT_EQ(s.capacity(), 0);
+    ASSERT_STREQ(s.c_str(), "");
+    ASSERT_TRUE(s.empty());
+  }
+  {
+    RESET_TRACKING;
+    {
+      string s("abc");
+      ASSERT_ALLOCS(1);
+      ASSERT_STREQ(s.c_str(), "abc");
+      ASSERT_EQ(s.size(), 3);
+      ASSERT_EQ(s.capacity(), 3);
+    }
+    ASSERT_FREES(1);
+  }
+  {
+    string s("abcdef", 4);
+    ASSERT_STREQ(s.c_str(), "abcd");
+    ASSERT_EQ(s.size(), 4);
+  }
+}
+
+TEST(copy) {
+  {
+    string a("copied");
+    RESET_TRACKING;
+    string b(a);
+    ASSERT_ALLOCS(1);
+    ASSERT_NEQ(a.get(), b.get());
+    ASSERT_TRUE(a == b);
+    b += "!";
+    ASSERT_STREQ(a.c_str(), "copied");
+    ASSERT_STREQ(b.c_str(), "copied!");
+  }
+  {
+    string a("x");
+    string b("old");
+    RESET_TRACKING;
+    b = a;
+    ASSERT_ALLOCS(1);
+    ASSERT_FREES(1);
+    ASSERT_STREQ(b.c_str(), "x");
+  }
+  {
+    /* an empty copy does not allocate */
+    string a;
+    RESET_TRACKING;
+    string b(a);
+    b = a;
+    ASSERT_ALLOCS(0);
+    ASSERT_EQ(b.get(), nullptr);
+  }
+}
+
+TEST(move) {
+  {
+    string a("moved");
+    str    p = a.get();
+    RESET_TRACKING;
+    string b(std::move(a));
+    ASSERT_ALLOCS(0);
+    ASSERT_EQ(b.get(), p);
+    ASSERT_EQ(a.get(), nullptr);
+    ASSERT_STREQ(a.c_str(), "");
+  }
+  {
+    string a("new");
+    string b("old");
+    str    p = a.get();
+    RESET_TRACKING;
+    b = std::move(a);
+    ASSERT_ALLOCS(0);
+    ASSERT_FREES(1); /* the old str of b */
+    ASSERT_EQ(b.get(), p);
+    ASSERT_EQ(a.get(), nullptr);
+  }
+  {
+    /* a growing vector moves its elements */
+    std::vector<string> v;
+    std::size_t         i;
+    RESET_TRACKING;
+    for (i = 0; i < 100; ++i)
+      v.push_back(string("element"));
+    ASSERT_ALLOCS(100);
+    ASSERT_FREES(0);
+  }
+}
+
+TEST(adopt) {
+  {
+    str p = str_new("adopted");
+    RESET_TRACKING;
+    {
+      string s = string::adopt(p);
+      ASSERT_EQ(s.get(), p);
+      ASSERT_ALLOCS(0);
+    }
+    ASSERT_FREES(1);
+  }
+  {
+    string s("released");
+    str    p = s.release();
+    ASSERT_EQ(s.get(), nullptr);
+    ASSERT_STREQ(p, "released");
+    str_free(&p);
+  }
+}
+
+TEST(swap) {
+  {
+    string a("a");
+    string b("b");
+    str    pa = a.get();
+    str    pb = b.get();
+    RESET_TRACKING;
+    swap(a, b);
+    ASSERT_ALLOCS(0);
+    ASSERT_EQ(a.get(), pb);
+    ASSERT_EQ(b.get(), pa);
+  }
+}
+
+TEST(string_view) {
+#if __cplusplus >= 201703L
+  {
+    string           s("viewed");
+    std::string_view v = s;
+    ASSERT_EQ(v.data(), s.get());
+    ASSERT_EQ(v.size(), 6);
+    string t(v.substr(1, 3));
+    ASSERT_STREQ(t.c_str(), "iew");
+  }
+  {
+    string           s;
+    std::string_view v = s;
+    ASSERT_EQ(v.size(), 0);
+  }
+#endif
+}
+
+TEST(compare) {
+  {
+    string a("abc");
+    string b("abd");
+    string c("ab");
+    string e;
+    ASSERT_TRUE(a < b);
+    ASSERT_TRUE(c < a);
+    ASSERT_TRUE(e < c);
+    ASSERT_TRUE(b >= a);
+    ASSERT_TRUE(a <= a);
+    ASSERT_TRUE(b > c);
+    ASSERT_EQ(strpp::compare(a, string("abc")), 0);
+    ASSERT_TRUE(a == "abc");
+    ASSERT_TRUE("abc" == a);
+    ASSERT_TRUE(a != "ab");
+    ASSERT_TRUE(e == "");
+    ASSERT_TRUE(a != c);
+  }
+}
+
+TEST(append) {
+  {
+    string s;
+    RESET_TRACKING;
+    s += "";
+    ASSERT_ALLOCS(0);
+    s += "ab";
+    ASSERT_ALLOCS(1);
+    s += string("cd");
+    ASSERT_STREQ(s.c_str(), "abcd");
+    s += s;
+    ASSERT_STREQ(s.c_str(), "abcdabcd");
+    ASSERT_EQ(s.size(), 8);
+    s += s.c_str() + 6;
+    ASSERT_STREQ(s.c_str(), "abcdabcdcd");
+  }
+  {
+    /* reserved capacity is used */
+    string s("a");
+    s.reserve(16);
+    RESET_TRACKING;
+    s += "bcdefghijklmnop";
+    ASSERT_ALLOCS(0);
+    ASSERT_EQ(s.capacity(), 16);
+  }
+}
+
+TEST(concat) {
+  {
+    /* one allocation however many parts */
+    string      a("ab");
+    std::string b("cd");
+    RESET_TRACKING;
+    string s = a + b + "ef" + 'g' + 42 + -7 + a;
+    ASSERT_ALLOCS(1);
+    ASSERT_STREQ(s.c_str(), "abcdefg42-7ab");
+    ASSERT_EQ(s.size(), 13);
+    ASSERT_EQ(s.capacity(), 13);
+    RESET_TRACKING;
+    s = "<" + a + ">";
+    ASSERT_ALLOCS(1);
+    ASSERT_FREES(1);
+    ASSERT_STREQ(s.c_str(), "<ab>");
+  }
+  {
+    /* integers are written in decimal */
+    string s = string() + LLONG_MIN + ' ' + ULLONG_MAX + ' ' + 0 + ' ' +
+               static_cast<unsigned char>(7) + ' ' + static_cast<short>(-1);
+    ASSERT_STREQ(s.c_str(),
+                 "-9223372036854775808 18446744073709551615 0 7 -1");
+  }
+  {
+    /* a raw str is a char * unless it is wrapped by ref */
+    string a("raw");
+    string s = strpp::ref(a.get()) + a.get() + strpp::ref(nullptr);
+    ASSERT_STREQ(s.c_str(), "rawraw");
+    char buf[8] = "ar\0ray";
+    s           = s + buf;
+    ASSERT_STREQ(s.c_str(), "rawrawar");
+#if __cplusplus >= 201703L
+    std::string_view v("view");
+    s = v.substr(1) + s;
+    ASSERT_STREQ(s.c_str(), "iewrawrawar");
+#endif
+  }
+  {
+    /* appends use reserved capacity and copy parts that alias */
+    string s("a");
+    string t("cd");
+    s.reserve(16);
+    RESET_TRACKING;
+    s += s + "b";
+    ASSERT_ALLOCS(1);
+    ASSERT_FREES(1);
+    ASSERT_STREQ(s.c_str(), "aab");
+    RESET_TRACKING;
+    s += t + 'e';
+    ASSERT_ALLOCS(0);
+    ASSERT_STREQ(s.c_str(), "aabcde");
+    ASSERT_EQ(s.capacity(), 16);
+  }
+}
+
+static constexpr auto file_lit = strpp::lit("file scope");
+static_assert(file_lit.len == 10, "");
+static_assert(file_lit.chars[10] == '\0', "");
+
+TEST(lit) {
+  {
+    RESET_TRACKING;
+    str s = file_lit.get();
+    ASSERT_EQ(str_len(s), 10);
+    ASSERT_EQ(str_cap(s), 10);
+    ASSERT_STREQ(s, "file scope");
+    str_free(&s);
+    ASSERT_EQ(s, nullptr);
+    ASSERT_ALLOCS(0);
+    ASSERT_FREES(0);
+  }
+  {
+    /* the length counts embedded null chars */
+    constexpr auto l = strpp::lit("a\0b");
+    ASSERT_EQ(str_len(l.get()), 3);
+    ASSERT_EQ(std::memcmp(l.get(), "a\0b", 4), 0);
+  }
+  {
+    /* manipulators copy it; it concatenates like a ref */
+    str s = file_lit.get();
+    RESET_TRACKING;
+    str_append(&s, "!");
+    ASSERT_ALLOCS(1);
+    ASSERT_STREQ(s, "file scope!");
+    ASSERT_STREQ(file_lit.get(), "file scope");
+    str_free(&s);
+    string t = string("[") + file_lit + "]";
+    ASSERT_STREQ(t.c_str(), "[file scope]");
+    t += file_lit.get();
+    ASSERT_EQ(t.size(), 22);
+  }
+  {
+    /* long literals */
+    constexpr auto l = strpp::lit(
+        "0123456789012345678901234567890123456789012345678901234567890123"
+        "0123456789012345678901234567890123456789012345678901234567890123"
+        "0123456789012345678901234567890123456789012345678901234567890123"
+        "0123456789012345678901234567890123456789012345678901234567890123"
+        "0123456789012345678901234567890123456789012345678901234567890123");
+    ASSERT_EQ(str_len(l.get()), 320);
+  }
+}
+
+TEST(reserve) {
+  {
+    string s;
+    s.reserve(8);
+    ASSERT_EQ(s.capacity(), 8);
+    ASSERT_EQ(s.size(), 0);
+    RESET_TRACKING;
+    s.reserve(4);
+    ASSERT_ALLOCS(0);
+    ASSERT_EQ(s.capacity(), 8);
+  }
+}
+
+TEST(shrink_to_fit) {
+  {
+    string s("abc");
+    s.reserve(64);
+    s.shrink_to_fit();
+    ASSERT_EQ(s.capacity(), 3);
+    ASSERT_STREQ(s.c_str(), "abc");
+    RESET_TRACKING;
+    s.shrink_to_fit();
+    ASSERT_ALLOCS(0);
+  }
+  {
+    string s;
+    s.shrink_to_fit();
+    ASSERT_EQ(s.get(), nullptr);
+  }
+}
+
+TEST(clear) {
+  {
+    string s("abc");
+    RESET_TRACKING;
+    s.clear();
+    ASSERT_ALLOCS(0);
+    ASSERT_EQ(s.size(), 0);
+    ASSERT_EQ(s.capacity(), 3);
+    string e;
+    e.clear();
+    ASSERT_TRUE(e.empty());
+  }
+}
+
+TEST(access) {
+  {
+    string s("abc");
+    s[1] = 'x';
+    ASSERT_STREQ(s.c_str(), "axc");
+    std::size_t n = 0;
+    for (char c : s)
+      n += c == 'x';
+    ASSERT_EQ(n, 1);
+    ASSERT_EQ(s.end() - s.begin(), 3);
+    const string e;
+    ASSERT_EQ(e.begin(), e.end());
+  }
+}
+
+int
+main() {
+  RUN_TEST(construction);
+  RUN_TEST(copy);
+  RUN_TEST(move);
+  RUN_TEST(adopt);
+  RUN_TEST(swap);
+  RUN_TEST(string_view);
+  RUN_TEST(compare);
+  RUN_TEST(append);
+  RUN_TEST(concat);
+  RUN_TEST(lit);
+  RUN_TEST(reserve);
+  RUN_TEST(shrink_to_fit);
+  RUN_TEST(clear);
+  RUN_TEST(access);
+  return 0;
+}